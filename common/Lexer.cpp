@@ -16,121 +16,114 @@
 
 #include "Lexer.h"
 
-#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
 
 #include "util/StringUtil.h"
-#include "util/Error.h"
-#include "Token.h"
 
 namespace Argonauts {
 namespace Common {
 
-static std::string cleanString(const std::string &in)
-{
-	using Util::String::replaceAll;
-	return replaceAll(replaceAll(replaceAll(in, "\\\"", "\""), "\\\n", "\n"), "\\\t", "\t");
-}
-
 Lexer::Lexer()
 {
 }
 
-std::vector<Token> Lexer::consume(const std::string &data, const std::string &filename, const bool isEnd)
+TokenList Lexer::consume(const std::string &data, const std::string &filename, const bool isEnd)
 {
 	const int startOffset = m_offset;
-	std::vector<Token> tokens;
-	Util::SelfContainedIterator<std::string> it(data);
+	const std::size_t size = data.size();
+	TokenList tokens;
+	// most tokens are a few characters long, and most of the text ends up in identifiers and strings
+	tokens.reserve(size / 4 + 1, size / 2);
 
-	auto handleString = [this, &it, &tokens]()
-	{
-		bool isEscape = false;
-		const std::string string = cleanString(consumeWhile(it, [&isEscape](const char c) -> bool
-		{
-			if (c == '"' && !isEscape) {
-				return false;
-			} else if (c == '\\' && !isEscape) {
-				isEscape = true;
-			} else {
-				isEscape = false;
-			}
-			return true;
-		}));
-		tokens.push_back(Token::createString(string, m_offset, string.size() + (m_state == InString ? 0 : 1) + (it.hasNext() ? 1 : 0)));
-		if (!it.hasNext()) {
-			m_state = InString;
-		} else {
-			m_state = Normal;
-			it.next(); // ending "
-		}
-	};
+	std::size_t i = 0;
 	if (m_state == InString) {
-		handleString();
+		i = consumeString(data, 0, tokens);
 	}
 
-	while (it.hasNext())
+	while (i < size)
 	{
-		const char next = it.next();
-		m_offset = startOffset + it.index();
-		if (classifyCharacter(next) == Digit || (next == '-' && classifyCharacter(it.peekNext()) == Digit)) {
-			const std::string str = next + consumeWhile(it, [](const char c) -> bool { return classifyCharacter(c) == Digit; });
-			tokens.push_back(Token::createInteger(std::stoll(str), m_offset, str.size()));
+		const std::size_t start = i;
+		const char next = data[i++];
+		const char peek = i < size ? data[i] : '\0';
+		m_offset = startOffset + int(start);
+		if (classifyCharacter(next) == Digit || (next == '-' && classifyCharacter(peek) == Digit)) {
+			while (i < size && classifyCharacter(data[i]) == Digit) {
+				++i;
+			}
+			errno = 0;
+			const long long value = std::strtoll(data.c_str() + start, nullptr, 10);
+			if (errno == ERANGE) {
+				tokens.append(Token::Error, m_offset, int(i - start));
+				tokens.appendText(std::string("Integer out of range: ") + data.substr(start, i - start));
+			} else {
+				tokens.appendInteger(value, m_offset, int(i - start));
+			}
 		} else if (classifyCharacter(next) == Letter) {
-			const std::string string = next + consumeWhile(it, [](const char c) -> bool
-			{
-				const CharacterClass cc = classifyCharacter(c);
-				return cc == Letter || cc == Digit || c == '_' || c == '.';
-			});
-			if (string == "enum") {
-				tokens.push_back(Token::createSpecial(Token::Keyword_Enum, m_offset, string.size()));
-			} else if (string == "struct") {
-				tokens.push_back(Token::createSpecial(Token::Keyword_Struct, m_offset, string.size()));
-			} else if (string == "using") {
-				tokens.push_back(Token::createSpecial(Token::Keyword_Using, m_offset, string.size()));
+			while (i < size) {
+				const CharacterClass cc = classifyCharacter(data[i]);
+				if (cc != Letter && cc != Digit && data[i] != '_' && data[i] != '.') {
+					break;
+				}
+				++i;
+			}
+			const std::size_t length = i - start;
+			if (data.compare(start, length, "enum") == 0) {
+				tokens.append(Token::Keyword_Enum, m_offset, int(length));
+			} else if (data.compare(start, length, "struct") == 0) {
+				tokens.append(Token::Keyword_Struct, m_offset, int(length));
+			} else if (data.compare(start, length, "using") == 0) {
+				tokens.append(Token::Keyword_Using, m_offset, int(length));
 			} else {
-				tokens.push_back(Token::createIdentifier(string, m_offset));
+				tokens.append(Token::Identifier, m_offset, int(length));
+				tokens.appendText(data.data() + start, length);
+			}
+		} else if (next == '/' && peek == '/') {
+			// the text of comments is not needed by anyone, only their position
+			while (i < size && data[i] != '\n') {
+				++i;
 			}
-		} else if (next == '/' && it.peekNext() == '/') {
-			tokens.push_back(Token::createComment(consumeWhile(it, [](const char c) -> bool { return c != '\n'; }), m_offset));
+			tokens.append(Token::Comment, m_offset, int(i - start));
 		} else {
 			switch (next) {
 			case '"':
-				handleString();
+				i = consumeString(data, i, tokens);
 				break;
 			case '!':
-				tokens.push_back(Token::createSpecial(Token::ExclamationMark, m_offset));
+				tokens.append(Token::ExclamationMark, m_offset, 1);
 				break;
 			case '@':
-				tokens.push_back(Token::createSpecial(Token::AtSymbol, m_offset));
+				tokens.append(Token::AtSymbol, m_offset, 1);
 				break;
 			case '(':
-				tokens.push_back(Token::createSpecial(Token::ParanthesisOpen, m_offset));
+				tokens.append(Token::ParanthesisOpen, m_offset, 1);
 				break;
 			case ')':
-				tokens.push_back(Token::createSpecial(Token::ParanthesisClose, m_offset));
+				tokens.append(Token::ParanthesisClose, m_offset, 1);
 				break;
 			case '{':
-				tokens.push_back(Token::createSpecial(Token::CurlyBracketOpen, m_offset));
+				tokens.append(Token::CurlyBracketOpen, m_offset, 1);
 				break;
 			case '}':
-				tokens.push_back(Token::createSpecial(Token::CurlyBracketClose, m_offset));
+				tokens.append(Token::CurlyBracketClose, m_offset, 1);
 				break;
 			case '<':
-				tokens.push_back(Token::createSpecial(Token::AngleBracketOpen, m_offset));
+				tokens.append(Token::AngleBracketOpen, m_offset, 1);
 				break;
 			case '>':
-				tokens.push_back(Token::createSpecial(Token::AngleBracketClose, m_offset));
+				tokens.append(Token::AngleBracketClose, m_offset, 1);
 				break;
 			case ';':
-				tokens.push_back(Token::createSpecial(Token::SemiColon, m_offset));
+				tokens.append(Token::SemiColon, m_offset, 1);
 				break;
 			case ':':
-				tokens.push_back(Token::createSpecial(Token::Colon, m_offset));
+				tokens.append(Token::Colon, m_offset, 1);
 				break;
 			case ',':
-				tokens.push_back(Token::createSpecial(Token::Comma, m_offset));
+				tokens.append(Token::Comma, m_offset, 1);
 				break;
 			case '=':
-				tokens.push_back(Token::createSpecial(Token::Equal, m_offset));
+				tokens.append(Token::Equal, m_offset, 1);
 				break;
 			case '\n':
 			case '\r':
@@ -138,31 +131,46 @@ std::vector<Token> Lexer::consume(const std::string &data, const std::string &fi
 			case '\t':
 				break;
 			default:
-				tokens.push_back(Token::createError(std::string("Unexpected character: ") + next + " (0x" + Util::String::charToHexString(next) + ")", m_offset, 1));
+				tokens.append(Token::Error, m_offset, 1);
+				tokens.appendText(std::string("Unexpected character: ") + next + " (0x" + Util::String::charToHexString(next) + ")");
 			}
 		}
 	}
 	if (isEnd) {
-		tokens.push_back(Token::createSpecial(Token::EndOfFile, m_offset + 1, 0));
+		tokens.append(Token::EndOfFile, m_offset + 1, 0);
 	}
 	return tokens;
 }
 
-std::vector<Token> Lexer::cleanComments(const std::vector<Token> &tokens)
+std::size_t Lexer::consumeString(const std::string &data, std::size_t index, TokenList &tokens)
 {
-	std::vector<Token> out;
-	std::copy_if(tokens.begin(), tokens.end(), std::back_inserter(out), [](const Token &token) { return token.type != Token::Comment; });
-	return out;
-}
+	const std::size_t start = index;
+	tokens.append(Token::String, m_offset, 0);
 
-std::string Lexer::consumeWhile(Util::SelfContainedIterator<std::string> &it, const std::function<bool (const char)> &isAcceptedCallback)
-{
-	std::string out;
-	while (it.hasNext() && isAcceptedCallback(it.peekNext()))
-	{
-		out += it.next();
+	bool isEscape = false;
+	for (; index < data.size(); ++index) {
+		const char c = data[index];
+		if (c == '"' && !isEscape) {
+			break;
+		} else if (c == '\\' && !isEscape) {
+			isEscape = true;
+			continue;
+		}
+		if (isEscape && c != '"' && c != '\n' && c != '\t') {
+			tokens.appendCharacter('\\');
+		}
+		tokens.appendCharacter(c);
+		isEscape = false;
 	}
-	return out;
+	if (isEscape) {
+		tokens.appendCharacter('\\');
+	}
+
+	// the length includes the opening quote (unless it was on a previous line) and the closing quote (if any)
+	const bool hasEnd = index < data.size();
+	tokens.back().length = int(index - start) + (m_state == InString ? 0 : 1) + (hasEnd ? 1 : 0);
+	m_state = hasEnd ? Normal : InString;
+	return hasEnd ? index + 1 : index;
 }
 
 Lexer::CharacterClass Lexer::classifyCharacter(const char c)
@@ -17,14 +17,11 @@
 #pragma once
 
 #include <string>
-#include <vector>
-#include <functional>
 
-#include "util/SelfContainerIterator.h"
+#include "Token.h"
 
 namespace Argonauts {
 namespace Common {
-class Token;
 
 class Lexer
 {
@@ -42,11 +39,11 @@ public:
 	void setOffset(const int offset) { m_offset = offset; }
 	int offset() const { return m_offset; }
 
-	std::vector<Token> consume(const std::string &data, const std::string &filename, const bool isEnd = true);
-	static std::vector<Token> cleanComments(const std::vector<Token> &tokens);
+	TokenList consume(const std::string &data, const std::string &filename, const bool isEnd = true);
 
 private:
-	std::string consumeWhile(Util::SelfContainedIterator<std::string> &it, const std::function<bool(const char)> &isAcceptedCallback);
+	/// Consumes the rest of a string starting at index, up to and including the closing quote
+	std::size_t consumeString(const std::string &data, std::size_t index, TokenList &tokens);
 
 	StartState m_state = Normal;
 	int m_offset = 0;
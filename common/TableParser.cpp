@@ -0,0 +1,98 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TableParser.h"
+
+#include "Token.h"
+
+namespace Argonauts {
+namespace Common {
+TableParser::Handler::~Handler() {}
+
+TableParser::TableParser(const Tables &tables)
+	: m_tables(tables)
+{
+	reset();
+}
+
+void TableParser::setStack(const Stack &stack)
+{
+	if (stack.empty()) {
+		reset();
+	} else {
+		m_stack = stack;
+		m_accepted = m_stack.back() == m_tables.acceptState;
+	}
+}
+void TableParser::reset()
+{
+	m_stack.assign(1, 0);
+	m_accepted = false;
+}
+
+void TableParser::consume(const Token &token, Handler *handler)
+{
+	const int terminal = m_tables.terminalFor(token.type);
+	if (terminal == Ignored) {
+		return;
+	} else if (terminal == Unknown || m_accepted) {
+		handler->unexpected(token);
+		return;
+	}
+
+	reduceDefaults(handler);
+	while (true) {
+		const int action = m_tables.action(m_stack.back(), terminal);
+		if (action > 0) {
+			m_stack.push_back(uint16_t(action - 1));
+			handler->shift(token);
+			reduceDefaults(handler);
+			return;
+		} else if (action < 0) {
+			reduce(-action - 1, handler);
+		} else {
+			handler->unexpected(token);
+			return;
+		}
+	}
+}
+void TableParser::consume(const std::vector<Token> &tokens, Handler *handler)
+{
+	for (const Token &token : tokens) {
+		consume(token, handler);
+	}
+}
+
+void TableParser::reduce(const int rule, Handler *handler)
+{
+	const int length = m_tables.ruleLengths[rule];
+	m_stack.resize(m_stack.size() - std::size_t(length));
+	const int state = m_tables.gotoState(m_stack.back(), m_tables.ruleLhs[rule]);
+	m_stack.push_back(uint16_t(state));
+	handler->reduce(m_tables.ruleActions[rule], length);
+	if (state == m_tables.acceptState) {
+		m_accepted = true;
+	}
+}
+void TableParser::reduceDefaults(Handler *handler)
+{
+	int rule;
+	while ((rule = m_tables.defaultReductions[m_stack.back()]) >= 0) {
+		reduce(rule, handler);
+	}
+}
+}
+}
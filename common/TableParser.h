@@ -0,0 +1,89 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace Argonauts {
+namespace Common {
+class Token;
+
+/// Drives the LALR(1) tables produced by parsergenerator. Semantic values are kept by the Handler, which mirrors the
+/// parser stack: one value per shift, and `length` values replaced by one per reduce.
+class TableParser
+{
+public:
+	enum
+	{
+		Unknown = -1, ///< Token type that is not part of the grammar
+		Ignored = -2 ///< Token type that the parser skips, like comments
+	};
+
+	struct Tables
+	{
+		int numTerminals, numNonterminals, acceptState;
+		const int16_t *actionRows; ///< 0 = error, > 0 = shift to state - 1, < 0 = reduce rule -action - 1
+		const uint16_t *actionRowIndex;
+		const int16_t *gotoRows;
+		const uint16_t *gotoRowIndex;
+		const int16_t *defaultReductions; ///< Rule to reduce without looking at the next token, or -1
+		const uint8_t *ruleLengths;
+		const uint16_t *ruleLhs;
+		const uint16_t *ruleActions;
+		int (*terminalFor)(const int tokenType);
+
+		inline int action(const int state, const int terminal) const { return actionRows[actionRowIndex[state] + terminal]; }
+		inline int gotoState(const int state, const int nonterminal) const { return gotoRows[gotoRowIndex[state] + nonterminal]; }
+	};
+
+	class Handler
+	{
+	public:
+		virtual ~Handler();
+
+		virtual void shift(const Token &token) = 0;
+		/// Replace the topmost `length` values with a single one
+		virtual void reduce(const int action, const int length) = 0;
+		/// The parser skips the offending token and continues with the next one
+		virtual void unexpected(const Token &token) = 0;
+	};
+
+	using Stack = std::vector<uint16_t>;
+
+	explicit TableParser(const Tables &tables);
+
+	/// The state stack can be saved and restored to resume parsing at a later point, like at the start of a line
+	const Stack &stack() const { return m_stack; }
+	void setStack(const Stack &stack);
+	void reset();
+
+	bool isAccepted() const { return m_accepted; }
+
+	void consume(const Token &token, Handler *handler);
+	void consume(const std::vector<Token> &tokens, Handler *handler);
+
+private:
+	const Tables &m_tables;
+	Stack m_stack;
+	bool m_accepted = false;
+
+	void reduce(const int rule, Handler *handler);
+	void reduceDefaults(Handler *handler);
+};
+}
+}
@@ -44,13 +44,39 @@ const std::string Token::toString(const TokenType type)
 	case EndOfFile: return "EOF";
 	case Invalid: return "INVALID";
 	case Error: return "ERROR";
-	case Struct: return "struct";
-	case Enum: return "enum";
-	case Using: return "using";
-	case Annotation: return "annotation";
-	case Type: return "type";
-	case TypeList: return "typelist";
 	}
 }
+
+void TokenList::append(const Token::TokenType type, const int offset, const int length)
+{
+	Token token;
+	token.type = type;
+	token.offset = offset;
+	token.length = length;
+	token.data = uint32_t(m_characters.size());
+	m_tokens.push_back(token);
+}
+void TokenList::appendCharacter(const char c)
+{
+	m_characters.push_back(c);
+	++m_tokens.back().dataLength;
+}
+void TokenList::appendText(const char *text, const std::size_t size)
+{
+	m_characters.append(text, size);
+	m_tokens.back().dataLength += uint32_t(size);
+}
+void TokenList::appendInteger(const int64_t value, const int offset, const int length)
+{
+	append(Token::Integer, offset, length);
+	m_tokens.back().data = uint32_t(m_integers.size());
+	m_integers.push_back(value);
+}
+
+void TokenList::reserve(const std::size_t tokens, const std::size_t characters)
+{
+	m_tokens.reserve(tokens);
+	m_characters.reserve(characters);
+}
 }
 }
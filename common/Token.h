@@ -17,12 +17,12 @@
 #pragma once
 
 #include <string>
-#include <memory>
-
-#include "util/Variant.h"
+#include <vector>
+#include <cstdint>
 
 namespace Argonauts {
 namespace Common {
+/// Tokens are plain values, all their payload lives in the TokenList they were lexed into
 class Token
 {
 public:
@@ -52,45 +52,44 @@ public:
 		EndOfFile,
 
 		Invalid,
-		Error,
-
-		// specials, used by the parser
-		Struct,
-		Enum,
-		Using,
-		Annotation,
-		Type,
-		TypeList
+		Error
 	};
 
-	explicit Token() : type(Invalid) {}
-	template <typename T>
-	explicit Token(const TokenType &type_, const T &data_, const int offset_, const int length_ = -1)
-		: data(data_), type(type_), offset(offset_), length(length_) {}
+	TokenType type = Invalid;
+	int offset = -1, length = 0;
+	/// Identifier, String, Error: slice of TokenList::characters(). Integer: index into TokenList::integers()
+	uint32_t data = 0, dataLength = 0;
 
-	std::string string() const { return data.get<std::string>(); }
-	int64_t integer() const { return data.get<int64_t>(); }
-	template <typename T> std::shared_ptr<T> getRawData() const
-	{
-		return std::static_pointer_cast<T>(data.get<std::shared_ptr<void>>());
-	}
-	template <typename T> void setRawData(T *d)
-	{
-		data = std::shared_ptr<void>(reinterpret_cast<void *>(d), [](void *p) { delete reinterpret_cast<T *>(p); });
-	}
-	Util::Variant<std::string, int64_t, std::shared_ptr<void>> data = std::string();
+	static const std::string toString(const TokenType type);
+};
 
-	TokenType type;
-	int offset, length;
+/// The output of the Lexer. The decoded text of all tokens is stored back to back in a single buffer, in the order of
+/// the tokens, so consecutive strings (ignoring comments) can be joined by extending the slice of the first one.
+class TokenList
+{
+public:
+	const std::vector<Token> &tokens() const { return m_tokens; }
+	const std::string &characters() const { return m_characters; }
+	const std::vector<int64_t> &integers() const { return m_integers; }
 
-	static const std::string toString(const TokenType type);
+	std::string string(const Token &token) const { return m_characters.substr(token.data, token.dataLength); }
+	int64_t integer(const Token &token) const { return m_integers.at(token.data); }
+	bool equals(const Token &token, const char *string) const { return m_characters.compare(token.data, token.dataLength, string) == 0; }
+
+	/// The text functions add to the text of the last token
+	void append(const Token::TokenType type, const int offset, const int length);
+	void appendCharacter(const char c);
+	void appendText(const char *text, const std::size_t size);
+	void appendText(const std::string &text) { appendText(text.data(), text.size()); }
+	void appendInteger(const int64_t value, const int offset, const int length);
+
+	Token &back() { return m_tokens.back(); }
+	void reserve(const std::size_t tokens, const std::size_t characters);
 
-	static Token createIdentifier(const std::string &name, const int offset) { return Token(Identifier, name, offset, int(name.size())); }
-	static Token createString(const std::string &string, const int offset, const int length) { return Token(String, string, offset, length); }
-	static Token createInteger(const int64_t &integer, const int offset, const int length) { return Token(Integer, integer, offset, length); }
-	static Token createSpecial(const TokenType type, const int offset, const int length = 1) { return Token(type, std::string(), offset, length); }
-	static Token createComment(const std::string &string, const int offset) { return Token(Comment, string, offset, int(string.size())); }
-	static Token createError(const std::string &message, const int offset, const int length) { return Token(Error, message, offset, length); }
+private:
+	std::vector<Token> m_tokens;
+	std::string m_characters;
+	std::vector<int64_t> m_integers;
 };
 }
 }
@@ -0,0 +1,1046 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DynamicMessage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <unordered_map>
+
+#include "util/ArgonautsException.h"
+#include "util/SaxSink.h"
+#include "util/StringUtil.h"
+#include "util/json/JsonSaxReader.h"
+#include "runtime/Serializer.h"
+
+namespace Argonauts {
+namespace Dynamic {
+namespace detail {
+using UnknownFields = std::vector<std::pair<std::string, std::string>>;
+
+// the storage of values of a given type. construct, copy and relocate expect uninitialized memory, relocate leaves the
+// source destroyed
+static void construct(const TypeDescriptor *type, unsigned char *data);
+static void destroy(const TypeDescriptor *type, unsigned char *data);
+static void copy(const TypeDescriptor *type, unsigned char *data, const unsigned char *from);
+static void relocate(const TypeDescriptor *type, unsigned char *data, unsigned char *from);
+
+template <typename T>
+static T &as(unsigned char *data) { return *reinterpret_cast<T *>(data); }
+template <typename T>
+static const T &as(const unsigned char *data) { return *reinterpret_cast<const T *>(data); }
+
+static bool testBit(const unsigned char *data, const std::size_t bit)
+{
+	return (as<uint64_t>(data + bit / 64 * sizeof(uint64_t)) >> (bit % 64)) & 1;
+}
+static void setBit(unsigned char *data, const std::size_t bit, const bool value)
+{
+	uint64_t &word = as<uint64_t>(data + bit / 64 * sizeof(uint64_t));
+	const uint64_t mask = uint64_t(1) << (bit % 64);
+	word = value ? (word | mask) : (word & ~mask);
+}
+
+// entries of a List are its elements, entries of a Map a key followed by the value
+static void constructEntry(const TypeDescriptor *type, unsigned char *entry)
+{
+	if (type->kind == TypeDescriptor::Map) {
+		new (entry) std::string();
+	}
+	construct(type->element, entry + type->valueOffset);
+}
+static void destroyEntry(const TypeDescriptor *type, unsigned char *entry)
+{
+	if (type->kind == TypeDescriptor::Map) {
+		as<std::string>(entry).~basic_string();
+	}
+	destroy(type->element, entry + type->valueOffset);
+}
+static void grow(const TypeDescriptor *type, RawArray &array, const uint32_t capacity)
+{
+	unsigned char *data = static_cast<unsigned char *>(::operator new(std::size_t(capacity) * type->entrySize));
+	for (uint32_t i = 0; i < array.size; ++i) {
+		unsigned char *to = data + std::size_t(i) * type->entrySize;
+		unsigned char *from = array.data + std::size_t(i) * type->entrySize;
+		if (type->kind == TypeDescriptor::Map) {
+			new (to) std::string(std::move(as<std::string>(from)));
+			as<std::string>(from).~basic_string();
+		}
+		relocate(type->element, to + type->valueOffset, from + type->valueOffset);
+	}
+	::operator delete(array.data);
+	array.data = data;
+	array.capacity = capacity;
+}
+static unsigned char *entryAt(const TypeDescriptor *type, const RawArray &array, const std::size_t index)
+{
+	return array.data + index * type->entrySize;
+}
+static unsigned char *append(const TypeDescriptor *type, RawArray &array)
+{
+	if (array.size == array.capacity) {
+		grow(type, array, array.capacity == 0 ? 4 : array.capacity * 2);
+	}
+	unsigned char *entry = entryAt(type, array, array.size);
+	constructEntry(type, entry);
+	++array.size;
+	return entry;
+}
+
+static void constructMessage(const MessageDescriptor *message, unsigned char *data)
+{
+	std::memset(data, 0, message->presenceWords() * sizeof(uint64_t));
+	for (const FieldDescriptor &field : message->fields) {
+		construct(field.type, data + field.offset);
+	}
+	if (message->unknownFields == MessageDescriptor::UnknownFields::Keep) {
+		new (data + message->unknownFieldsOffset) UnknownFields();
+	}
+}
+
+static void construct(const TypeDescriptor *type, unsigned char *data)
+{
+	switch (type->kind) {
+	case TypeDescriptor::String:
+		new (data) std::string();
+		break;
+	case TypeDescriptor::List:
+	case TypeDescriptor::Map:
+		new (data) RawArray();
+		break;
+	case TypeDescriptor::Variant:
+		new (data) uint32_t(0);
+		construct(type->alternatives.front(), data + type->valueOffset);
+		break;
+	case TypeDescriptor::Message:
+		constructMessage(type->message, data);
+		break;
+	default:
+		std::memset(data, 0, type->size);
+		break;
+	}
+}
+static void destroy(const TypeDescriptor *type, unsigned char *data)
+{
+	switch (type->kind) {
+	case TypeDescriptor::String:
+		as<std::string>(data).~basic_string();
+		break;
+	case TypeDescriptor::List:
+	case TypeDescriptor::Map: {
+		RawArray &array = as<RawArray>(data);
+		if (!type->element->isTrivial() || type->kind == TypeDescriptor::Map) {
+			for (uint32_t i = 0; i < array.size; ++i) {
+				destroyEntry(type, entryAt(type, array, i));
+			}
+		}
+		::operator delete(array.data);
+		break;
+	}
+	case TypeDescriptor::Variant:
+		destroy(type->alternatives.at(as<uint32_t>(data)), data + type->valueOffset);
+		break;
+	case TypeDescriptor::Message:
+		for (const FieldDescriptor &field : type->message->fields) {
+			destroy(field.type, data + field.offset);
+		}
+		if (type->message->unknownFields == MessageDescriptor::UnknownFields::Keep) {
+			as<UnknownFields>(data + type->message->unknownFieldsOffset).~UnknownFields();
+		}
+		break;
+	default:
+		break;
+	}
+}
+static void copy(const TypeDescriptor *type, unsigned char *data, const unsigned char *from)
+{
+	switch (type->kind) {
+	case TypeDescriptor::String:
+		new (data) std::string(as<std::string>(from));
+		break;
+	case TypeDescriptor::List:
+	case TypeDescriptor::Map: {
+		const RawArray &source = as<RawArray>(from);
+		RawArray &array = *new (data) RawArray();
+		if (source.size == 0) {
+			break;
+		}
+		array.data = static_cast<unsigned char *>(::operator new(std::size_t(source.size) * type->entrySize));
+		array.capacity = source.size;
+		if (type->element->isTrivial() && type->kind == TypeDescriptor::List) {
+			std::memcpy(array.data, source.data, std::size_t(source.size) * type->entrySize);
+			array.size = source.size;
+			break;
+		}
+		for (; array.size < source.size; ++array.size) {
+			unsigned char *entry = entryAt(type, array, array.size);
+			const unsigned char *sourceEntry = entryAt(type, source, array.size);
+			if (type->kind == TypeDescriptor::Map) {
+				new (entry) std::string(as<std::string>(sourceEntry));
+			}
+			copy(type->element, entry + type->valueOffset, sourceEntry + type->valueOffset);
+		}
+		break;
+	}
+	case TypeDescriptor::Variant:
+		new (data) uint32_t(as<uint32_t>(from));
+		copy(type->alternatives.at(as<uint32_t>(from)), data + type->valueOffset, from + type->valueOffset);
+		break;
+	case TypeDescriptor::Message:
+		std::memcpy(data, from, type->message->presenceWords() * sizeof(uint64_t));
+		for (const FieldDescriptor &field : type->message->fields) {
+			copy(field.type, data + field.offset, from + field.offset);
+		}
+		if (type->message->unknownFields == MessageDescriptor::UnknownFields::Keep) {
+			new (data + type->message->unknownFieldsOffset) UnknownFields(as<UnknownFields>(from + type->message->unknownFieldsOffset));
+		}
+		break;
+	default:
+		std::memcpy(data, from, type->size);
+		break;
+	}
+}
+static void relocate(const TypeDescriptor *type, unsigned char *data, unsigned char *from)
+{
+	switch (type->kind) {
+	case TypeDescriptor::String:
+		new (data) std::string(std::move(as<std::string>(from)));
+		as<std::string>(from).~basic_string();
+		break;
+	case TypeDescriptor::Variant:
+		new (data) uint32_t(as<uint32_t>(from));
+		relocate(type->alternatives.at(as<uint32_t>(from)), data + type->valueOffset, from + type->valueOffset);
+		break;
+	case TypeDescriptor::Message:
+		std::memcpy(data, from, type->message->presenceWords() * sizeof(uint64_t));
+		for (const FieldDescriptor &field : type->message->fields) {
+			relocate(field.type, data + field.offset, from + field.offset);
+		}
+		if (type->message->unknownFields == MessageDescriptor::UnknownFields::Keep) {
+			UnknownFields &unknown = as<UnknownFields>(from + type->message->unknownFieldsOffset);
+			new (data + type->message->unknownFieldsOffset) UnknownFields(std::move(unknown));
+			unknown.~UnknownFields();
+		}
+		break;
+	default:
+		// lists and maps only refer to their entries
+		std::memcpy(data, from, type->size);
+		break;
+	}
+}
+static void reset(const TypeDescriptor *type, unsigned char *data)
+{
+	destroy(type, data);
+	construct(type, data);
+}
+static void selectAlternative(const TypeDescriptor *type, unsigned char *data, const uint32_t index)
+{
+	destroy(type->alternatives.at(as<uint32_t>(data)), data + type->valueOffset);
+	as<uint32_t>(data) = index;
+	construct(type->alternatives.at(index), data + type->valueOffset);
+}
+
+template <typename T>
+static bool storeIfInRange(unsigned char *data, const int64_t value)
+{
+	// the values from readers are int64_t, so that is the largest range to check against
+	if (value < int64_t(std::numeric_limits<T>::min()) || (sizeof(T) < sizeof(int64_t) && value > int64_t(std::numeric_limits<T>::max()))) {
+		return false;
+	}
+	as<T>(data) = T(value);
+	return true;
+}
+static bool storeInteger(const TypeDescriptor::Kind kind, unsigned char *data, const int64_t value)
+{
+	switch (kind) {
+	case TypeDescriptor::Int8: return storeIfInRange<int8_t>(data, value);
+	case TypeDescriptor::Int16: return storeIfInRange<int16_t>(data, value);
+	case TypeDescriptor::Int32: return storeIfInRange<int32_t>(data, value);
+	case TypeDescriptor::Int64: return storeIfInRange<int64_t>(data, value);
+	case TypeDescriptor::UInt8: return storeIfInRange<uint8_t>(data, value);
+	case TypeDescriptor::UInt16: return storeIfInRange<uint16_t>(data, value);
+	case TypeDescriptor::UInt32: return storeIfInRange<uint32_t>(data, value);
+	case TypeDescriptor::UInt64: return storeIfInRange<uint64_t>(data, value);
+	default: return false;
+	}
+}
+static int64_t loadInteger(const TypeDescriptor::Kind kind, const unsigned char *data)
+{
+	switch (kind) {
+	case TypeDescriptor::Int8: return as<int8_t>(data);
+	case TypeDescriptor::Int16: return as<int16_t>(data);
+	case TypeDescriptor::Int32: return as<int32_t>(data);
+	case TypeDescriptor::Int64: return as<int64_t>(data);
+	case TypeDescriptor::UInt8: return as<uint8_t>(data);
+	case TypeDescriptor::UInt16: return as<uint16_t>(data);
+	case TypeDescriptor::UInt32: return as<uint32_t>(data);
+	case TypeDescriptor::UInt64: return int64_t(as<uint64_t>(data));
+	default: return 0;
+	}
+}
+static bool storeEnum(const TypeDescriptor *type, unsigned char *data, const int index)
+{
+	return index >= 0 && storeInteger(type->enumeration->underlying, data, type->enumeration->entries.at(std::size_t(index)).second);
+}
+
+static void serializeInteger(const TypeDescriptor::Kind kind, const unsigned char *data, Runtime::Serializer *serializer)
+{
+	switch (kind) {
+	case TypeDescriptor::Int8: serializer->emitValue(as<int8_t>(data)); break;
+	case TypeDescriptor::Int16: serializer->emitValue(as<int16_t>(data)); break;
+	case TypeDescriptor::Int32: serializer->emitValue(as<int32_t>(data)); break;
+	case TypeDescriptor::Int64: serializer->emitValue(as<int64_t>(data)); break;
+	case TypeDescriptor::UInt8: serializer->emitValue(as<uint8_t>(data)); break;
+	case TypeDescriptor::UInt16: serializer->emitValue(as<uint16_t>(data)); break;
+	case TypeDescriptor::UInt32: serializer->emitValue(as<uint32_t>(data)); break;
+	case TypeDescriptor::UInt64: serializer->emitValue(as<uint64_t>(data)); break;
+	default: break;
+	}
+}
+static void serialize(const TypeDescriptor *type, const unsigned char *data, Runtime::Serializer *serializer)
+{
+	switch (type->kind) {
+	case TypeDescriptor::Int8: case TypeDescriptor::Int16: case TypeDescriptor::Int32: case TypeDescriptor::Int64:
+	case TypeDescriptor::UInt8: case TypeDescriptor::UInt16: case TypeDescriptor::UInt32: case TypeDescriptor::UInt64:
+		serializeInteger(type->kind, data, serializer);
+		break;
+	case TypeDescriptor::Double: serializer->emitValue(as<double>(data)); break;
+	case TypeDescriptor::Bool: serializer->emitValue(as<bool>(data)); break;
+	case TypeDescriptor::String: serializer->emitValue(as<std::string>(data)); break;
+	case TypeDescriptor::Enum: {
+		const TypeDescriptor::Kind underlying = type->enumeration->underlying;
+		const int index = type->enumeration->indexOf(loadInteger(underlying, data));
+		if (serializer->packedEnums() || index < 0) {
+			// like the generated code, invalid values are written as they are to keep the output well-formed
+			serializeInteger(underlying, data, serializer);
+		} else {
+			serializer->emitValue(type->enumeration->entries.at(std::size_t(index)).first);
+		}
+		break;
+	}
+	case TypeDescriptor::List: {
+		const RawArray &array = as<RawArray>(data);
+		serializer->emitArrayStart();
+		for (uint32_t i = 0; i < array.size; ++i) {
+			serialize(type->element, entryAt(type, array, i), serializer);
+		}
+		serializer->emitArrayEnd(array.size);
+		break;
+	}
+	case TypeDescriptor::Map: {
+		const RawArray &array = as<RawArray>(data);
+		serializer->emitObjectStart();
+		for (uint32_t i = 0; i < array.size; ++i) {
+			const unsigned char *entry = entryAt(type, array, i);
+			serializer->emitObjectKey(as<std::string>(entry));
+			serialize(type->element, entry + type->valueOffset, serializer);
+		}
+		serializer->emitObjectEnd(array.size);
+		break;
+	}
+	case TypeDescriptor::Variant:
+		serialize(type->alternatives.at(as<uint32_t>(data)), data + type->valueOffset, serializer);
+		break;
+	case TypeDescriptor::Message: {
+		const MessageDescriptor *message = type->message;
+		std::size_t count = 0;
+		serializer->emitObjectStart();
+		for (std::size_t i = 0; i < message->fields.size(); ++i) {
+			// optional fields are only written if they are present
+			const bool required = (message->required[i / 64] >> (i % 64)) & 1;
+			if (required || testBit(data, i)) {
+				serializer->emitObjectKey(message->fields[i].name);
+				serialize(message->fields[i].type, data + message->fields[i].offset, serializer);
+				++count;
+			}
+		}
+		if (message->unknownFields == MessageDescriptor::UnknownFields::Keep) {
+			for (const auto &field : as<UnknownFields>(data + message->unknownFieldsOffset)) {
+				serializer->emitObjectKey(field.first);
+				serializer->emitRawValue(field.second);
+				++count;
+			}
+		}
+		serializer->emitObjectEnd(count);
+		break;
+	}
+	}
+}
+}
+
+static const char *describe(const TypeDescriptor::Kind kind)
+{
+	switch (kind) {
+	case TypeDescriptor::Double: return "a double";
+	case TypeDescriptor::Bool: return "a boolean";
+	case TypeDescriptor::String: return "a string";
+	case TypeDescriptor::List: return "a list";
+	case TypeDescriptor::Map: return "a map";
+	case TypeDescriptor::Variant: return "a variant";
+	case TypeDescriptor::Enum: return "an enum";
+	case TypeDescriptor::Message: return "a struct";
+	default: return "an integer";
+	}
+}
+
+void ConstValueRef::expect(const TypeDescriptor::Kind kind) const
+{
+	if (m_type->kind != kind) {
+		throw Util::Exception(std::string("Expected ") + describe(kind) + ", but '" + m_type->name + "' is " + describe(m_type->kind));
+	}
+}
+
+int64_t ConstValueRef::toInteger() const
+{
+	if (m_type->kind == TypeDescriptor::Enum) {
+		return detail::loadInteger(m_type->enumeration->underlying, m_data);
+	}
+	expect(m_type->isInteger() ? m_type->kind : TypeDescriptor::Int64);
+	return detail::loadInteger(m_type->kind, m_data);
+}
+double ConstValueRef::toDouble() const
+{
+	if (m_type->isInteger()) {
+		return double(detail::loadInteger(m_type->kind, m_data));
+	}
+	expect(TypeDescriptor::Double);
+	return detail::as<double>(m_data);
+}
+bool ConstValueRef::toBool() const
+{
+	expect(TypeDescriptor::Bool);
+	return detail::as<bool>(m_data);
+}
+const std::string &ConstValueRef::toString() const
+{
+	expect(TypeDescriptor::String);
+	return detail::as<std::string>(m_data);
+}
+std::string ConstValueRef::toEnumName() const
+{
+	expect(TypeDescriptor::Enum);
+	const int index = m_type->enumeration->indexOf(toInteger());
+	return index < 0 ? std::string() : m_type->enumeration->entries.at(std::size_t(index)).first;
+}
+
+std::size_t ConstValueRef::size() const
+{
+	if (m_type->kind != TypeDescriptor::Map) {
+		expect(TypeDescriptor::List);
+	}
+	return detail::as<detail::RawArray>(m_data).size;
+}
+ConstValueRef ConstValueRef::at(const std::size_t index) const
+{
+	if (index >= size()) {
+		throw Util::Exception("Index " + std::to_string(index) + " is out of range for '" + m_type->name + "'");
+	}
+	return ConstValueRef(m_type->element, detail::entryAt(m_type, detail::as<detail::RawArray>(m_data), index) + m_type->valueOffset);
+}
+const std::string &ConstValueRef::keyAt(const std::size_t index) const
+{
+	expect(TypeDescriptor::Map);
+	if (index >= size()) {
+		throw Util::Exception("Index " + std::to_string(index) + " is out of range for '" + m_type->name + "'");
+	}
+	return detail::as<std::string>(detail::entryAt(m_type, detail::as<detail::RawArray>(m_data), index));
+}
+ConstValueRef ConstValueRef::value(const std::string &key) const
+{
+	expect(TypeDescriptor::Map);
+	for (std::size_t i = 0; i < size(); ++i) {
+		if (keyAt(i) == key) {
+			return at(i);
+		}
+	}
+	throw Util::Exception("No entry '" + key + "' in '" + m_type->name + "'");
+}
+
+std::size_t ConstValueRef::which() const
+{
+	expect(TypeDescriptor::Variant);
+	return detail::as<uint32_t>(m_data);
+}
+ConstValueRef ConstValueRef::alternative() const
+{
+	return ConstValueRef(m_type->alternatives.at(which()), m_data + m_type->valueOffset);
+}
+
+bool ConstValueRef::has(const std::string &field) const
+{
+	expect(TypeDescriptor::Message);
+	const int index = m_type->message->indexOf(field);
+	if (index < 0) {
+		throw Util::Exception("'" + field + "' is not a field of '" + m_type->name + "'");
+	}
+	return detail::testBit(m_data, std::size_t(index));
+}
+ConstValueRef ConstValueRef::operator[](const std::string &field) const
+{
+	expect(TypeDescriptor::Message);
+	const int index = m_type->message->indexOf(field);
+	if (index < 0) {
+		throw Util::Exception("'" + field + "' is not a field of '" + m_type->name + "'");
+	}
+	const FieldDescriptor &descriptor = m_type->message->fields[std::size_t(index)];
+	return ConstValueRef(descriptor.type, m_data + descriptor.offset);
+}
+
+const std::vector<std::pair<std::string, std::string>> &ConstValueRef::unknownFields() const
+{
+	expect(TypeDescriptor::Message);
+	if (m_type->message->unknownFields != MessageDescriptor::UnknownFields::Keep) {
+		static const detail::UnknownFields *empty = new detail::UnknownFields();
+		return *empty;
+	}
+	return detail::as<detail::UnknownFields>(m_data + m_type->message->unknownFieldsOffset);
+}
+
+static const MessageDescriptor *messageOf(const Schema &schema, const std::string &name)
+{
+	const MessageDescriptor *descriptor = schema.message(name);
+	if (!descriptor) {
+		throw Util::Exception("Unknown struct '" + name + "'");
+	}
+	return descriptor;
+}
+
+DynamicMessage::DynamicMessage(const std::shared_ptr<const Schema> &schema, const std::string &name)
+	: DynamicMessage(schema, messageOf(*schema, name))
+{
+}
+DynamicMessage::DynamicMessage(const std::shared_ptr<const Schema> &schema, const MessageDescriptor *descriptor)
+	: m_schema(schema), m_descriptor(descriptor), m_data(nullptr)
+{
+	m_data = static_cast<unsigned char *>(::operator new(m_descriptor->size));
+	detail::constructMessage(m_descriptor, m_data);
+}
+DynamicMessage::DynamicMessage(const DynamicMessage &other)
+	: m_schema(other.m_schema), m_descriptor(other.m_descriptor), m_data(nullptr)
+{
+	if (other.m_data) {
+		m_data = static_cast<unsigned char *>(::operator new(m_descriptor->size));
+		detail::copy(m_descriptor->type, m_data, other.m_data);
+	}
+}
+DynamicMessage::DynamicMessage(DynamicMessage &&other)
+	: m_schema(std::move(other.m_schema)), m_descriptor(other.m_descriptor), m_data(other.m_data)
+{
+	other.m_data = nullptr;
+}
+DynamicMessage::~DynamicMessage()
+{
+	if (m_data) {
+		detail::destroy(m_descriptor->type, m_data);
+		::operator delete(m_data);
+	}
+}
+
+DynamicMessage &DynamicMessage::operator=(const DynamicMessage &other)
+{
+	if (this != &other) {
+		*this = DynamicMessage(other);
+	}
+	return *this;
+}
+DynamicMessage &DynamicMessage::operator=(DynamicMessage &&other)
+{
+	std::swap(m_schema, other.m_schema);
+	std::swap(m_descriptor, other.m_descriptor);
+	std::swap(m_data, other.m_data);
+	return *this;
+}
+
+ConstValueRef DynamicMessage::root() const
+{
+	return ConstValueRef(m_descriptor->type, m_data);
+}
+
+std::size_t DynamicMessage::indexOf(const std::string &field) const
+{
+	const int index = m_descriptor->indexOf(field);
+	if (index < 0) {
+		throw Util::Exception("'" + field + "' is not a field of '" + m_descriptor->name + "'");
+	}
+	return std::size_t(index);
+}
+
+void DynamicMessage::set(const std::string &field, const int64_t value)
+{
+	const std::size_t index = indexOf(field);
+	const FieldDescriptor &descriptor = m_descriptor->fields[index];
+	unsigned char *data = m_data + descriptor.offset;
+	if (descriptor.type->kind == TypeDescriptor::Double) {
+		detail::as<double>(data) = double(value);
+	} else if (descriptor.type->kind == TypeDescriptor::Enum) {
+		if (!detail::storeEnum(descriptor.type, data, descriptor.type->enumeration->indexOf(value))) {
+			throw Util::Exception("Invalid value for '" + field + "'");
+		}
+	} else if (!descriptor.type->isInteger()) {
+		throw Util::Exception("Expected an integer for '" + field + "', but it is " + describe(descriptor.type->kind));
+	} else if (!detail::storeInteger(descriptor.type->kind, data, value)) {
+		throw Util::Exception("Invalid value for '" + field + "'");
+	}
+	detail::setBit(m_data, index, true);
+}
+void DynamicMessage::set(const std::string &field, const double value)
+{
+	const std::size_t index = indexOf(field);
+	const FieldDescriptor &descriptor = m_descriptor->fields[index];
+	if (descriptor.type->kind != TypeDescriptor::Double) {
+		throw Util::Exception("Expected a double for '" + field + "', but it is " + describe(descriptor.type->kind));
+	}
+	detail::as<double>(m_data + descriptor.offset) = value;
+	detail::setBit(m_data, index, true);
+}
+void DynamicMessage::set(const std::string &field, const bool value)
+{
+	const std::size_t index = indexOf(field);
+	const FieldDescriptor &descriptor = m_descriptor->fields[index];
+	if (descriptor.type->kind != TypeDescriptor::Bool) {
+		throw Util::Exception("Expected a boolean for '" + field + "', but it is " + describe(descriptor.type->kind));
+	}
+	detail::as<bool>(m_data + descriptor.offset) = value;
+	detail::setBit(m_data, index, true);
+}
+void DynamicMessage::set(const std::string &field, const std::string &value)
+{
+	const std::size_t index = indexOf(field);
+	const FieldDescriptor &descriptor = m_descriptor->fields[index];
+	unsigned char *data = m_data + descriptor.offset;
+	if (descriptor.type->kind == TypeDescriptor::Enum) {
+		if (!detail::storeEnum(descriptor.type, data, descriptor.type->enumeration->indexOf(value))) {
+			throw Util::Exception("Invalid value for '" + field + "'");
+		}
+	} else if (descriptor.type->kind == TypeDescriptor::String) {
+		detail::as<std::string>(data) = value;
+	} else {
+		throw Util::Exception("Expected a string for '" + field + "', but it is " + describe(descriptor.type->kind));
+	}
+	detail::setBit(m_data, index, true);
+}
+void DynamicMessage::clear(const std::string &field)
+{
+	const std::size_t index = indexOf(field);
+	detail::reset(m_descriptor->fields[index].type, m_data + m_descriptor->fields[index].offset);
+	detail::setBit(m_data, index, false);
+}
+
+void DynamicMessage::serialize(Runtime::Serializer *serializer) const
+{
+	detail::serialize(m_descriptor->type, m_data, serializer);
+}
+
+/* Parses into the storage of a DynamicMessage directly, keeping one frame per open object or array instead of a sink
+ * per value like the generated code does.
+ */
+class MessageParserSink : public Util::SaxSink
+{
+public:
+	explicit MessageParserSink(DynamicMessage *message) : m_message(message) {}
+
+	bool null() override { return scalar(Scalar::Null, "null"); }
+	bool boolean(const bool val) override
+	{
+		m_boolean = val;
+		return scalar(Scalar::Boolean, "boolean");
+	}
+	bool integerNumber(const int64_t val) override
+	{
+		m_integer = val;
+		return scalar(Scalar::Integer, "integer");
+	}
+	bool doubleNumber(const double val) override
+	{
+		m_double = val;
+		return scalar(Scalar::Double, "double");
+	}
+	bool string(const std::string &str) override
+	{
+		m_string = &str;
+		return scalar(Scalar::String, "string");
+	}
+
+	bool startObject() override
+	{
+		if (m_skip != Skip::None) {
+			return swallow(1);
+		}
+		if (m_stack.empty()) {
+			if (m_done) {
+				return reportError("Unexpected data after the end of the object");
+			}
+			// like generated structs, the message is replaced by what is parsed
+			const TypeDescriptor *type = m_message->m_descriptor->type;
+			detail::reset(type, m_message->m_data);
+			m_stack.push_back(Frame(type, m_message->m_data));
+			return true;
+		}
+		const Target target = currentTarget();
+		return startObjectIn(target.type, target.data) || reportError("Unexpected value of type 'object' for '%s'", m_key.c_str());
+	}
+	bool key(const std::string &str) override
+	{
+		if (m_skip != Skip::None) {
+			return true;
+		}
+		Frame &frame = m_stack.back();
+		m_key = str;
+		if (frame.selecting) {
+			const std::vector<std::string> &firstFields = frame.type->firstFields;
+			const auto it = std::find(firstFields.begin(), firstFields.end(), str);
+			if (it == firstFields.end()) {
+				return reportError("Unexpected key '%s', expected one of '%s'", str.c_str(), Util::String::joinStrings(firstFields, "', '").c_str());
+			}
+			const uint32_t index = uint32_t(it - firstFields.begin());
+			detail::selectAlternative(frame.type, frame.data, index);
+			frame = Frame(frame.type->alternatives[index], frame.data + frame.type->valueOffset);
+		}
+		if (frame.type->kind == TypeDescriptor::Map) {
+			return mapKey(frame, str);
+		}
+
+		const MessageDescriptor *message = frame.type->message;
+		const int index = message->indexOf(str);
+		if (index < 0) {
+			switch (message->unknownFields) {
+			case MessageDescriptor::UnknownFields::Skip:
+				m_skip = Skip::Discard;
+				return true;
+			case MessageDescriptor::UnknownFields::Keep:
+				m_skip = Skip::Keep;
+				return true;
+			case MessageDescriptor::UnknownFields::Error:
+				break;
+			}
+			std::vector<std::string> names;
+			for (const FieldDescriptor &field : message->fields) {
+				names.push_back(field.name);
+			}
+			return reportError("Unexpected key '%s', expected one of '%s'", str.c_str(), Util::String::joinStrings(names, "', '").c_str());
+		}
+		const FieldDescriptor &field = message->fields[std::size_t(index)];
+		if (detail::testBit(frame.data, std::size_t(index))) {
+			// the last of duplicate keys wins
+			detail::reset(field.type, frame.data + field.offset);
+		}
+		detail::setBit(frame.data, std::size_t(index), true);
+		frame.current = std::size_t(index);
+		return true;
+	}
+	bool endObject(const std::size_t) override
+	{
+		if (m_skip != Skip::None) {
+			return swallow(-1);
+		}
+		const Frame &frame = m_stack.back();
+		if (frame.selecting) {
+			return reportError("Unexpected empty object");
+		}
+		if (frame.type->kind == TypeDescriptor::Message) {
+			const MessageDescriptor *message = frame.type->message;
+			for (std::size_t word = 0; word < message->required.size(); ++word) {
+				const uint64_t missing = message->required[word] & ~detail::as<uint64_t>(frame.data + word * sizeof(uint64_t));
+				if (missing) {
+					std::size_t bit = 0;
+					while (!((missing >> bit) & 1)) {
+						++bit;
+					}
+					return reportError("Missing required field '%s'", message->fields[word * 64 + bit].name.c_str());
+				}
+			}
+		}
+		pop();
+		return true;
+	}
+	bool startArray() override
+	{
+		if (m_skip != Skip::None) {
+			return swallow(1);
+		}
+		if (m_stack.empty()) {
+			return reportError("Unexpected value of type 'array', expected an object");
+		}
+		const Target target = currentTarget();
+		return startArrayIn(target.type, target.data) || reportError("Unexpected value of type 'array' for '%s'", m_key.c_str());
+	}
+	bool endArray(const std::size_t) override
+	{
+		if (m_skip != Skip::None) {
+			return swallow(-1);
+		}
+		pop();
+		return true;
+	}
+
+	Skip skipValue() override { return m_skip; }
+	bool skipped(const std::string &raw) override
+	{
+		const Skip skip = m_skip;
+		m_skip = Skip::None;
+		if (skip != Skip::Keep) {
+			return true;
+		}
+		// the reader only looks at the brackets of values it skips
+		if (!Util::Json::readValue(raw, nullptr)) {
+			return reportError("Invalid value for '%s'", m_key.c_str());
+		}
+		const Frame &frame = m_stack.back();
+		detail::as<detail::UnknownFields>(frame.data + frame.type->message->unknownFieldsOffset).emplace_back(m_key, raw);
+		return true;
+	}
+
+private:
+	enum class Scalar { Null, Boolean, Integer, Double, String };
+	struct Frame
+	{
+		explicit Frame(const TypeDescriptor *type, unsigned char *data) : type(type), data(data) {}
+
+		const TypeDescriptor *type;
+		unsigned char *data;
+		/// The field of a struct or the entry of a map the next value is for
+		std::size_t current = 0;
+		/// A variant that is selected by the first key of the object, which has not been seen yet
+		bool selecting = false;
+		/// The entries of a large map by key, to find duplicate keys
+		std::shared_ptr<std::unordered_map<std::string, uint32_t>> index;
+	};
+	struct Target
+	{
+		const TypeDescriptor *type;
+		unsigned char *data;
+	};
+	// from here on the linear search for duplicate keys of a map is replaced by a hash
+	static constexpr uint32_t IndexedMapSize = 16;
+
+	DynamicMessage *m_message;
+	std::vector<Frame> m_stack;
+	bool m_done = false;
+	/// The last key, for error messages and kept unknown fields
+	std::string m_key;
+	Skip m_skip = Skip::None;
+	int m_skipDepth = 0;
+
+	bool m_boolean = false;
+	int64_t m_integer = 0;
+	double m_double = 0.0;
+	const std::string *m_string = nullptr;
+
+	/// Where the next value goes, appends to lists
+	Target currentTarget()
+	{
+		Frame &frame = m_stack.back();
+		switch (frame.type->kind) {
+		case TypeDescriptor::List:
+			return Target{frame.type->element, detail::append(frame.type, detail::as<detail::RawArray>(frame.data))};
+		case TypeDescriptor::Map:
+			return Target{frame.type->element, detail::entryAt(frame.type, detail::as<detail::RawArray>(frame.data), frame.current) + frame.type->valueOffset};
+		default: {
+			const FieldDescriptor &field = frame.type->message->fields[frame.current];
+			return Target{field.type, frame.data + field.offset};
+		}
+		}
+	}
+	void pop()
+	{
+		m_stack.pop_back();
+		m_done = m_stack.empty();
+	}
+	/// Drops the events of a skipped value if the reader could not skip it
+	bool swallow(const int depthChange)
+	{
+		m_skipDepth += depthChange;
+		if (m_skipDepth == 0) {
+			m_skip = Skip::None;
+		}
+		return true;
+	}
+
+	bool mapKey(Frame &frame, const std::string &key)
+	{
+		detail::RawArray &array = detail::as<detail::RawArray>(frame.data);
+		if (!frame.index && array.size >= IndexedMapSize) {
+			frame.index = std::make_shared<std::unordered_map<std::string, uint32_t>>();
+			for (uint32_t i = 0; i < array.size; ++i) {
+				frame.index->emplace(detail::as<std::string>(detail::entryAt(frame.type, array, i)), i);
+			}
+		}
+		uint32_t existing = array.size;
+		if (frame.index) {
+			const auto it = frame.index->find(key);
+			if (it != frame.index->end()) {
+				existing = it->second;
+			}
+		} else {
+			for (uint32_t i = 0; i < array.size; ++i) {
+				if (detail::as<std::string>(detail::entryAt(frame.type, array, i)) == key) {
+					existing = i;
+					break;
+				}
+			}
+		}
+		if (existing < array.size) {
+			// the last of duplicate keys wins
+			detail::reset(frame.type->element, detail::entryAt(frame.type, array, existing) + frame.type->valueOffset);
+		} else {
+			detail::as<std::string>(detail::append(frame.type, array)) = key;
+			if (frame.index) {
+				frame.index->emplace(key, existing);
+			}
+		}
+		frame.current = existing;
+		return true;
+	}
+
+	bool startObjectIn(const TypeDescriptor *type, unsigned char *data)
+	{
+		switch (type->kind) {
+		case TypeDescriptor::Message:
+		case TypeDescriptor::Map:
+			m_stack.push_back(Frame(type, data));
+			return true;
+		case TypeDescriptor::Variant:
+			if (!type->firstFields.empty()) {
+				m_stack.push_back(Frame(type, data));
+				m_stack.back().selecting = true;
+				return true;
+			}
+			for (uint32_t i = 0; i < type->alternatives.size(); ++i) {
+				const TypeDescriptor::Kind kind = type->alternatives[i]->kind;
+				if (kind == TypeDescriptor::Message || kind == TypeDescriptor::Map || kind == TypeDescriptor::Variant) {
+					detail::selectAlternative(type, data, i);
+					if (startObjectIn(type->alternatives[i], data + type->valueOffset)) {
+						return true;
+					}
+				}
+			}
+			return false;
+		default:
+			return false;
+		}
+	}
+	bool startArrayIn(const TypeDescriptor *type, unsigned char *data)
+	{
+		if (type->kind == TypeDescriptor::List) {
+			m_stack.push_back(Frame(type, data));
+			return true;
+		} else if (type->kind == TypeDescriptor::Variant) {
+			for (uint32_t i = 0; i < type->alternatives.size(); ++i) {
+				const TypeDescriptor::Kind kind = type->alternatives[i]->kind;
+				if (kind == TypeDescriptor::List || kind == TypeDescriptor::Variant) {
+					detail::selectAlternative(type, data, i);
+					if (startArrayIn(type->alternatives[i], data + type->valueOffset)) {
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	enum class Result { Ok, WrongType, Invalid };
+	bool scalar(const Scalar scalar, const char *jsonType)
+	{
+		if (m_skip != Skip::None) {
+			return swallow(0);
+		}
+		if (m_stack.empty()) {
+			return reportError("Unexpected value of type '%s', expected an object", jsonType);
+		}
+		const Target target = currentTarget();
+		switch (assign(target.type, target.data, scalar)) {
+		case Result::Ok: return true;
+		case Result::Invalid: return reportError("Invalid value for '%s'", m_key.c_str());
+		case Result::WrongType: break;
+		}
+		return reportError("Unexpected value of type '%s' for '%s'", jsonType, m_key.c_str());
+	}
+	Result assign(const TypeDescriptor *type, unsigned char *data, const Scalar scalar)
+	{
+		if (type->isInteger()) {
+			if (scalar == Scalar::Integer) {
+				return detail::storeInteger(type->kind, data, m_integer) ? Result::Ok : Result::Invalid;
+			} else if (scalar == Scalar::Double) {
+				// doubles are accepted for integers if they are whole numbers, e.g. 1e3
+				const bool integral = std::trunc(m_double) == m_double && std::abs(m_double) < 9.2e18;
+				return integral && detail::storeInteger(type->kind, data, int64_t(m_double)) ? Result::Ok : Result::Invalid;
+			}
+			return Result::WrongType;
+		}
+		switch (type->kind) {
+		case TypeDescriptor::Double:
+			if (scalar == Scalar::Double || scalar == Scalar::Integer) {
+				detail::as<double>(data) = scalar == Scalar::Double ? m_double : double(m_integer);
+				return Result::Ok;
+			}
+			return Result::WrongType;
+		case TypeDescriptor::Bool:
+			if (scalar == Scalar::Boolean) {
+				detail::as<bool>(data) = m_boolean;
+				return Result::Ok;
+			}
+			return Result::WrongType;
+		case TypeDescriptor::String:
+			if (scalar == Scalar::String) {
+				detail::as<std::string>(data) = *m_string;
+				return Result::Ok;
+			}
+			return Result::WrongType;
+		case TypeDescriptor::Enum:
+			// enums are accepted by the name or the value of an entry
+			if (scalar == Scalar::String) {
+				return detail::storeEnum(type, data, type->enumeration->indexOf(*m_string)) ? Result::Ok : Result::Invalid;
+			} else if (scalar == Scalar::Integer) {
+				return detail::storeEnum(type, data, type->enumeration->indexOf(m_integer)) ? Result::Ok : Result::Invalid;
+			}
+			return Result::WrongType;
+		case TypeDescriptor::Variant: {
+			// the first alternative that takes the value is used
+			Result result = Result::WrongType;
+			for (uint32_t i = 0; i < type->alternatives.size(); ++i) {
+				if (!isScalar(type->alternatives[i])) {
+					continue;
+				}
+				detail::selectAlternative(type, data, i);
+				const Result alternative = assign(type->alternatives[i], data + type->valueOffset, scalar);
+				if (alternative == Result::Ok) {
+					return Result::Ok;
+				} else if (alternative == Result::Invalid) {
+					result = Result::Invalid;
+				}
+			}
+			return result;
+		}
+		default:
+			return Result::WrongType;
+		}
+	}
+	static bool isScalar(const TypeDescriptor *type)
+	{
+		return type->kind != TypeDescriptor::List && type->kind != TypeDescriptor::Map && type->kind != TypeDescriptor::Message;
+	}
+};
+
+Util::SaxSink *DynamicMessage::parserSink(DynamicMessage *message)
+{
+	return new MessageParserSink(message);
+}
+}
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DynamicSchema.h"
+
+namespace Argonauts {
+namespace Util { class SaxSink; }
+namespace Runtime { class Serializer; }
+namespace Dynamic {
+/* Read-only view of a value inside a DynamicMessage. Asking for something the type of the value does not have, like the
+ * elements of a string or a field that is not in the schema, throws Util::Exception. Only valid as long as the value is
+ * not changed.
+ */
+class ConstValueRef
+{
+public:
+	explicit ConstValueRef(const TypeDescriptor *type, const unsigned char *data) : m_type(type), m_data(data) {}
+
+	const TypeDescriptor *type() const { return m_type; }
+
+	/// Integers and enums (their value)
+	int64_t toInteger() const;
+	/// Doubles and integers
+	double toDouble() const;
+	bool toBool() const;
+	const std::string &toString() const;
+	/// The name of the entry of an enum, or an empty string if it has a value that is not an entry
+	std::string toEnumName() const;
+
+	/// Number of elements of a List or a Map
+	std::size_t size() const;
+	/// Element of a List, value of a Map
+	ConstValueRef at(const std::size_t index) const;
+	/// Key of a Map
+	const std::string &keyAt(const std::size_t index) const;
+	/// Value of a Map by its key
+	ConstValueRef value(const std::string &key) const;
+
+	/// Index of the alternative a Variant currently holds
+	std::size_t which() const;
+	ConstValueRef alternative() const;
+
+	/// Whether a field of a struct is present
+	bool has(const std::string &field) const;
+	ConstValueRef operator[](const std::string &field) const;
+
+	/// Raw JSON of the unknown fields kept by @unknownFields("keep")
+	const std::vector<std::pair<std::string, std::string>> &unknownFields() const;
+
+private:
+	const TypeDescriptor *m_type;
+	const unsigned char *m_data;
+
+	void expect(const TypeDescriptor::Kind kind) const;
+};
+
+/* An instance of a struct of a Schema that is loaded at runtime. Parses from and serializes to the same data as the
+ * generated C++ struct would, with the same checks, without any code being generated for it. Values are stored at fixed
+ * offsets like in a struct, see TypeDescriptor.
+ *
+ * Usage:
+ * ```
+ * DynamicMessage site(schema, "Site");
+ * std::unique_ptr<Util::SaxSink> sink(DynamicMessage::parserSink(&site));
+ * Util::Json::SaxReader reader(sink.get());
+ * reader.addData(data);
+ * reader.end();
+ * std::cout << site["users"].at(0)["name"].toString();
+ * ```
+ */
+class DynamicMessage
+{
+public:
+	/// Throws Util::Exception if there is no struct of that name in the schema
+	explicit DynamicMessage(const std::shared_ptr<const Schema> &schema, const std::string &name);
+	explicit DynamicMessage(const std::shared_ptr<const Schema> &schema, const MessageDescriptor *descriptor);
+	DynamicMessage(const DynamicMessage &other);
+	/// Leaves other empty, it can only be assigned to or destroyed afterwards
+	DynamicMessage(DynamicMessage &&other);
+	~DynamicMessage();
+
+	DynamicMessage &operator=(const DynamicMessage &other);
+	DynamicMessage &operator=(DynamicMessage &&other);
+
+	const MessageDescriptor *descriptor() const { return m_descriptor; }
+	ConstValueRef root() const;
+
+	bool has(const std::string &field) const { return root().has(field); }
+	ConstValueRef operator[](const std::string &field) const { return root()[field]; }
+
+	/// Setters for the fields of the struct itself, the value has to fit the type of the field. Strings are also used
+	/// for enums, by the name of the entry
+	void set(const std::string &field, const int64_t value);
+	void set(const std::string &field, const int value) { set(field, int64_t(value)); }
+	void set(const std::string &field, const double value);
+	void set(const std::string &field, const bool value);
+	void set(const std::string &field, const std::string &value);
+	void set(const std::string &field, const char *value) { set(field, std::string(value)); }
+	/// Resets the field to its default value and marks it as absent
+	void clear(const std::string &field);
+
+	/// Optional fields are only written if they are present
+	void serialize(Runtime::Serializer *serializer) const;
+
+	/// The sink expects a single object, which replaces the current content of the message
+	static Util::SaxSink *parserSink(DynamicMessage *message);
+
+private:
+	std::shared_ptr<const Schema> m_schema;
+	const MessageDescriptor *m_descriptor;
+	unsigned char *m_data;
+
+	/// Throws if there is no such field
+	std::size_t indexOf(const std::string &field) const;
+	friend class MessageParserSink;
+};
+}
+}
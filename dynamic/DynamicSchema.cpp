@@ -0,0 +1,345 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DynamicSchema.h"
+
+#include <algorithm>
+
+#include "util/ArgonautsException.h"
+#include "tool/DataTypes.h"
+
+namespace Argonauts {
+namespace Dynamic {
+namespace detail {
+static uint32_t alignTo(const uint32_t offset, const uint32_t alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+static TypeDescriptor::Kind kindFor(const Tool::Type::Builtin builtin)
+{
+	switch (builtin) {
+	case Tool::Type::Int8: return TypeDescriptor::Int8;
+	case Tool::Type::Int16: return TypeDescriptor::Int16;
+	case Tool::Type::Int32: return TypeDescriptor::Int32;
+	case Tool::Type::Int64: return TypeDescriptor::Int64;
+	case Tool::Type::UInt8: return TypeDescriptor::UInt8;
+	case Tool::Type::UInt16: return TypeDescriptor::UInt16;
+	case Tool::Type::UInt32: return TypeDescriptor::UInt32;
+	case Tool::Type::UInt64: return TypeDescriptor::UInt64;
+	case Tool::Type::Double: return TypeDescriptor::Double;
+	case Tool::Type::Bool: return TypeDescriptor::Bool;
+	case Tool::Type::String: return TypeDescriptor::String;
+	case Tool::Type::List: return TypeDescriptor::List;
+	case Tool::Type::Map: return TypeDescriptor::Map;
+	case Tool::Type::Variant: return TypeDescriptor::Variant;
+	case Tool::Type::UserDefined: break;
+	}
+	throw Util::Exception("Not a built-in type");
+}
+static uint32_t sizeOfScalar(const TypeDescriptor::Kind kind)
+{
+	switch (kind) {
+	case TypeDescriptor::Int8: case TypeDescriptor::UInt8: case TypeDescriptor::Bool: return 1;
+	case TypeDescriptor::Int16: case TypeDescriptor::UInt16: return 2;
+	case TypeDescriptor::Int32: case TypeDescriptor::UInt32: return 4;
+	default: return 8;
+	}
+}
+}
+
+int EnumDescriptor::indexOf(const std::string &entry) const
+{
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		if (entries[i].first == entry) {
+			return int(i);
+		}
+	}
+	return -1;
+}
+int EnumDescriptor::indexOf(const int64_t value) const
+{
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		if (entries[i].second == value) {
+			return int(i);
+		}
+	}
+	return -1;
+}
+
+int MessageDescriptor::indexOf(const std::string &field) const
+{
+	const auto it = m_indices.find(field);
+	return it == m_indices.end() ? -1 : it->second;
+}
+
+Schema::Schema(const Tool::File &file)
+{
+	// user defined types first, fields can refer to any of them
+	for (const Tool::Enum &enumeration : file.enums) {
+		const Tool::Type::Builtin underlying = Tool::Type::builtinFor(enumeration.type);
+		if (!Tool::Type::isInteger(underlying)) {
+			throw Util::Exception(std::string("The type of enum '") + enumeration.name + "' has to be an integer");
+		}
+		m_enums.emplace_back();
+		EnumDescriptor &descriptor = m_enums.back();
+		descriptor.name = enumeration.name;
+		descriptor.underlying = detail::kindFor(underlying);
+		for (const Tool::EnumEntry &entry : enumeration.entries) {
+			descriptor.entries.emplace_back(entry.name, entry.value);
+		}
+
+		m_types.emplace_back();
+		TypeDescriptor &type = m_types.back();
+		type.kind = TypeDescriptor::Enum;
+		type.name = enumeration.name;
+		type.size = type.alignment = detail::sizeOfScalar(descriptor.underlying);
+		type.enumeration = &descriptor;
+		m_typesByName[type.name] = &type;
+	}
+	for (const Tool::Struct &structure : file.structs) {
+		m_messages.emplace_back();
+		MessageDescriptor &descriptor = m_messages.back();
+		descriptor.name = structure.name;
+		const std::string unknownFields = structure.annotations.getString(Tool::Annotations::Keys::unknownFields, "error");
+		if (unknownFields == "skip") {
+			descriptor.unknownFields = MessageDescriptor::UnknownFields::Skip;
+		} else if (unknownFields == "keep") {
+			descriptor.unknownFields = MessageDescriptor::UnknownFields::Keep;
+		} else if (unknownFields != "error") {
+			throw Util::Exception(std::string("Unknown value '") + unknownFields + "' for unknownFields of '" + structure.name + "', expected one of 'error', 'skip', 'keep'");
+		}
+
+		m_types.emplace_back();
+		TypeDescriptor &type = m_types.back();
+		type.kind = TypeDescriptor::Message;
+		type.name = structure.name;
+		type.alignment = 0; // not laid out yet
+		type.message = &descriptor;
+		descriptor.type = &type;
+		m_typesByName[type.name] = &type;
+	}
+
+	for (std::size_t i = 0; i < file.structs.size(); ++i) {
+		const Tool::Struct &structure = file.structs.at(i);
+		MessageDescriptor &descriptor = m_messages.at(i);
+		descriptor.required.resize((structure.members.size() + 63) / 64);
+		for (const Tool::Attribute &attribute : structure.members) {
+			const bool optional = attribute.annotations.contains(Tool::Annotations::Keys::optional);
+			if (!optional) {
+				descriptor.required[descriptor.fields.size() / 64] |= uint64_t(1) << (descriptor.fields.size() % 64);
+			}
+			descriptor.m_indices[attribute.name] = int(descriptor.fields.size());
+			descriptor.fields.push_back(FieldDescriptor{attribute.name, typeFor(attribute.type, attribute.annotations.getString(Tool::Annotations::Keys::variantSelectBy)), 0, optional});
+		}
+	}
+
+	// the first fields are only known once all structs have their fields
+	for (TypeDescriptor &type : m_types) {
+		if (type.kind != TypeDescriptor::Variant || type.firstFields.empty()) {
+			continue;
+		}
+		type.firstFields.clear();
+		for (const TypeDescriptor *alternative : type.alternatives) {
+			if (alternative->kind != TypeDescriptor::Message || alternative->message->fields.empty()) {
+				throw Util::Exception(std::string("The alternatives of ") + type.name + " have to be structs with at least one field to be selected by variant.selectBy = firstFieldAvailable");
+			}
+			const std::string &field = alternative->message->fields.front().name;
+			if (std::find(type.firstFields.begin(), type.firstFields.end(), field) != type.firstFields.end()) {
+				throw Util::Exception(std::string("The first field '") + field + "' is not unique among the alternatives of " + type.name);
+			}
+			type.firstFields.push_back(field);
+		}
+	}
+
+	for (MessageDescriptor &message : m_messages) {
+		layout(&message);
+	}
+	for (TypeDescriptor &type : m_types) {
+		layout(&type);
+	}
+}
+
+std::shared_ptr<const Schema> Schema::load(const std::string &data, const std::string &filename)
+{
+	return std::make_shared<const Schema>(Tool::lexAndParse(data, filename, Tool::ResolveAliases | Tool::ResolveIncludes | Tool::VerifyAnnotations));
+}
+
+const MessageDescriptor *Schema::message(const std::string &name) const
+{
+	const auto it = m_typesByName.find(name);
+	return it == m_typesByName.end() ? nullptr : it->second->message;
+}
+const EnumDescriptor *Schema::enumeration(const std::string &name) const
+{
+	const auto it = m_typesByName.find(name);
+	return it == m_typesByName.end() ? nullptr : it->second->enumeration;
+}
+
+const TypeDescriptor *Schema::typeFor(const std::shared_ptr<Tool::Type> &type, const std::string &selectBy)
+{
+	if (!type->isBuiltin()) {
+		return userTypeFor(type->name.value);
+	}
+	// variant.selectBy changes how variants are parsed, so they are different types with and without it
+	const bool selectByFirstField = selectBy == "firstFieldAvailable";
+	const std::string name = type->toString();
+	const std::string key = selectByFirstField ? name + " firstFieldAvailable" : name;
+	const auto it = m_typesByName.find(key);
+	if (it != m_typesByName.end()) {
+		return it->second;
+	}
+
+	TypeDescriptor descriptor;
+	descriptor.kind = detail::kindFor(type->builtin);
+	descriptor.name = name;
+	switch (descriptor.kind) {
+	case TypeDescriptor::String:
+		descriptor.size = sizeof(std::string);
+		descriptor.alignment = alignof(std::string);
+		break;
+	case TypeDescriptor::List:
+		descriptor.element = typeFor(type->templateArguments.at(0), selectBy);
+		descriptor.size = sizeof(detail::RawArray);
+		descriptor.alignment = alignof(detail::RawArray);
+		break;
+	case TypeDescriptor::Map:
+		if (type->templateArguments.at(0)->builtin != Tool::Type::String) {
+			throw Util::Exception(std::string("The keys of ") + name + " have to be strings");
+		}
+		descriptor.element = typeFor(type->templateArguments.at(1), selectBy);
+		descriptor.size = sizeof(detail::RawArray);
+		descriptor.alignment = alignof(detail::RawArray);
+		break;
+	case TypeDescriptor::Variant:
+		if (type->templateArguments.empty()) {
+			throw Util::Exception("A Variant needs at least one alternative");
+		}
+		for (const std::shared_ptr<Tool::Type> &alternative : type->templateArguments) {
+			descriptor.alternatives.push_back(typeFor(alternative, selectBy));
+		}
+		if (selectByFirstField) {
+			// filled in once all structs are known
+			descriptor.firstFields.resize(descriptor.alternatives.size());
+		}
+		descriptor.alignment = 0; // not laid out yet
+		break;
+	default:
+		descriptor.size = descriptor.alignment = detail::sizeOfScalar(descriptor.kind);
+		break;
+	}
+	m_types.push_back(descriptor);
+	m_typesByName[key] = &m_types.back();
+	return &m_types.back();
+}
+TypeDescriptor *Schema::userTypeFor(const std::string &name)
+{
+	const auto it = m_typesByName.find(name);
+	if (it == m_typesByName.end() || (it->second->kind != TypeDescriptor::Enum && it->second->kind != TypeDescriptor::Message)) {
+		throw Util::Exception(std::string("Unknown type '") + name + "'");
+	}
+	return it->second;
+}
+
+void Schema::layout(TypeDescriptor *type)
+{
+	switch (type->kind) {
+	case TypeDescriptor::Message:
+		layout(const_cast<MessageDescriptor *>(type->message));
+		type->size = type->message->size;
+		type->alignment = type->message->alignment;
+		break;
+	case TypeDescriptor::Variant:
+		if (type->alignment == 0) {
+			uint32_t size = 0;
+			uint32_t alignment = alignof(uint32_t);
+			for (const TypeDescriptor *alternative : type->alternatives) {
+				layout(const_cast<TypeDescriptor *>(alternative));
+				size = std::max(size, alternative->size);
+				alignment = std::max(alignment, alternative->alignment);
+			}
+			type->valueOffset = detail::alignTo(sizeof(uint32_t), alignment);
+			type->size = detail::alignTo(type->valueOffset + size, alignment);
+			type->alignment = alignment;
+		}
+		break;
+	case TypeDescriptor::List:
+		// elements are on the heap, so a struct can contain a list of itself
+		if (type->entrySize == 0) {
+			layout(const_cast<TypeDescriptor *>(type->element));
+			type->entrySize = type->element->size;
+		}
+		break;
+	case TypeDescriptor::Map:
+		if (type->entrySize == 0) {
+			layout(const_cast<TypeDescriptor *>(type->element));
+			const uint32_t alignment = std::max(uint32_t(alignof(std::string)), type->element->alignment);
+			type->valueOffset = detail::alignTo(sizeof(std::string), type->element->alignment);
+			type->entrySize = detail::alignTo(type->valueOffset + type->element->size, alignment);
+		}
+		break;
+	default:
+		break;
+	}
+}
+void Schema::layout(MessageDescriptor *message)
+{
+	LayoutState &state = m_layoutStates[message];
+	if (state == LayoutState::Done) {
+		return;
+	} else if (state == LayoutState::InProgress) {
+		throw Util::Exception(std::string("'") + message->name + "' contains itself, which is only possible through a List or a Map");
+	}
+	state = LayoutState::InProgress;
+
+	// structs and variants are stored inline, so their size has to be known first
+	for (const FieldDescriptor &field : message->fields) {
+		if (field.type->kind == TypeDescriptor::Message || field.type->kind == TypeDescriptor::Variant) {
+			layout(const_cast<TypeDescriptor *>(field.type));
+		}
+	}
+
+	// by decreasing alignment, which leaves no padding between the fields
+	std::vector<std::size_t> order(message->fields.size());
+	for (std::size_t i = 0; i < order.size(); ++i) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [message](const std::size_t a, const std::size_t b)
+	{
+		return message->fields[a].type->alignment > message->fields[b].type->alignment;
+	});
+	uint32_t offset = message->presenceWords() * sizeof(uint64_t);
+	uint32_t alignment = message->presenceWords() > 0 ? alignof(uint64_t) : 1;
+	for (const std::size_t index : order) {
+		FieldDescriptor &field = message->fields[index];
+		offset = detail::alignTo(offset, field.type->alignment);
+		field.offset = offset;
+		offset += field.type->size;
+		alignment = std::max(alignment, field.type->alignment);
+	}
+	if (message->unknownFields == MessageDescriptor::UnknownFields::Keep) {
+		using UnknownFields = std::vector<std::pair<std::string, std::string>>;
+		offset = detail::alignTo(offset, alignof(UnknownFields));
+		message->unknownFieldsOffset = offset;
+		offset += sizeof(UnknownFields);
+		alignment = std::max(alignment, uint32_t(alignof(UnknownFields)));
+	}
+	message->alignment = alignment;
+	message->size = detail::alignTo(std::max(offset, uint32_t(1)), alignment);
+	state = LayoutState::Done;
+}
+}
+}
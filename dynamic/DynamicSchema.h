@@ -0,0 +1,176 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Argonauts {
+namespace Tool {
+struct File;
+struct Type;
+}
+namespace Dynamic {
+struct EnumDescriptor;
+struct MessageDescriptor;
+
+namespace detail {
+/// The storage of a List or a Map, TypeDescriptor::entrySize bytes per entry
+struct RawArray
+{
+	unsigned char *data = nullptr;
+	uint32_t size = 0;
+	uint32_t capacity = 0;
+};
+}
+
+/* How values of one type of the IDL are stored in a DynamicMessage. Values live at an offset into a block of memory:
+ * numbers, booleans and enums as themselves, strings as std::string, lists and maps as a detail::RawArray of their
+ * elements, variants as the index of the alternative followed by room for the largest one, and structs inline.
+ */
+struct TypeDescriptor
+{
+	enum Kind : uint8_t
+	{
+		Int8, Int16, Int32, Int64,
+		UInt8, UInt16, UInt32, UInt64,
+		Double,
+		Bool,
+		String,
+		List,
+		Map,
+		Variant,
+		Enum,
+		Message
+	};
+
+	Kind kind;
+	/// Spelled like in the IDL, for error messages
+	std::string name;
+	uint32_t size = 0;
+	uint32_t alignment = 1;
+
+	/// The elements of a List, the values of a Map
+	const TypeDescriptor *element = nullptr;
+	/// Size of an element of a List, or of a key and value of a Map
+	uint32_t entrySize = 0;
+	/// Where the value of a Map entry or of a Variant starts
+	uint32_t valueOffset = 0;
+	std::vector<const TypeDescriptor *> alternatives;
+	/// With variant.selectBy = firstFieldAvailable, the name of the first field of each alternative
+	std::vector<std::string> firstFields;
+	const EnumDescriptor *enumeration = nullptr;
+	const MessageDescriptor *message = nullptr;
+
+	bool isInteger() const { return kind <= UInt64; }
+	/// Numbers, booleans and enums, which need no construction or destruction besides zeroing their memory
+	bool isTrivial() const { return kind <= Bool || kind == Enum; }
+};
+
+struct FieldDescriptor
+{
+	std::string name;
+	const TypeDescriptor *type;
+	uint32_t offset;
+	bool optional;
+};
+
+struct EnumDescriptor
+{
+	std::string name;
+	TypeDescriptor::Kind underlying;
+	std::vector<std::pair<std::string, int64_t>> entries;
+
+	/// Index of the entry, or -1
+	int indexOf(const std::string &entry) const;
+	int indexOf(const int64_t value) const;
+};
+
+/* A struct of the IDL. Its storage starts with one bit per field that tells whether it is present, followed by the
+ * fields by decreasing alignment, and the kept unknown fields last.
+ */
+struct MessageDescriptor
+{
+	enum class UnknownFields { Error, Skip, Keep };
+
+	std::string name;
+	/// The type of values of this struct
+	const TypeDescriptor *type = nullptr;
+	/// In the order of the IDL, which is also the order they are serialized in
+	std::vector<FieldDescriptor> fields;
+	/// One bit per field, like the presence bits
+	std::vector<uint64_t> required;
+	UnknownFields unknownFields = UnknownFields::Error;
+	/// Of the std::vector<std::pair<std::string, std::string>> with the kept unknown fields
+	uint32_t unknownFieldsOffset = 0;
+	uint32_t size = 0;
+	uint32_t alignment = 1;
+
+	/// Index of the field, or -1
+	int indexOf(const std::string &field) const;
+	uint32_t presenceWords() const { return uint32_t((fields.size() + 63) / 64); }
+
+private:
+	friend class Schema;
+	std::unordered_map<std::string, int> m_indices;
+};
+
+/* The structs and enums of an IDL file, compiled into descriptors once so that DynamicMessages of them can be parsed
+ * and serialized without generated code. Include and alias resolution happens while loading.
+ *
+ * Usage:
+ * ```
+ * const std::shared_ptr<const Schema> schema = Schema::load(Util::FS::readFile("grammar.arg"), "grammar.arg");
+ * DynamicMessage site(schema, "Site");
+ * ```
+ */
+class Schema
+{
+public:
+	/// Aliases and includes of the file have to be resolved already. Throws Util::Exception for things that can not be
+	/// stored, like maps with keys that are not strings
+	explicit Schema(const Tool::File &file);
+
+	/// Parses an IDL file and compiles it, throws Util::Error if it is not valid
+	static std::shared_ptr<const Schema> load(const std::string &data, const std::string &filename = "<unknown>");
+
+	/// nullptr if there is no such struct or enum
+	const MessageDescriptor *message(const std::string &name) const;
+	const EnumDescriptor *enumeration(const std::string &name) const;
+
+private:
+	// deques, so that descriptors never move once they are referred to
+	std::deque<TypeDescriptor> m_types;
+	std::deque<MessageDescriptor> m_messages;
+	std::deque<EnumDescriptor> m_enums;
+	std::unordered_map<std::string, TypeDescriptor *> m_typesByName;
+
+	enum class LayoutState { None, InProgress, Done };
+	std::unordered_map<const MessageDescriptor *, LayoutState> m_layoutStates;
+
+	const TypeDescriptor *typeFor(const std::shared_ptr<Tool::Type> &type, const std::string &selectBy);
+	TypeDescriptor *userTypeFor(const std::string &name);
+	void layout(TypeDescriptor *type);
+	void layout(MessageDescriptor *message);
+};
+}
+}
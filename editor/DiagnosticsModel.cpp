@@ -19,11 +19,9 @@
 #include <QIcon>
 
 DiagnosticsModel::DiagnosticsModel(Document *document, QObject *parent)
-	: QAbstractListModel(parent), m_document(document)
+	: QAbstractListModel(parent), m_document(document), m_diagnostics(document->diagnosticsFor())
 {
-	connect(m_document, &Document::diagnosticAdded, this, &DiagnosticsModel::diagnosticAdded);
-	connect(m_document, &Document::diagnosticRemoved, this, &DiagnosticsModel::diagnosticRemoved);
-	connect(m_document, &Document::diagnosticsReset, this, &DiagnosticsModel::diagnosticsReset);
+	connect(m_document, &Document::diagnosticsChanged, this, &DiagnosticsModel::diagnosticsChanged);
 }
 
 int DiagnosticsModel::rowCount(const QModelIndex &) const
@@ -57,23 +55,10 @@ QVariant DiagnosticsModel::data(const QModelIndex &index, int role) const
 	}
 }
 
-void DiagnosticsModel::diagnosticAdded(const Document::Diagnostic &diagnostic)
-{
-	beginInsertRows(QModelIndex(), m_diagnostics.size(), m_diagnostics.size());
-	m_diagnostics.append(diagnostic);
-	endInsertRows();
-}
-void DiagnosticsModel::diagnosticRemoved(const Document::Diagnostic &diagnostic)
-{
-	const int index = m_diagnostics.indexOf(diagnostic);
-	beginRemoveRows(QModelIndex(), index, index);
-	m_diagnostics.removeAt(index);
-	endRemoveRows();
-}
-void DiagnosticsModel::diagnosticsReset()
+void DiagnosticsModel::diagnosticsChanged(const QVector<Document::Diagnostic> &diagnostics)
 {
 	beginResetModel();
-	m_diagnostics.clear();
+	m_diagnostics = diagnostics;
 	endResetModel();
 }
 
@@ -39,9 +39,7 @@ public:
 	QVariant data(const QModelIndex &index, int role) const override;
 
 private slots:
-	void diagnosticAdded(const Document::Diagnostic &diagnostic);
-	void diagnosticRemoved(const Document::Diagnostic &diagnostic);
-	void diagnosticsReset();
+	void diagnosticsChanged(const QVector<Document::Diagnostic> &diagnostics);
 
 private:
 	Document *m_document;
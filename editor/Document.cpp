@@ -21,17 +21,23 @@
 #include <QSyntaxHighlighter>
 #include <QRegularExpression>
 #include <QStack>
+#include <QTimer>
 #include <QDebug>
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #include "common/Lexer.h"
-#include "common/GeneralParser.h"
+#include "common/TableParser.h"
+#include "common/grammar/Idl.grammar.h"
 #include "common/Token.h"
 #include "util/Error.h"
 
 using Argonauts::Common::Lexer;
-using Argonauts::Common::GeneralParser;
+using Argonauts::Common::TableParser;
+using Argonauts::Common::IdlGrammar;
 using Argonauts::Common::Token;
+using Argonauts::Common::TokenList;
 using Argonauts::Util::Error;
 
 struct UserData : public QTextBlockUserData
@@ -48,30 +54,35 @@ struct UserData : public QTextBlockUserData
 
 	~UserData()
 	{
-		for (const Document::Diagnostic &diagnostic : diagnostics) {
-			emit document->diagnosticRemoved(diagnostic);
+		if (registry) {
+			registry->remove(this);
 		}
 	}
 
+	// all positions are relative to the start of the block, so that blocks after an edit stay valid without being re-highlighted
 	QVector<Document::TypeDefinition> definitions;
 	QVector<Document::TypeUsage> usages;
-
 	QVector<Document::Diagnostic> diagnostics;
-	void addDiagnostic(const int start, const int end, const QString &string, const Document::Diagnostic::Type type = Document::Diagnostic::Error)
+	QTextBlock block; ///< The block this belongs to, stays valid as long as the block and therefore this exists
+	std::shared_ptr<QSet<const UserData *>> registry; ///< Document::m_blocksWithDiagnostics while this has diagnostics
+
+	/// A token on the value stack, together with the highlighting pass that shifted it (0 for empty values that were not
+	/// shifted). Tokens carried over from earlier blocks keep the absolute offsets they were lexed with, which are outdated
+	/// once text above them changes, so only the pass tells whether a token belongs to the block being highlighted
+	struct Value
 	{
-		diagnostics.append(Document::Diagnostic{type, start, end, string});
-		emit document->diagnosticAdded(diagnostics.last());
-	}
+		Token token;
+		quint64 pass;
+	};
 
-	Document *document = nullptr;
 	bool isValid = false;
-	UserData *previous = nullptr;
-	Lexer::StartState state = Lexer::Normal;
-	std::vector<Token> tokens; ///< Tokens in this block
-	std::vector<Token> tokenStack; ///< Current token stack, as used by the parser
+	Lexer::StartState state = Lexer::Normal; ///< Lexer state at the end of this block
+	TokenList tokens; ///< Tokens in this block
+	TableParser::Stack parserStack; ///< Parser state stack at the end of this block
+	std::vector<Value> valueStack; ///< Mirrors parserStack, one token per state
 };
 
-class SyntaxHighlighter : public QSyntaxHighlighter
+class SyntaxHighlighter : public QSyntaxHighlighter, private TableParser::Handler
 {
 public:
 	QTextCharFormat m_commentFormat;
@@ -82,8 +93,14 @@ public:
 	QTextCharFormat m_stringFormat;
 	QTextCharFormat m_integerFormat;
 
+	// the parser operates on the block that is currently being highlighted
+	TableParser m_parser;
+	UserData *m_current = nullptr;
+	int m_blockStart = 0;
+	quint64 m_pass = 0; ///< Incremented for every highlighted block, identifies the tokens shifted while highlighting it
+
 	explicit SyntaxHighlighter(Document *document)
-		: QSyntaxHighlighter(document)
+		: QSyntaxHighlighter(document), m_parser(IdlGrammar::tables())
 	{
 		m_commentFormat.setForeground(Qt::darkGreen);
 		m_keywordFormat.setForeground(Qt::darkYellow);
@@ -94,6 +111,75 @@ public:
 		m_integerFormat.setForeground(Qt::darkBlue);
 	}
 
+	bool isFromCurrentBlock(const UserData::Value &value) const
+	{
+		return value.pass == m_pass;
+	}
+
+	void addDefinition(const Document::TypeDefinition::Type type, const UserData::Value &value)
+	{
+		if (!isFromCurrentBlock(value)) {
+			return;
+		}
+		const Token &token = value.token;
+		const int start = token.offset - m_blockStart;
+		m_current->definitions.append(Document::TypeDefinition{type, start, start + token.length, QString::fromStdString(m_current->tokens.string(token))});
+	}
+	void addUsage(const UserData::Value &value)
+	{
+		if (!isFromCurrentBlock(value)) {
+			return;
+		}
+		const Token &token = value.token;
+		const int start = token.offset - m_blockStart;
+		m_current->usages.append(Document::TypeUsage{start, start + token.length, QString::fromStdString(m_current->tokens.string(token))});
+	}
+
+	void shift(const Token &token) override
+	{
+		m_current->valueStack.push_back(UserData::Value{token, m_pass});
+	}
+	void reduce(const int action, const int length) override
+	{
+		std::vector<UserData::Value> &values = m_current->valueStack;
+		// names are usually reduced right after they have been shifted, but only tokens of the current block can be formatted
+		switch (action) {
+		case IdlGrammar::StructName: addDefinition(Document::TypeDefinition::Struct, values.back()); break;
+		case IdlGrammar::EnumName: addDefinition(Document::TypeDefinition::Enum, values.back()); break;
+		case IdlGrammar::AliasName: addDefinition(Document::TypeDefinition::Alias, values.back()); break;
+		case IdlGrammar::AttributeName: addDefinition(Document::TypeDefinition::Attribute, values.back()); break;
+		case IdlGrammar::EntryName: addDefinition(Document::TypeDefinition::Entry, values.back()); break;
+		case IdlGrammar::TypeName: addUsage(values.back()); break;
+		case IdlGrammar::DefineAnnotation:
+			if (isFromCurrentBlock(values.back())) {
+				setFormat(values.back().token, m_annotationNameFormat);
+			}
+			break;
+		case IdlGrammar::NamedAnnotationValue: {
+			const UserData::Value &name = values.at(values.size() - 3);
+			if (isFromCurrentBlock(name)) {
+				setFormat(name.token, m_annotationNameFormat);
+			}
+			break;
+		}
+		}
+		if (length == 0) {
+			values.push_back(UserData::Value{Token(), 0});
+		} else {
+			values.resize(values.size() - std::size_t(length - 1));
+		}
+	}
+	void unexpected(const Token &token) override
+	{
+		const int start = token.offset - m_blockStart;
+		if (token.type == Token::Error) {
+			m_current->diagnostics.append(Document::Diagnostic{Document::Diagnostic::Error, start, start + token.length, QString::fromStdString(m_current->tokens.string(token))});
+		} else {
+			m_current->diagnostics.append(Document::Diagnostic{Document::Diagnostic::Error, start, start + token.length,
+															   SyntaxHighlighter::tr("Unexpected token '%1'").arg(QString::fromStdString(Token::toString(token.type)))});
+		}
+	}
+
 	QTextCharFormat makeErrorFormat(const QTextCharFormat &fmt)
 	{
 		QTextCharFormat newFormat = fmt;
@@ -102,80 +188,55 @@ public:
 		return newFormat;
 	}
 
-	void highlightBlock(const QString &text) override
+	/// QSyntaxHighlighter only continues with the next block if the block state changes, so it is used as a generation counter
+	/// that is bumped whenever the lexer state or parser stack handed to the next block differs from the previous pass.
+	/// The parser states fully determine how the following blocks parse, the values on the value stack do not.
+	static int nextBlockState(const int state)
 	{
-		const int blockStart = currentBlock().position();
+		return state < 0 || state == std::numeric_limits<int>::max() ? 0 : state + 1;
+	}
 
-		std::shared_ptr<UserData> previousData = UserData::getForBlock(currentBlock().previous());
+	void highlightBlock(const QString &text) override
+	{
+		const std::shared_ptr<UserData> previousData = UserData::getForBlock(currentBlock().previous());
 
-		UserData *data = new UserData;
-		data->document = static_cast<Document *>(document());
+		// reuse the data of this block instead of allocating new data for every pass
+		UserData *data = static_cast<UserData *>(currentBlockUserData());
+		if (!data) {
+			data = new UserData;
+			setCurrentBlockUserData(data);
+		}
+		const QVector<Document::Diagnostic> previousDiagnostics = data->diagnostics;
+		const bool wasValid = data->isValid;
+		const Lexer::StartState previousState = data->state;
+		const TableParser::Stack previousParserStack = data->parserStack;
 		data->isValid = true;
-		data->previous = previousData->isValid ? previousData.get() : nullptr;
-
-		auto defineAnnotation = [this](const Token &token, const std::vector<Token> &stack)
-		{
-			setFormat(token, m_annotationNameFormat);
-			return GeneralParser::defineAnnotation(token, stack);
-		};
-		auto addToAnnotation = [this](const Token &token, const std::vector<Token> &stack)
-		{
-			for (int i = (stack.size() - 1); i >= 0; --i) {
-				if (stack.at(i).type == Token::Annotation) {
-					setFormat(stack.at(i + 2), m_annotationNameFormat);
-				}
-			}
-			return GeneralParser::addToAnnotation(token, stack);
-		};
-		auto typeDefinition = [data](const std::vector<Token> &stack)
-		{
-			const Token typeToken = stack.back();
-			for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
-				if (it->type == Token::Keyword_Struct) {
-					data->definitions.append(Document::TypeDefinition{Document::TypeDefinition::Struct, typeToken.offset, typeToken.offset + typeToken.length, QString::fromStdString(typeToken.string())});
-				} else if (it->type == Token::Keyword_Enum) {
-					data->definitions.append(Document::TypeDefinition{Document::TypeDefinition::Enum, typeToken.offset, typeToken.offset + typeToken.length, QString::fromStdString(typeToken.string())});
-				} else if (it->type == Token::Keyword_Using) {
-					data->definitions.append(Document::TypeDefinition{Document::TypeDefinition::Alias, typeToken.offset, typeToken.offset + typeToken.length, QString::fromStdString(typeToken.string())});
-				} else if (it->type == Token::Struct) {
-					data->definitions.append(Document::TypeDefinition{Document::TypeDefinition::Attribute, typeToken.offset, typeToken.offset + typeToken.length, QString::fromStdString(typeToken.string())});
-				} else if (it->type == Token::Enum) {
-					data->definitions.append(Document::TypeDefinition{Document::TypeDefinition::Entry, typeToken.offset, typeToken.offset + typeToken.length, QString::fromStdString(typeToken.string())});
-				} else {
-					continue;
-				}
-				break;
-			}
-		};
-		auto typeUsage = [data](const std::vector<Token> &stack)
-		{
-			const Token token = stack.back();
-			data->usages.append(Document::TypeUsage{token.offset, token.offset + token.length, QString::fromStdString(token.string())});
-		};
-		auto morphIdentifierToType = [](const Token &token) { return Token(Token::Type, token.string(), token.offset, token.length); };
-		auto morphTypeToTypeList = [](const Token &token) { return Token(Token::TypeList, std::string(), token.offset, token.length); };
-		auto unexpected = [data](const Token &token)
-		{
-			if (token.type == Token::Error) {
-				data->addDiagnostic(token.offset, token.offset + token.length, QString::fromStdString(token.string()));
-			} else {
-				data->addDiagnostic(token.offset, token.offset + token.length, SyntaxHighlighter::tr("Unexpected token '%1'").arg(QString::fromStdString(Token::toString(token.type))));
-			}
-		};
+		data->definitions.clear();
+		data->usages.clear();
+		data->diagnostics.clear();
+
+		data->block = currentBlock();
+		m_current = data;
+		m_blockStart = currentBlock().position();
+		++m_pass;
 
 		Lexer lexer;
-		lexer.setOffset(currentBlock().position());
-		lexer.setState(previousData ? previousData->state : Lexer::Normal);
+		lexer.setOffset(m_blockStart);
+		lexer.setState(previousData->isValid ? previousData->state : Lexer::Normal);
 		data->tokens = lexer.consume(text.toStdString(), std::string(), false);
-		data->tokenStack = GeneralParser::parse({&GeneralParser::defineStruct, &GeneralParser::defineStructWithInclude, &GeneralParser::defineEnum, &GeneralParser::defineUsing,
-												 defineAnnotation, addToAnnotation, &GeneralParser::defineEnumEntry, &GeneralParser::defineStructAttribute,
-												 &GeneralParser::defineStructAttributeWithIndex, &GeneralParser::convertTypeToTypeList, &GeneralParser::mergeTypeListAndType, &GeneralParser::finalizeType},
-												{typeDefinition, typeUsage},
-												{morphIdentifierToType, morphTypeToTypeList},
-												previousData ? previousData->tokenStack : std::vector<Token>(),
-												data->tokens,
-												unexpected);
-		for (const Token &token : data->tokens) {
+		if (previousData->isValid) {
+			m_parser.setStack(previousData->parserStack);
+			data->valueStack = previousData->valueStack;
+		} else {
+			m_parser.reset();
+			data->valueStack.assign(1, UserData::Value{Token(), 0});
+		}
+		m_parser.consume(data->tokens.tokens(), this);
+		data->parserStack = m_parser.stack();
+		data->state = lexer.state();
+		m_current = nullptr;
+
+		for (const Token &token : data->tokens.tokens()) {
 			switch (token.type) {
 			case Token::Comment: setFormat(token, m_commentFormat); break;
 			case Token::String: setFormat(token, m_stringFormat); break;
@@ -190,7 +251,7 @@ public:
 		}
 		for (const Document::Diagnostic &diagnostic : data->diagnostics) {
 			for (int i = diagnostic.start; i <= diagnostic.end; ++i) {
-				setFormat(i - blockStart, 1, makeErrorFormat(format(i)));
+				setFormat(i, 1, makeErrorFormat(format(i)));
 			}
 		}
 		for (const Document::TypeDefinition &def : data->definitions) {
@@ -198,20 +259,33 @@ public:
 			case Document::TypeDefinition::Struct:
 			case Document::TypeDefinition::Enum:
 			case Document::TypeDefinition::Alias:
-				setFormat(def.start - currentBlock().position(), def.end - def.start, m_typeFormat);
+				setFormat(def.start, def.end - def.start, m_typeFormat);
 				break;
 			case Document::TypeDefinition::Attribute:
 			case Document::TypeDefinition::Entry:
-				setFormat(def.start - currentBlock().position(), def.end - def.start, m_attributeNameFormat);
+				setFormat(def.start, def.end - def.start, m_attributeNameFormat);
 				break;
 			}
 
 		}
 		for (const Document::TypeUsage &def : data->usages) {
-			setFormat(def.start - currentBlock().position(), def.end - def.start, m_typeFormat);
+			setFormat(def.start, def.end - def.start, m_typeFormat);
+		}
+
+		if (!wasValid || data->state != previousState || data->parserStack != previousParserStack) {
+			setCurrentBlockState(nextBlockState(currentBlockState()));
+		}
+		if (data->diagnostics != previousDiagnostics) {
+			Document *doc = static_cast<Document *>(document());
+			if (data->diagnostics.isEmpty()) {
+				doc->m_blocksWithDiagnostics->remove(data);
+				data->registry.reset();
+			} else {
+				doc->m_blocksWithDiagnostics->insert(data);
+				data->registry = doc->m_blocksWithDiagnostics;
+			}
+			doc->scheduleDiagnosticsUpdate();
 		}
-		data->state = lexer.state();
-		setCurrentBlockUserData(data);
 	}
 
 	using QSyntaxHighlighter::setFormat;
@@ -221,15 +295,29 @@ public:
 	}
 	void setFormat(const Token &token, const QTextCharFormat &format)
 	{
-		setFormat(token.offset - currentBlock().position(), token.length, format);
+		setFormat(token.offset - m_blockStart, token.length, format);
 	}
 };
 
 Document::Document(QObject *parent)
 	: QTextDocument(parent)
 {
+	m_diagnosticsTimer = new QTimer(this);
+	m_diagnosticsTimer->setSingleShot(true);
+	m_diagnosticsTimer->setInterval(0);
+	connect(m_diagnosticsTimer, &QTimer::timeout, this, &Document::updateDiagnostics);
+
 	setDocumentLayout(new QPlainTextDocumentLayout(this));
 	new SyntaxHighlighter(this);
+
+	// edits move the absolute positions of all following diagnostics, even if no block needs to be re-highlighted. only
+	// the blocks with diagnostics are looked at again, so this is cheap
+	connect(this, &QTextDocument::contentsChange, this, [this](int, int, int)
+	{
+		if (!m_diagnostics.isEmpty()) {
+			scheduleDiagnosticsUpdate();
+		}
+	});
 }
 
 void Document::setFileName(const QString &filename)
@@ -253,18 +341,46 @@ void Document::setPlainText(const QString &text)
 {
 	QTextDocument::setPlainText(text);
 	save();
-	emit diagnosticsReset();
+	scheduleDiagnosticsUpdate();
+}
+
+void Document::scheduleDiagnosticsUpdate()
+{
+	m_diagnosticsTimer->start();
+}
+void Document::updateDiagnostics()
+{
+	const QVector<Diagnostic> diagnostics = diagnosticsFor();
+	if (diagnostics != m_diagnostics) {
+		m_diagnostics = diagnostics;
+		emit diagnosticsChanged(m_diagnostics);
+	}
+}
+
+static QVector<Document::Diagnostic> diagnosticsForBlock(const QTextBlock &block, const UserData &data)
+{
+	QVector<Document::Diagnostic> out = data.diagnostics;
+	for (Document::Diagnostic &diagnostic : out) {
+		diagnostic.start += block.position();
+		diagnostic.end += block.position();
+	}
+	return out;
+}
+static QVector<Document::Diagnostic> diagnosticsForBlock(const QTextBlock &block)
+{
+	return diagnosticsForBlock(block, *UserData::getForBlock(block));
 }
 
 QVector<Document::Diagnostic> Document::diagnosticsFor(const QTextCursor &cursor) const
 {
 	QVector<Diagnostic> out;
 	if (cursor.isNull()) {
-		for (auto block = begin(); block != end(); block = block.next()) {
-			out += UserData::getForBlock(block)->diagnostics;
+		for (const UserData *data : *m_blocksWithDiagnostics) {
+			out += diagnosticsForBlock(data->block, *data);
 		}
+		std::stable_sort(out.begin(), out.end(), [](const Diagnostic &a, const Diagnostic &b) { return a.start < b.start; });
 	} else {
-		const QVector<Diagnostic> tmp = UserData::getForBlock(cursor.block())->diagnostics;
+		const QVector<Diagnostic> tmp = diagnosticsForBlock(cursor.block());
 		for (const Diagnostic &candidate : tmp) {
 			if (candidate.start <= cursor.position() && candidate.end >= cursor.position()) {
 				out.append(candidate);
@@ -276,7 +392,7 @@ QVector<Document::Diagnostic> Document::diagnosticsFor(const QTextCursor &cursor
 
 QVector<Document::Diagnostic> Document::diagnosticsFor(const QTextBlock &block) const
 {
-	return UserData::getForBlock(block)->diagnostics;
+	return diagnosticsForBlock(block);
 }
 
 Document::TypeDefinition Document::findDefinitionFor(const QString &name) const
@@ -285,7 +401,7 @@ Document::TypeDefinition Document::findDefinitionFor(const QString &name) const
 		const std::shared_ptr<UserData> data = UserData::getForBlock(block);
 		for (const TypeDefinition &def : data->definitions) {
 			if (def.name == name) {
-				return def;
+				return TypeDefinition{def.type, def.start + block.position(), def.end + block.position(), def.name};
 			}
 		}
 	}
@@ -299,7 +415,7 @@ QVector<Document::TypeUsage> Document::findUsagesFor(const QString &name) const
 		const std::shared_ptr<UserData> data = UserData::getForBlock(block);
 		for (const TypeUsage &usage : data->usages) {
 			if (usage.name == name) {
-				out.append(usage);
+				out.append(TypeUsage{usage.start + block.position(), usage.end + block.position(), usage.name});
 			}
 		}
 	}
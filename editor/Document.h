@@ -18,6 +18,12 @@
 
 #include <QTextDocument>
 #include <QTextCursor>
+#include <QVector>
+#include <QSet>
+#include <memory>
+
+class QTimer;
+struct UserData;
 
 class Document : public QTextDocument
 {
@@ -81,13 +87,22 @@ signals:
 	void fileNameChanged(const QString &filename);
 	void nameChanged(const QString &name);
 
-	void diagnosticAdded(const Diagnostic &diagnostic);
-	void diagnosticRemoved(const Diagnostic &diagnostic);
-	void diagnosticsReset();
+	/// Emitted at most once per event loop iteration, after highlighting has settled
+	void diagnosticsChanged(const QVector<Document::Diagnostic> &diagnostics);
 
 private:
+	friend class SyntaxHighlighter;
+	void scheduleDiagnosticsUpdate();
+	void updateDiagnostics();
+
 	QString m_fileName;
 	int m_savedRevision;
+
+	QTimer *m_diagnosticsTimer;
+	QVector<Diagnostic> m_diagnostics;
+	/// The data of all blocks that have diagnostics, so that collecting them does not need to look at every block. Shared
+	/// with the data, which removes itself when its block is deleted, even if that happens after this document is gone
+	std::shared_ptr<QSet<const UserData *>> m_blocksWithDiagnostics = std::make_shared<QSet<const UserData *>>();
 };
 
 Q_DECLARE_METATYPE(Document::Diagnostic)
@@ -21,16 +21,87 @@
 #include "util/StringUtil.h"
 
 #include <iostream>
+#include <vector>
 #include <boost/filesystem.hpp>
 
 using namespace Argonauts::Util;
 
+namespace {
+struct Segment
+{
+	enum Type { Literal, Expression, Statement } type;
+	std::string content;
+};
+
+bool isBlank(const std::string &string, const std::size_t from, const std::size_t to)
+{
+	return string.find_first_not_of(" \t", from) >= to;
+}
+
+/* Removes the indentation and the line break around <% statements %> that are alone on their line, otherwise every
+ * if/for in a template leaves an empty line behind in the output
+ */
+void trimStatementLines(std::vector<Segment> &segments)
+{
+	// a trimmed line also takes the line break of the previous one, so the next line starts right after it
+	std::vector<bool> trimmed(segments.size(), false);
+	for (std::size_t i = 0; i < segments.size(); ++i) {
+		if (segments[i].type != Segment::Statement) {
+			continue;
+		}
+
+		std::size_t lineStart = 0;
+		if (i > 0) {
+			if (segments[i - 1].type != Segment::Literal) {
+				continue;
+			}
+			const std::string &before = segments[i - 1].content;
+			const std::size_t newline = before.rfind('\n');
+			if (newline == std::string::npos && i > 1 && !trimmed[i - 2]) {
+				continue;
+			}
+			lineStart = newline == std::string::npos ? 0 : newline + 1;
+			if (!isBlank(before, lineStart, before.size())) {
+				continue;
+			}
+		}
+
+		std::size_t lineEnd = 0;
+		if (i + 1 < segments.size()) {
+			if (segments[i + 1].type != Segment::Literal) {
+				continue;
+			}
+			const std::string &after = segments[i + 1].content;
+			const std::size_t newline = after.find('\n');
+			if (newline == std::string::npos || !isBlank(after, 0, newline)) {
+				continue;
+			}
+			lineEnd = newline + 1;
+		}
+
+		trimmed[i] = true;
+		if (i > 0) {
+			segments[i - 1].content.erase(lineStart);
+		}
+		if (i + 1 < segments.size()) {
+			segments[i + 1].content.erase(0, lineEnd);
+		}
+	}
+}
+
+std::string escape(const std::string &string)
+{
+	return String::replaceAll(String::replaceAll(String::replaceAll(String::replaceAll(string, "\\", "\\\\"), "\n", "\\n"), "\t", "\\t"), "\"", "\\\"");
+}
+}
+
 /* This function will process the given `data` and produce two result strings: a header and a source file.
  *
  * The given input data should start of with metadata rows in the format `<key>: <value>`. `<key>` can be `arguments`
  * or `includes`. In the case of `arguments`, the `<value>` is copied verbatim as the argument list for the generated
- * function. `includes` are split up at ',' and then each is added as an #include line in the final header. Rows
- * that do not start with a recognized key are simply skipped, this can be used to add a license header or similar.
+ * function, after a first `std::string &out` argument to which the output gets appended. `includes` are split up at
+ * ',' and then each is added as an #include line in the final header. Rows that do not start with a recognized key
+ * are simply skipped, this can be used to add a license header or similar.
  *
  * After those rows an empty row must follow, after which the actual template contents are. These can be anything, but
  * the following are handled specially:
@@ -38,7 +109,8 @@ using namespace Argonauts::Util;
  *     * expression has to result in a std::string, char*, const char*, or any type that std::to_string can take. The
  *       output will be appended to the runtime output at runtime.
  * * <% statement %>
- *     * Anything put here will be copied directly to the output when the template is processed.
+ *     * Anything put here will be copied directly to the output when the template is processed. If the statement is
+ *       the only thing on its line the entire line, including the line break, is left out of the output.
  * * Everything else is copied unchanged.
  *
  * Example:
@@ -63,7 +135,8 @@ using namespace Argonauts::Util;
  * Trillian
  * ```
  *
- * It is important to note that quite a bit of whitespace (including newlines) will be left in the final output.
+ * Consecutive literal text ends up in a single append, and the output buffer is reserved up front based on the
+ * amount of literal text in the template.
  */
 std::pair<std::string, std::string> processEct(const std::string &filename, const std::string &data)
 {
@@ -83,47 +156,85 @@ std::pair<std::string, std::string> processEct(const std::string &filename, cons
 		}
 		index = rowEnd + 1;
 	}
-	std::string header, source;
-	header += std::string("#pragma once\n")
-			+ "#include <string>\n";
-	for (const std::string &include : String::splitStrings(includesRow, ", ")) {
-		header += "#include " + include + "\n";
-	}
-	header += "std::string generate" + boost::filesystem::path(filename).stem().string() + "(" + argumentsRow + ");\n";
-	source += "#include \"" + boost::filesystem::path(filename).filename().string() + ".h\"\n"
-			+ "\n"
-			+ "static inline std::string toString(const std::string &string) { return string; }\n"
-			+ "static inline std::string toString(const char *string) { return string; }\n"
-			+ "static inline std::string toString(char *string) { return string; }\n"
-			+ "template <typename T> static inline std::string toString(const T val) { return std::to_string(val); }\n"
-			+ "\n"
-			+ "std::string generate" + boost::filesystem::path(filename).stem().string() + "(" + argumentsRow + ")\n"
-			+ "{\n"
-			+ "\tstd::string out;\n";
+
+	std::vector<Segment> segments;
+	const auto appendLiteral = [&segments](const std::string &literal)
+	{
+		if (!segments.empty() && segments.back().type == Segment::Literal) {
+			segments.back().content += literal;
+		} else {
+			segments.push_back({Segment::Literal, literal});
+		}
+	};
 	while (true) {
 		const std::size_t next = data.find('<', index);
-		source += "\tout += toString(\"" + String::replaceAll(String::replaceAll(String::replaceAll(data.substr(index, next - index), "\n", "\\n"), "\t", "\\t"), "\"", "\\\"") + "\");\n";
+		appendLiteral(data.substr(index, next - index));
 		if (next == std::string::npos) {
 			break;
 		}
-		if (data.size() > next && data.at(next + 1) == '%') {
+		if (data.size() > next + 1 && data.at(next + 1) == '%') {
 			const std::size_t end = data.find("%>", next);
 			if (end == std::string::npos) {
 				throw Error("'<%' or '<%=' token without ending", next, Error::Source(data, filename));
 			}
 			if (data.at(next + 2) == '=') {
-				source += "\tout += toString(" + data.substr(next + 3, end - (next + 3)) + ");\n";
+				segments.push_back({Segment::Expression, data.substr(next + 3, end - (next + 3))});
 			} else {
-				source += '\t' + data.substr(next + 2, end - (next + 2)) + "\n";
+				segments.push_back({Segment::Statement, data.substr(next + 2, end - (next + 2))});
 			}
 			index = end + 2;
 		} else {
-			source += "\tout += '<';\n";
+			appendLiteral("<");
 			index = next + 1;
 		}
 	}
-	source += std::string("\treturn out;\n")
-			+ "}\n";
+	trimStatementLines(segments);
+
+	std::size_t literalSize = 0;
+	for (const Segment &segment : segments) {
+		if (segment.type == Segment::Literal) {
+			literalSize += segment.content.size();
+		}
+	}
+
+	const std::string functionName = "generate" + boost::filesystem::path(filename).stem().string();
+	const std::string signature = "void " + functionName + "(std::string &out" + (argumentsRow.empty() ? "" : ", " + argumentsRow) + ")";
+
+	std::string header, source;
+	header += std::string("#pragma once\n")
+			+ "#include <string>\n";
+	for (const std::string &include : String::splitStrings(includesRow, ", ")) {
+		header += "#include " + include + "\n";
+	}
+	header += signature + ";\n";
+	// lets users of the generated code notice when the template changed, for example to invalidate caches
+	header += "constexpr const char " + functionName + "Fingerprint[] = \"" + String::toHexString(String::contentHash(data)) + "\";\n";
+	source += "#include \"" + boost::filesystem::path(filename).filename().string() + ".h\"\n"
+			+ "\n"
+			+ "static inline void append(std::string &out, const std::string &string) { out += string; }\n"
+			+ "static inline void append(std::string &out, const char *string) { out += string; }\n"
+			+ "static inline void append(std::string &out, char *string) { out += string; }\n"
+			+ "template <typename T> static inline void append(std::string &out, const T val) { out += std::to_string(val); }\n"
+			+ "\n"
+			+ signature + "\n"
+			+ "{\n"
+			+ "\tout.reserve(out.size() + " + std::to_string(literalSize) + ");\n";
+	for (const Segment &segment : segments) {
+		switch (segment.type) {
+		case Segment::Literal:
+			if (!segment.content.empty()) {
+				source += "\tout.append(\"" + escape(segment.content) + "\", " + std::to_string(segment.content.size()) + ");\n";
+			}
+			break;
+		case Segment::Expression:
+			source += "\tappend(out, " + segment.content + ");\n";
+			break;
+		case Segment::Statement:
+			source += '\t' + segment.content + "\n";
+			break;
+		}
+	}
+	source += "}\n";
 	return {header, source};
 }
 
@@ -151,8 +262,8 @@ int main(int argc, const char **argv)
 			const boost::filesystem::path filename = boost::filesystem::path(infile).filename();
 			const std::string contents = FS::readFile(infile);
 			const std::pair<std::string, std::string> outdata = processEct(infile, contents);
-			FS::writeFile((outdir / filename).string() + ".h", outdata.first);
-			FS::writeFile((outdir / filename).string() + ".cpp", outdata.second);
+			FS::writeFileIfChanged((outdir / filename).string() + ".h", outdata.first);
+			FS::writeFileIfChanged((outdir / filename).string() + ".cpp", outdata.second);
 		}
 		return CLI::Execution::ExitSuccess;
 	});
@@ -36,11 +36,12 @@ int main(int argc, char **argv)
 	builder.add_users(userBuilder);
 	const Site site = builder.build();
 
-	Argonauts::Util::StringOutputStream stream;
+	Argonauts::Util::StdOutputStream stream(std::cout);
 	Argonauts::Util::Json::SaxWriter writer(&stream);
 	Argonauts::Runtime::SaxSinkSerializer serializer(&writer);
 	site.serialize(&serializer);
-	std::cout << stream.result() << std::endl;
+	stream.flush();
+	std::cout << std::endl;
 
 	return 0;
 }
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "util/SaxSink.h"
+
+// libFuzzer entry point, implemented once by every target in this directory
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size);
+
+// like ASSERT, but also active in release builds, since fuzzing usually happens with optimizations
+#define FUZZ_CHECK(CONDITION, MESSAGE) \
+	do { if (!(CONDITION)) { std::fprintf(stderr, "%s:%d: %s failed: %s\n", __FILE__, __LINE__, #CONDITION, std::string(MESSAGE).c_str()); std::abort(); } } while (false)
+
+namespace Argonauts {
+namespace Fuzz {
+/// Records everything it receives in a comparable form. Two readers agree on a document if their recorders are equal
+class TokenRecorder : public Util::SaxSink
+{
+public:
+	std::vector<std::string> tokens;
+
+	bool null() override { return record("null"); }
+	bool boolean(const bool val) override { return record(val ? "true" : "false"); }
+	bool integerNumber(const int64_t val) override { return record("int " + std::to_string(val)); }
+	bool doubleNumber(const double val) override
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.17g", val);
+		return record(std::string("double ") + buffer);
+	}
+	bool string(const std::string &str) override { return record("string " + str); }
+	bool startObject() override { return record("{"); }
+	bool key(const std::string &str) override { return record("key " + str); }
+	bool endObject(const std::size_t size) override { return record("} " + std::to_string(size)); }
+	bool startArray() override { return record("["); }
+	bool endArray(const std::size_t size) override { return record("] " + std::to_string(size)); }
+
+private:
+	bool record(const std::string &token)
+	{
+		tokens.push_back(token);
+		return true;
+	}
+};
+
+/// Everything observable about reading one document
+struct ReadResult
+{
+	std::vector<std::string> tokens;
+	bool isError = false;
+	std::string errorMessage;
+	int errorOffset = -1;
+};
+
+/* Feeds the data to a reader in chunks of pseudo-random sizes between 1 and maxChunkSize, derived from seed. A
+ * maxChunkSize of 0 passes everything in one go. Reader is anything with the interface of Json::SaxReader.
+ */
+template <typename Reader>
+ReadResult read(const char *data, const std::size_t size, const uint32_t seed = 0, const std::size_t maxChunkSize = 0)
+{
+	TokenRecorder recorder;
+	Reader reader(&recorder);
+	uint32_t state = seed | 1;
+	std::size_t offset = 0;
+	while (offset < size) {
+		std::size_t chunkSize = size - offset;
+		if (maxChunkSize > 0) {
+			// xorshift32, good enough to get varying chunk boundaries
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			chunkSize = std::min(chunkSize, 1 + state % maxChunkSize);
+		}
+		reader.addData(data + offset, chunkSize);
+		offset += chunkSize;
+	}
+	reader.end();
+
+	ReadResult result;
+	result.tokens = std::move(recorder.tokens);
+	result.isError = reader.isError();
+	if (result.isError) {
+		result.errorMessage = reader.errorMessage();
+		result.errorOffset = reader.errorOffset();
+	}
+	return result;
+}
+
+/// Aborts with a description of the first difference if the two results do not match token by token
+inline void checkSameResult(const ReadResult &expected, const ReadResult &actual, const std::string &what)
+{
+	const std::size_t common = std::min(expected.tokens.size(), actual.tokens.size());
+	for (std::size_t i = 0; i < common; ++i) {
+		FUZZ_CHECK(expected.tokens[i] == actual.tokens[i],
+				   what + ": token " + std::to_string(i) + " is '" + actual.tokens[i] + "', expected '" + expected.tokens[i] + "'");
+	}
+	FUZZ_CHECK(expected.tokens.size() == actual.tokens.size(),
+			   what + ": got " + std::to_string(actual.tokens.size()) + " tokens, expected " + std::to_string(expected.tokens.size()));
+	FUZZ_CHECK(expected.isError == actual.isError, what + ": error '" + actual.errorMessage + "', expected '" + expected.errorMessage + "'");
+	FUZZ_CHECK(expected.errorMessage == actual.errorMessage, what + ": error '" + actual.errorMessage + "', expected '" + expected.errorMessage + "'");
+	FUZZ_CHECK(expected.errorOffset == actual.errorOffset,
+			   what + ": error at " + std::to_string(actual.errorOffset) + ", expected " + std::to_string(expected.errorOffset));
+}
+}
+}
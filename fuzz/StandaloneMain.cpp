@@ -0,0 +1,32 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+
+#include "util/FSUtil.h"
+#include "FuzzHelpers.h"
+
+// Runs a fuzz target over the files given on the command line, for builds without libFuzzer (see ARGONAUTS_FUZZING)
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string data = Argonauts::Util::FS::readFile(argv[i]);
+		std::cout << "Running " << argv[i] << " (" << data.size() << " bytes)" << std::endl;
+		LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+	}
+	return 0;
+}
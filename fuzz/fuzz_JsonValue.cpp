@@ -0,0 +1,57 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <memory>
+
+#include "util/json/JsonSaxReader.h"
+#include "util/json/JsonSaxWriter.h"
+#include "util/json/JsonValue.h"
+#include "FuzzHelpers.h"
+
+using namespace Argonauts::Util;
+
+static bool parse(const std::string &data, Json::Value *value)
+{
+	std::unique_ptr<SaxSink> sink(Json::Value::parserSink(value));
+	Json::SaxReader reader(sink.get());
+	reader.addData(data);
+	reader.end();
+	return !reader.isError();
+}
+static std::string write(const Json::Value &value)
+{
+	StringOutputStream stream;
+	Json::SaxWriter writer(&stream);
+	FUZZ_CHECK(value.serialize(&writer), writer.error());
+	return stream.result();
+}
+
+// Anything that can be read into a Json::Value has to survive writing it out and reading it back in
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+	Json::Value value;
+	if (!parse(std::string(reinterpret_cast<const char *>(data), size), &value)) {
+		return 0;
+	}
+
+	const std::string written = write(value);
+	Json::Value reread;
+	FUZZ_CHECK(parse(written, &reread), "could not read back " + written);
+	FUZZ_CHECK(value == reread, "value changed when reading back " + written);
+	FUZZ_CHECK(write(reread) == written, "output changed when writing " + written + " again");
+	return 0;
+}
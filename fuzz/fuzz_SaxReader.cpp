@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "util/json/JsonSaxReader.h"
+#include "FuzzHelpers.h"
+
+using namespace Argonauts;
+
+/* Reads the input in one go and in randomly split chunks, everything observable has to be the same. The first four
+ * bytes of the input seed the chunk boundaries.
+ *
+ * This is also the differential harness for alternative readers: read<OtherReader>(...) has to match read<SaxReader>(...)
+ * token by token, for the whole input as well as when split into chunks.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+	if (size < 4) {
+		return 0;
+	}
+	const uint32_t seed = uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+	const char *json = reinterpret_cast<const char *>(data + 4);
+	const std::size_t jsonSize = size - 4;
+
+	const Fuzz::ReadResult reference = Fuzz::read<Util::Json::SaxReader>(json, jsonSize);
+	Fuzz::checkSameResult(reference, Fuzz::read<Util::Json::SaxReader>(json, jsonSize, seed, 1), "byte by byte");
+	Fuzz::checkSameResult(reference, Fuzz::read<Util::Json::SaxReader>(json, jsonSize, seed, 7), "small chunks");
+	Fuzz::checkSameResult(reference, Fuzz::read<Util::Json::SaxReader>(json, jsonSize, seed, 256), "large chunks");
+	return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include "grammar/Site.arg.h"
+#include "dynamic/DynamicMessage.h"
+#include "util/FSUtil.h"
+#include "util/json/JsonSaxReader.h"
+#include "util/json/JsonSaxWriter.h"
+#include "util/json/JsonValue.h"
+#include "FuzzHelpers.h"
+
+using namespace Argonauts;
+
+// parses an array of sites, as that is something generated code can be the root of
+static bool parse(const std::string &data, std::vector<Site> *sites, const Runtime::FieldMask &mask = Runtime::FieldMask())
+{
+	Runtime::ArrayStreamSink<Site> sink([sites](Site &&site) { sites->push_back(std::move(site)); return true; }, mask);
+	Util::Json::SaxReader reader(&sink);
+	reader.addData(data);
+	reader.end();
+	return !reader.isError();
+}
+template <typename T>
+static std::string write(const std::vector<T> &values)
+{
+	Util::StringOutputStream stream;
+	Util::Json::SaxWriter writer(&stream);
+	Runtime::SaxSinkSerializer serializer(&writer);
+	static_cast<Runtime::Serializer &>(serializer).emitValue(values);
+	FUZZ_CHECK(!serializer.hasFailed(), writer.error());
+	return stream.result();
+}
+// maps are unordered, so two writes of the same data only have to be equal as JSON
+static Util::Json::Value toJson(const std::string &data)
+{
+	Util::Json::Value value;
+	std::unique_ptr<Util::SaxSink> sink(Util::Json::Value::parserSink(&value));
+	Util::Json::SaxReader reader(sink.get());
+	reader.addData(data);
+	reader.end();
+	FUZZ_CHECK(!reader.isError(), "generated code wrote invalid JSON " + data);
+	return value;
+}
+
+static std::vector<User> rowsOf(const UserColumns &columns)
+{
+	std::vector<User> users;
+	for (std::size_t row = 0; row < columns.size(); ++row) {
+		users.push_back(columns.at(row));
+	}
+	return users;
+}
+// users can also be stored column by column, both appending and parsing into the columns have to keep them intact
+static void checkColumns(const std::vector<Site> &sites)
+{
+	std::vector<User> users;
+	UserColumns appended;
+	for (const Site &site : sites) {
+		for (const User &user : site.users()) {
+			users.push_back(user);
+			appended.append(user);
+		}
+	}
+	const std::string written = write(users);
+	FUZZ_CHECK(toJson(write(rowsOf(appended))) == toJson(written), "appending to columns changed " + written);
+
+	UserColumns parsed;
+	std::unique_ptr<Util::SaxSink> sink(UserColumns::parserSink(&parsed));
+	Util::Json::SaxReader reader(sink.get());
+	reader.addData(written);
+	reader.end();
+	FUZZ_CHECK(!reader.isError(), "could not read back into columns " + written);
+	FUZZ_CHECK(toJson(write(rowsOf(parsed))) == toJson(written), "parsing into columns changed " + written);
+}
+
+// parsing only some fields of valid JSON has to give the same values for them as parsing everything. the reader is more
+// lenient about malformed input than the scanner skipping values, so this is checked on what was written
+static void checkProjection(const std::string &data, const std::vector<Site> &sites)
+{
+	std::vector<Site> projected;
+	FUZZ_CHECK(parse(data, &projected, Runtime::FieldMask({"name", "users.name", "owner.title"})), "could not parse the projection of " + data);
+	FUZZ_CHECK(projected.size() == sites.size(), "projection changed the number of sites in " + data);
+	for (std::size_t i = 0; i < sites.size(); ++i) {
+		const Site &site = projected.at(i);
+		FUZZ_CHECK(site.name() == sites.at(i).name() && !site.has_url(), "projection changed the name of " + data);
+		const std::vector<User> users = site.users();
+		const std::vector<User> expectedUsers = sites.at(i).users();
+		FUZZ_CHECK(users.size() == expectedUsers.size(), "projection changed the number of users in " + data);
+		for (std::size_t j = 0; j < users.size(); ++j) {
+			FUZZ_CHECK(users.at(j).name() == expectedUsers.at(j).name() && !users.at(j).has_email(), "projection changed a user of " + data);
+		}
+		if (sites.at(i).owner().is<Organization>()) {
+			FUZZ_CHECK(site.owner().get<Organization>().title() == sites.at(i).owner().get<Organization>().title(), "projection changed the owner of " + data);
+		}
+	}
+}
+
+// the same schema loaded at runtime has to accept what generated code wrote and write it back the same way
+static void checkDynamic(const std::string &written)
+{
+	static const std::shared_ptr<const Dynamic::Schema> schema = Dynamic::Schema::load(
+				Util::FS::readFile(ARGONAUTS_FUZZ_GRAMMAR) + "\nstruct Sites { sites List<Site> = 0; }", ARGONAUTS_FUZZ_GRAMMAR);
+	const std::string data = "{\"sites\":" + written + "}";
+	Dynamic::DynamicMessage sites(schema, "Sites");
+	std::unique_ptr<Util::SaxSink> sink(Dynamic::DynamicMessage::parserSink(&sites));
+	Util::Json::SaxReader reader(sink.get());
+	reader.addData(data);
+	reader.end();
+	FUZZ_CHECK(!reader.isError(), "dynamic message could not read " + data);
+
+	Util::StringOutputStream stream;
+	Util::Json::SaxWriter writer(&stream);
+	Runtime::SaxSinkSerializer serializer(&writer);
+	sites.serialize(&serializer);
+	FUZZ_CHECK(toJson(stream.result()) == toJson(data), "dynamic message changed " + data);
+}
+
+// The generated parser must not crash on any input, and whatever it accepts has to survive being written and read back
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, std::size_t size)
+{
+	std::vector<Site> sites;
+	if (!parse(std::string(reinterpret_cast<const char *>(data), size), &sites)) {
+		return 0;
+	}
+
+	const std::string written = write(sites);
+	std::vector<Site> reread;
+	FUZZ_CHECK(parse(written, &reread), "could not read back " + written);
+	FUZZ_CHECK(toJson(write(reread)) == toJson(written), "output changed when writing " + written + " again");
+	checkColumns(sites);
+	checkProjection(written, sites);
+	checkDynamic(written);
+	return 0;
+}
@@ -0,0 +1,714 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/CmdParser.h"
+#include "util/Error.h"
+#include "util/TermUtil.h"
+#include "util/FSUtil.h"
+#include "util/StringUtil.h"
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cctype>
+#include <boost/filesystem.hpp>
+
+using namespace Argonauts::Util;
+
+/* This tool turns a grammar description into LALR(1) parse tables, to be driven by Common::TableParser.
+ *
+ * The input consists of directives, one per line, followed by the rules:
+ * * %namespace A::B             namespace of the generated class
+ * * %include "file.h"           added as an #include to the generated source, should declare the token type
+ * * %prefix Token::             prepended to terminal names to get the token type enumerators
+ * * %token A B C                declares terminals, may be repeated
+ * * %ignore A B                 terminals that the driver should silently skip (comments etc.)
+ * * %start rule                 the start rule. it has to end with an explicit terminal (like EndOfFile)
+ *
+ * Rules are written as `name : symbol symbol {Action} | %empty ;`. Every alternative can be tagged with an action
+ * name, which ends up in the generated `Action` enum and is what the handler sees when the alternative is reduced.
+ * Untagged alternatives are reduced with action `None`. `//` starts a comment.
+ *
+ * States that only reduce a single rule get a default reduction, which the driver performs right after the shift
+ * instead of waiting for the next token. Identical rows of the action and goto tables are only emitted once.
+ */
+namespace {
+std::vector<std::string> splitWords(const std::string &string)
+{
+	std::vector<std::string> out;
+	std::string current;
+	for (const char c : string) {
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			if (!current.empty()) {
+				out.push_back(current);
+			}
+			current.clear();
+		} else {
+			current += c;
+		}
+	}
+	if (!current.empty()) {
+		out.push_back(current);
+	}
+	return out;
+}
+
+struct Rule
+{
+	int lhs;
+	std::vector<int> rhs;
+	std::string action;
+	std::size_t offset;
+};
+
+struct Grammar
+{
+	std::string ns, prefix;
+	std::vector<std::string> includes;
+	std::vector<std::string> terminals; // the last one is always the internal end marker
+	std::vector<std::string> nonterminals;
+	std::set<int> ignored;
+	std::vector<Rule> rules; // rules[0] is the augmented $accept: <start>
+	std::vector<std::string> actions; // actions[0] is None
+
+	int numTerminals() const { return int(terminals.size()); }
+	bool isTerminal(const int symbol) const { return symbol < numTerminals(); }
+	int endTerminal() const { return numTerminals() - 1; }
+	std::string nameOf(const int symbol) const { return isTerminal(symbol) ? terminals.at(symbol) : nonterminals.at(symbol - numTerminals()); }
+};
+
+class GrammarReader
+{
+public:
+	explicit GrammarReader(const std::string &data, const std::string &filename)
+		: m_data(data), m_filename(filename) {}
+
+	Grammar read()
+	{
+		std::map<std::string, std::size_t> ruleNames; // nonterminal name -> first use
+		std::string start;
+		std::size_t startOffset = 0;
+
+		struct RawRule
+		{
+			std::string lhs;
+			std::vector<std::pair<std::string, std::size_t>> rhs;
+			std::string action;
+			std::size_t offset;
+		};
+		std::vector<RawRule> rawRules;
+
+		skipSpace();
+		while (m_index < m_data.size()) {
+			if (m_data.at(m_index) == '%') {
+				const std::size_t directiveOffset = m_index;
+				const std::string directive = word();
+				const std::vector<std::string> arguments = splitWords(restOfLine());
+				if (directive == "%namespace" && arguments.size() == 1) {
+					m_grammar.ns = arguments.front();
+				} else if (directive == "%prefix" && arguments.size() == 1) {
+					m_grammar.prefix = arguments.front();
+				} else if (directive == "%include" && arguments.size() == 1) {
+					m_grammar.includes.push_back(arguments.front());
+				} else if (directive == "%start" && arguments.size() == 1) {
+					start = arguments.front();
+					startOffset = directiveOffset;
+				} else if (directive == "%token") {
+					for (const std::string &terminal : arguments) {
+						if (std::find(m_grammar.terminals.begin(), m_grammar.terminals.end(), terminal) != m_grammar.terminals.end()) {
+							throw error("Terminal declared twice: " + terminal, directiveOffset);
+						}
+						m_grammar.terminals.push_back(terminal);
+					}
+				} else if (directive == "%ignore") {
+					for (const std::string &terminal : arguments) {
+						m_ignored.push_back(std::make_pair(terminal, directiveOffset));
+					}
+				} else {
+					throw error("Unknown or malformed directive " + directive, directiveOffset);
+				}
+			} else {
+				const std::size_t ruleOffset = m_index;
+				const std::string lhs = word();
+				skipSpace();
+				expect(':');
+				ruleNames.insert({lhs, ruleOffset});
+				RawRule current{lhs, {}, std::string(), ruleOffset};
+				while (true) {
+					skipSpace();
+					if (m_index >= m_data.size()) {
+						throw error("Unterminated rule " + lhs, ruleOffset);
+					}
+					const char c = m_data.at(m_index);
+					if (c == '|' || c == ';') {
+						++m_index;
+						rawRules.push_back(current);
+						current = RawRule{lhs, {}, std::string(), m_index};
+						if (c == ';') {
+							break;
+						}
+					} else if (c == '{') {
+						const std::size_t end = m_data.find('}', m_index);
+						if (end == std::string::npos) {
+							throw error("Unterminated action", m_index);
+						}
+						const std::vector<std::string> action = splitWords(m_data.substr(m_index + 1, end - m_index - 1));
+						if (action.size() != 1) {
+							throw error("Expected exactly one action name", m_index);
+						}
+						current.action = action.front();
+						m_index = end + 1;
+					} else {
+						const std::size_t offset = m_index;
+						const std::string symbol = word();
+						if (symbol != "%empty") {
+							current.rhs.push_back(std::make_pair(symbol, offset));
+						}
+					}
+				}
+			}
+			skipSpace();
+		}
+
+		if (m_grammar.terminals.empty()) {
+			throw error("No terminals declared", 0);
+		}
+		if (start.empty()) {
+			throw error("No start rule declared", 0);
+		}
+		if (ruleNames.find(start) == ruleNames.end()) {
+			throw error("Unknown start rule " + start, startOffset);
+		}
+		m_grammar.terminals.push_back("$end");
+		for (const auto &ignored : m_ignored) {
+			m_grammar.ignored.insert(symbolFor(ignored.first, ignored.second));
+		}
+
+		m_grammar.nonterminals.push_back("$accept");
+		for (const RawRule &raw : rawRules) {
+			if (std::find(m_grammar.nonterminals.begin(), m_grammar.nonterminals.end(), raw.lhs) == m_grammar.nonterminals.end()) {
+				m_grammar.nonterminals.push_back(raw.lhs);
+			}
+		}
+		for (const auto &pair : ruleNames) {
+			if (std::find(m_grammar.terminals.begin(), m_grammar.terminals.end(), pair.first) != m_grammar.terminals.end()) {
+				throw error("Rule has the same name as a terminal: " + pair.first, pair.second);
+			}
+		}
+
+		m_grammar.actions.push_back("None");
+		m_grammar.rules.push_back(Rule{m_grammar.numTerminals(), {symbolFor(start, startOffset)}, std::string(), startOffset});
+		for (const RawRule &raw : rawRules) {
+			Rule rule{symbolFor(raw.lhs, raw.offset), {}, raw.action, raw.offset};
+			for (const auto &symbol : raw.rhs) {
+				rule.rhs.push_back(symbolFor(symbol.first, symbol.second));
+			}
+			if (!rule.action.empty() && std::find(m_grammar.actions.begin(), m_grammar.actions.end(), rule.action) == m_grammar.actions.end()) {
+				m_grammar.actions.push_back(rule.action);
+			}
+			m_grammar.rules.push_back(rule);
+		}
+		return m_grammar;
+	}
+
+private:
+	const std::string m_data;
+	const std::string m_filename;
+	std::size_t m_index = 0;
+	Grammar m_grammar;
+	std::vector<std::pair<std::string, std::size_t>> m_ignored;
+
+	Error error(const std::string &message, const std::size_t offset) const
+	{
+		return Error(message, int(offset), Error::Source(m_data, m_filename));
+	}
+
+	int symbolFor(const std::string &name, const std::size_t offset) const
+	{
+		auto terminal = std::find(m_grammar.terminals.begin(), m_grammar.terminals.end(), name);
+		if (terminal != m_grammar.terminals.end()) {
+			return int(terminal - m_grammar.terminals.begin());
+		}
+		auto nonterminal = std::find(m_grammar.nonterminals.begin(), m_grammar.nonterminals.end(), name);
+		if (nonterminal != m_grammar.nonterminals.end()) {
+			return m_grammar.numTerminals() + int(nonterminal - m_grammar.nonterminals.begin());
+		}
+		throw error("Unknown symbol " + name, offset);
+	}
+
+	void skipSpace()
+	{
+		while (m_index < m_data.size()) {
+			const char c = m_data.at(m_index);
+			if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+				++m_index;
+			} else if (c == '/' && m_data.find("//", m_index) == m_index) {
+				m_index = std::min(m_data.size(), m_data.find('\n', m_index));
+			} else {
+				break;
+			}
+		}
+	}
+	std::string word()
+	{
+		const std::size_t start = m_index;
+		while (m_index < m_data.size() && (std::isalnum(static_cast<unsigned char>(m_data.at(m_index))) || m_data.at(m_index) == '_' || (m_index == start && m_data.at(m_index) == '%'))) {
+			++m_index;
+		}
+		if (m_index == start) {
+			throw error(m_index < m_data.size() ? std::string("Unexpected character '") + m_data.at(m_index) + "'" : std::string("Unexpected end of file"), m_index);
+		}
+		return m_data.substr(start, m_index - start);
+	}
+	std::string restOfLine()
+	{
+		const std::size_t end = std::min(m_data.size(), m_data.find('\n', m_index));
+		std::string line = m_data.substr(m_index, end - m_index);
+		const std::size_t comment = line.find("//");
+		if (comment != std::string::npos) {
+			line = line.substr(0, comment);
+		}
+		m_index = end;
+		return line;
+	}
+	void expect(const char c)
+	{
+		if (m_index >= m_data.size() || m_data.at(m_index) != c) {
+			throw error(std::string("Expected '") + c + "'", m_index);
+		}
+		++m_index;
+	}
+};
+
+class TableBuilder
+{
+public:
+	explicit TableBuilder(const Grammar &grammar, const std::string &data, const std::string &filename)
+		: m_grammar(grammar), m_data(data), m_filename(filename) {}
+
+	struct Item
+	{
+		int rule, dot;
+		bool operator<(const Item &other) const { return rule < other.rule || (rule == other.rule && dot < other.dot); }
+		bool operator==(const Item &other) const { return rule == other.rule && dot == other.dot; }
+	};
+	using Lookaheads = std::set<int>;
+	struct State
+	{
+		std::vector<Item> kernel;
+		std::map<Item, Lookaheads> lookaheads; // kernel items only
+		std::map<int, int> transitions; // symbol -> state
+	};
+
+	std::vector<State> states;
+	std::vector<std::vector<int>> actions; // [state][terminal]: 0 = error, > 0 = shift to state - 1, < 0 = reduce rule -action - 1
+	std::vector<std::vector<int>> gotos; // [state][nonterminal]: -1 = none
+	std::vector<int> defaultReductions; // [state]: rule, or -1
+	int acceptState = -1;
+
+	void build()
+	{
+		computeNullableAndFirst();
+		buildStates();
+		computeLookaheads();
+		buildTables();
+	}
+
+private:
+	const Grammar &m_grammar;
+	const std::string &m_data;
+	const std::string &m_filename;
+	std::vector<bool> m_nullable; // per nonterminal
+	std::vector<Lookaheads> m_first; // per nonterminal
+
+	int ruleSymbolAt(const Item &item) const
+	{
+		const Rule &rule = m_grammar.rules.at(item.rule);
+		return item.dot < int(rule.rhs.size()) ? rule.rhs.at(item.dot) : -1;
+	}
+
+	void computeNullableAndFirst()
+	{
+		const std::size_t count = m_grammar.nonterminals.size();
+		m_nullable.assign(count, false);
+		m_first.assign(count, Lookaheads());
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (const Rule &rule : m_grammar.rules) {
+				const int lhs = rule.lhs - m_grammar.numTerminals();
+				bool allNullable = true;
+				for (const int symbol : rule.rhs) {
+					const std::size_t before = m_first[lhs].size();
+					if (m_grammar.isTerminal(symbol)) {
+						m_first[lhs].insert(symbol);
+					} else {
+						const Lookaheads &first = m_first[symbol - m_grammar.numTerminals()];
+						m_first[lhs].insert(first.begin(), first.end());
+					}
+					changed |= before != m_first[lhs].size();
+					if (m_grammar.isTerminal(symbol) || !m_nullable[symbol - m_grammar.numTerminals()]) {
+						allNullable = false;
+						break;
+					}
+				}
+				if (allNullable && !m_nullable[lhs]) {
+					m_nullable[lhs] = true;
+					changed = true;
+				}
+			}
+		}
+	}
+	// FIRST of rhs[from...], and whether all of it is nullable
+	bool firstOfSequence(const std::vector<int> &rhs, const std::size_t from, Lookaheads &out) const
+	{
+		for (std::size_t i = from; i < rhs.size(); ++i) {
+			const int symbol = rhs.at(i);
+			if (m_grammar.isTerminal(symbol)) {
+				out.insert(symbol);
+				return false;
+			}
+			const Lookaheads &first = m_first[symbol - m_grammar.numTerminals()];
+			out.insert(first.begin(), first.end());
+			if (!m_nullable[symbol - m_grammar.numTerminals()]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::vector<Item> closure(const std::vector<Item> &kernel) const
+	{
+		std::vector<Item> items = kernel;
+		std::set<int> expanded;
+		for (std::size_t i = 0; i < items.size(); ++i) {
+			const int symbol = ruleSymbolAt(items.at(i));
+			if (symbol < 0 || m_grammar.isTerminal(symbol) || !expanded.insert(symbol).second) {
+				continue;
+			}
+			for (std::size_t r = 0; r < m_grammar.rules.size(); ++r) {
+				if (m_grammar.rules.at(r).lhs == symbol) {
+					items.push_back(Item{int(r), 0});
+				}
+			}
+		}
+		return items;
+	}
+
+	void buildStates()
+	{
+		std::map<std::vector<Item>, int> known;
+		states.push_back(State{{Item{0, 0}}, {}, {}});
+		known.insert({states.front().kernel, 0});
+		for (std::size_t s = 0; s < states.size(); ++s) {
+			std::map<int, std::vector<Item>> next;
+			for (const Item &item : closure(states.at(s).kernel)) {
+				const int symbol = ruleSymbolAt(item);
+				if (symbol >= 0) {
+					next[symbol].push_back(Item{item.rule, item.dot + 1});
+				}
+			}
+			for (auto &pair : next) {
+				std::sort(pair.second.begin(), pair.second.end());
+				pair.second.erase(std::unique(pair.second.begin(), pair.second.end()), pair.second.end());
+				auto it = known.find(pair.second);
+				if (it == known.end()) {
+					it = known.insert({pair.second, int(states.size())}).first;
+					states.push_back(State{pair.second, {}, {}});
+				}
+				states.at(s).transitions[pair.first] = it->second;
+			}
+		}
+	}
+
+	// LALR(1) lookaheads, computed by propagating them through the LR(0) automaton until nothing changes anymore
+	std::map<Item, Lookaheads> closureLookaheads(const State &state) const
+	{
+		std::map<Item, Lookaheads> result = state.lookaheads;
+		for (const Item &item : state.kernel) {
+			result[item];
+		}
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (const auto &pair : std::map<Item, Lookaheads>(result)) {
+				const int symbol = ruleSymbolAt(pair.first);
+				if (symbol < 0 || m_grammar.isTerminal(symbol)) {
+					continue;
+				}
+				Lookaheads follow;
+				if (firstOfSequence(m_grammar.rules.at(pair.first.rule).rhs, std::size_t(pair.first.dot + 1), follow)) {
+					follow.insert(pair.second.begin(), pair.second.end());
+				}
+				for (std::size_t r = 0; r < m_grammar.rules.size(); ++r) {
+					if (m_grammar.rules.at(r).lhs == symbol) {
+						Lookaheads &target = result[Item{int(r), 0}];
+						const std::size_t before = target.size();
+						target.insert(follow.begin(), follow.end());
+						changed |= before != target.size();
+					}
+				}
+			}
+		}
+		return result;
+	}
+	void computeLookaheads()
+	{
+		states.front().lookaheads[Item{0, 0}].insert(m_grammar.endTerminal());
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (State &state : states) {
+				for (const auto &pair : closureLookaheads(state)) {
+					const int symbol = ruleSymbolAt(pair.first);
+					if (symbol < 0) {
+						continue;
+					}
+					Lookaheads &target = states.at(state.transitions.at(symbol)).lookaheads[Item{pair.first.rule, pair.first.dot + 1}];
+					const std::size_t before = target.size();
+					target.insert(pair.second.begin(), pair.second.end());
+					changed |= before != target.size();
+				}
+			}
+		}
+	}
+
+	void buildTables()
+	{
+		std::vector<std::string> conflicts;
+		for (std::size_t s = 0; s < states.size(); ++s) {
+			const State &state = states.at(s);
+			std::vector<int> actionRow(std::size_t(m_grammar.numTerminals()), 0);
+			std::vector<int> gotoRow(m_grammar.nonterminals.size(), -1);
+			for (const auto &transition : state.transitions) {
+				if (m_grammar.isTerminal(transition.first)) {
+					actionRow.at(std::size_t(transition.first)) = transition.second + 1;
+				} else {
+					gotoRow.at(std::size_t(transition.first - m_grammar.numTerminals())) = transition.second;
+				}
+			}
+
+			std::set<int> reducedRules;
+			bool haveShift = !state.transitions.empty() && std::any_of(state.transitions.begin(), state.transitions.end(),
+																	   [this](const std::pair<const int, int> &pair) { return m_grammar.isTerminal(pair.first); });
+			for (const auto &pair : closureLookaheads(state)) {
+				if (ruleSymbolAt(pair.first) >= 0) {
+					continue;
+				}
+				if (pair.first.rule == 0) {
+					acceptState = int(s);
+					continue;
+				}
+				reducedRules.insert(pair.first.rule);
+				for (const int terminal : pair.second) {
+					int &cell = actionRow.at(std::size_t(terminal));
+					if (cell > 0) {
+						conflicts.push_back("shift/reduce conflict on " + m_grammar.nameOf(terminal) + " when reducing " + describe(pair.first.rule));
+					} else if (cell < 0) {
+						conflicts.push_back("reduce/reduce conflict on " + m_grammar.nameOf(terminal) + " between " + describe(-cell - 1) + " and " + describe(pair.first.rule));
+					} else {
+						cell = -(pair.first.rule + 1);
+					}
+				}
+			}
+			defaultReductions.push_back(!haveShift && reducedRules.size() == 1 ? *reducedRules.begin() : -1);
+			actions.push_back(actionRow);
+			gotos.push_back(gotoRow);
+		}
+		if (!conflicts.empty()) {
+			throw Exception("The grammar is not LALR(1):\n\t" + String::joinStrings(conflicts, "\n\t"));
+		}
+		if (acceptState < 0) {
+			throw Exception("The start rule can never be accepted");
+		}
+	}
+
+	std::string describe(const int rule) const
+	{
+		const Rule &r = m_grammar.rules.at(std::size_t(rule));
+		std::string out = m_grammar.nameOf(r.lhs) + " :";
+		for (const int symbol : r.rhs) {
+			out += ' ' + m_grammar.nameOf(symbol);
+		}
+		const std::string before = m_data.substr(0, r.offset);
+		return out + " (" + m_filename + ":" + std::to_string(std::count(before.begin(), before.end(), '\n') + 1) + ")";
+	}
+};
+
+// dedupes rows, returns the flattened unique rows and an index of the first entry of each row
+template <typename T>
+std::pair<std::vector<T>, std::vector<int>> compressRows(const std::vector<std::vector<T>> &rows)
+{
+	std::map<std::vector<T>, int> offsets;
+	std::vector<T> flat;
+	std::vector<int> index;
+	for (const std::vector<T> &row : rows) {
+		auto it = offsets.find(row);
+		if (it == offsets.end()) {
+			it = offsets.insert({row, int(flat.size())}).first;
+			std::copy(row.begin(), row.end(), std::back_inserter(flat));
+		}
+		index.push_back(it->second);
+	}
+	return {flat, index};
+}
+template <typename T>
+std::string joined(const std::vector<T> &values)
+{
+	std::string out;
+	for (std::size_t i = 0; i < values.size(); ++i) {
+		out += (i % 20 == 0 ? "\n\t" : " ") + std::to_string(values.at(i)) + ',';
+	}
+	return out;
+}
+}
+
+std::pair<std::string, std::string> processGrammar(const std::string &filename, const std::string &data)
+{
+	const Grammar grammar = GrammarReader(data, filename).read();
+	TableBuilder builder(grammar, data, filename);
+	builder.build();
+
+	const std::string name = boost::filesystem::path(filename).stem().string() + "Grammar";
+	const std::vector<std::string> namespaces = String::splitStrings(grammar.ns, "::");
+
+	std::string header, source;
+	header += std::string("// Generated by parsergenerator from ") + boost::filesystem::path(filename).filename().string() + ", do not edit\n"
+			+ "#pragma once\n"
+			+ "\n"
+			+ "#include \"common/TableParser.h\"\n"
+			+ "\n";
+	for (const std::string &ns : namespaces) {
+		header += "namespace " + ns + " {\n";
+	}
+	header += "class " + name + "\n"
+			+ "{\n"
+			+ "public:\n"
+			+ "\tenum Action\n"
+			+ "\t{\n";
+	for (std::size_t i = 0; i < grammar.actions.size(); ++i) {
+		header += "\t\t" + grammar.actions.at(i) + (i == 0 ? " = 0" : "") + (i + 1 < grammar.actions.size() ? ",\n" : "\n");
+	}
+	header += std::string("\t};\n")
+			+ "\n"
+			+ "\tstatic const Argonauts::Common::TableParser::Tables &tables();\n"
+			+ "};\n";
+	for (std::size_t i = 0; i < namespaces.size(); ++i) {
+		header += "}\n";
+	}
+
+	const auto actions = compressRows(builder.actions);
+	const auto gotos = compressRows(builder.gotos);
+	std::vector<int> ruleLengths, ruleLhs, ruleActions;
+	for (const Rule &rule : grammar.rules) {
+		ruleLengths.push_back(int(rule.rhs.size()));
+		ruleLhs.push_back(rule.lhs - grammar.numTerminals());
+		ruleActions.push_back(int(std::find(grammar.actions.begin(), grammar.actions.end(), rule.action.empty() ? "None" : rule.action) - grammar.actions.begin()));
+	}
+
+	source += std::string("// Generated by parsergenerator from ") + boost::filesystem::path(filename).filename().string() + ", do not edit\n"
+			+ "#include \"" + boost::filesystem::path(filename).filename().string() + ".h\"\n"
+			+ "\n"
+			+ "#include <cstdint>\n";
+	for (const std::string &include : grammar.includes) {
+		source += "#include " + include + "\n";
+	}
+	source += "\n";
+	for (const std::string &ns : namespaces) {
+		source += "namespace " + ns + " {\n";
+	}
+	source += std::string("// ") + std::to_string(builder.states.size()) + " states, " + std::to_string(grammar.numTerminals()) + " terminals, "
+			+ std::to_string(grammar.nonterminals.size()) + " nonterminals, " + std::to_string(grammar.rules.size()) + " rules\n"
+			+ "static const int16_t actionRows[] = {" + joined(actions.first) + "\n};\n"
+			+ "static const uint16_t actionRowIndex[] = {" + joined(actions.second) + "\n};\n"
+			+ "static const int16_t gotoRows[] = {" + joined(gotos.first) + "\n};\n"
+			+ "static const uint16_t gotoRowIndex[] = {" + joined(gotos.second) + "\n};\n"
+			+ "static const int16_t defaultReductions[] = {" + joined(builder.defaultReductions) + "\n};\n"
+			+ "static const uint8_t ruleLengths[] = {" + joined(ruleLengths) + "\n};\n"
+			+ "static const uint16_t ruleLhs[] = {" + joined(ruleLhs) + "\n};\n"
+			+ "static const uint16_t ruleActions[] = {" + joined(ruleActions) + "\n};\n"
+			+ "\n"
+			+ "static int terminalFor(const int tokenType)\n"
+			+ "{\n"
+			+ "\tswitch (tokenType) {\n";
+	for (int terminal = 0; terminal < grammar.endTerminal(); ++terminal) {
+		source += "\tcase " + grammar.prefix + grammar.terminals.at(std::size_t(terminal)) + ": return "
+				+ (grammar.ignored.count(terminal) ? std::string("Argonauts::Common::TableParser::Ignored") : std::to_string(terminal)) + ";\n";
+	}
+	source += std::string("\tdefault: return Argonauts::Common::TableParser::Unknown;\n")
+			+ "\t}\n"
+			+ "}\n"
+			+ "\n"
+			+ "const Argonauts::Common::TableParser::Tables &" + name + "::tables()\n"
+			+ "{\n"
+			+ "\tstatic const Argonauts::Common::TableParser::Tables tables = {\n"
+			+ "\t\t" + std::to_string(grammar.numTerminals()) + ", " + std::to_string(grammar.nonterminals.size()) + ", " + std::to_string(builder.acceptState) + ",\n"
+			+ "\t\tactionRows, actionRowIndex, gotoRows, gotoRowIndex, defaultReductions,\n"
+			+ "\t\truleLengths, ruleLhs, ruleActions,\n"
+			+ "\t\t&terminalFor\n"
+			+ "\t};\n"
+			+ "\treturn tables;\n"
+			+ "}\n";
+	for (std::size_t i = 0; i < namespaces.size(); ++i) {
+		source += "}\n";
+	}
+	return {header, source};
+}
+
+int main(int argc, const char **argv)
+{
+	CLI::ParserBuilder::Ptr builder = std::make_shared<CLI::ParserBuilder>("parsergenerator", "1.0", "This tool transforms grammar descriptions (.grammar files) into LALR(1) parse tables");
+	builder->addOption({"output", "o"}, "The directory to where to output the resulting files")->withRequiredArg("DIR")->beingRequired();
+	builder->withPositionalArgument("INPUT", "List of input files", CLI::Subcommand::Repeatable);
+	builder->then([](const CLI::Parser &parser)
+	{
+		const boost::filesystem::path outdir = boost::filesystem::path(parser.option<std::string>("output"));
+		if (!boost::filesystem::exists(outdir)) {
+			if (!boost::filesystem::create_directories(outdir)) {
+				throw Exception("Unable to create output directory");
+			}
+		} else if (!boost::filesystem::is_directory(outdir)) {
+			throw Exception("Output directory already exists but is not a directory");
+		}
+		for (const std::string &infile : parser.positionalArguments("INPUT")) {
+			if (!boost::filesystem::exists(infile)) {
+				throw Exception(std::string("No such input file: ") + infile);
+			} else if (!boost::filesystem::is_regular_file(infile)) {
+				throw Exception(std::string("Given file is not a regular file: ") + infile);
+			}
+			const boost::filesystem::path filename = boost::filesystem::path(infile).filename();
+			const std::string contents = FS::readFile(infile);
+			const std::pair<std::string, std::string> outdata = processGrammar(infile, contents);
+			FS::writeFile((outdir / filename).string() + ".h", outdata.first);
+			FS::writeFile((outdir / filename).string() + ".cpp", outdata.second);
+		}
+		return CLI::Execution::ExitSuccess;
+	});
+	builder->addVersionOption();
+	builder->addHelpOption();
+	builder->addListCommand();
+	builder->addHelpCommand();
+	try {
+		return builder->build().parse(argc, argv);
+	} catch (Error &e) {
+		std::cerr << Term::fg(Term::Red, e.errorMessage()) << std::endl;
+		return -1;
+	} catch (Exception &e) {
+		std::cerr << Term::fg(Term::Red, e.what()) << std::endl;
+		return -1;
+	}
+}
@@ -19,8 +19,13 @@
 #include <stdexcept>
 #include <vector>
 
+#include "ColdStorage.h"
+#include "Columns.h"
+#include "FieldMask.h"
 #include "Parser.h"
+#include "PresenceMask.h"
 #include "Serializer.h"
+#include "Streaming.h"
 
 namespace Argonauts
 {
@@ -22,6 +22,9 @@ if(NOT TARGET argonauts)
 endif()
 
 include(CMakeParseArguments)
+# Generates C++ code for INFILES into OUTDIR and sets OUTVAR to the generated sources. If TARGET is given, the generation
+# runs as part of that target and targets compiling the sources have to depend on it. Otherwise it runs as part of every
+# target that compiles them, so only one target may do so. Types added to INFILES are picked up by re-running CMake
 function(process_argonauts_cpp)
 	cmake_parse_arguments(PAC "" "OUTVAR;TYPES;OUTDIR;TARGET" "INFILES" ${ARGN})
 	if(NOT PAC_TYPES)
@@ -29,26 +32,69 @@ function(process_argonauts_cpp)
 	endif()
 
 	set(finalResult )
+	set(stamps )
 	foreach(file ${PAC_INFILES})
-		file(STRINGS ${file} types REGEX "[\\w^]*(struct|enum) ([^ <]*)")
-		set(resultFiles )
-		foreach(type ${types})
-			string(REGEX REPLACE "[\\w^]*(struct|enum) ([^ <]*).*" "\\2" type ${type})
-			list(APPEND resultFiles ${PAC_OUTDIR}/${type}.arg.h ${PAC_OUTDIR}/${type}.arg.cpp)
-		endforeach()
+		get_filename_component(name ${file} NAME_WE)
+		set(manifest ${PAC_OUTDIR}/${name}.manifest.json)
+		set(stamp ${PAC_OUTDIR}/${name}.stamp)
 
-		add_custom_command(OUTPUT ${resultFiles} VERBATIM
-			COMMAND argonauts compile cpp --output ${PAC_OUTDIR} --types ${PAC_TYPES} ${file}
+		# the manifest written by the last run lists exactly what gets generated from the file. it can only be used if
+		# the file has not been changed since, otherwise (and before the first build) guess from the type definitions
+		set(resultFiles )
+		if(EXISTS ${manifest} AND EXISTS ${stamp} AND NOT ${file} IS_NEWER_THAN ${stamp} AND NOT CMAKE_VERSION VERSION_LESS 3.19)
+			file(READ ${manifest} manifestContents)
+			string(JSON numOutputs LENGTH ${manifestContents} outputs)
+			if(numOutputs GREATER 0)
+				math(EXPR lastOutput "${numOutputs} - 1")
+				foreach(index RANGE ${lastOutput})
+					string(JSON output GET ${manifestContents} outputs ${index})
+					list(APPEND resultFiles ${output})
+				endforeach()
+			endif()
+			# the generated source of a type is compiled again when a type it uses changes
+			string(JSON numTypes LENGTH ${manifestContents} types)
+			if(numTypes GREATER 0)
+				math(EXPR lastType "${numTypes} - 1")
+				foreach(index RANGE ${lastType})
+					string(JSON type MEMBER ${manifestContents} types ${index})
+					string(JSON source GET ${manifestContents} types ${type} outputs 1)
+					string(JSON numDependencies LENGTH ${manifestContents} types ${type} dependencies)
+					set(dependencyHeaders )
+					if(numDependencies GREATER 0)
+						math(EXPR lastDependency "${numDependencies} - 1")
+						foreach(dependencyIndex RANGE ${lastDependency})
+							string(JSON dependency GET ${manifestContents} types ${type} dependencies ${dependencyIndex})
+							list(APPEND dependencyHeaders ${PAC_OUTDIR}/${dependency}.arg.h)
+						endforeach()
+					endif()
+					set_source_files_properties(${source} PROPERTIES OBJECT_DEPENDS "${dependencyHeaders}")
+				endforeach()
+			endif()
+		else()
+			file(STRINGS ${file} types REGEX "[\\w^]*(struct|enum) ([^ <]*)")
+			foreach(type ${types})
+				string(REGEX REPLACE "[\\w^]*(struct|enum) ([^ <]*).*" "\\2" type ${type})
+				list(APPEND resultFiles ${PAC_OUTDIR}/${type}.arg.h ${PAC_OUTDIR}/${type}.arg.cpp)
+			endforeach()
+		endif()
+		# unchanged types are neither generated nor written again (see --incremental), so the generated files can be
+		# older than the inputs. the stamp is what marks the command as done, the generated files are only byproducts
+		add_custom_command(OUTPUT ${stamp} BYPRODUCTS ${resultFiles} ${manifest} VERBATIM
+			COMMAND argonauts compile cpp --output ${PAC_OUTDIR} --types ${PAC_TYPES} --incremental --manifest ${manifest} --stamp ${stamp} ${file}
 			COMMENT "Generating from argonauts grammar ${file}..."
-			MAIN_DEPENDENCY ${file}
-			DEPENDS argonauts
+			DEPENDS ${file} argonauts
 		)
 
 		list(APPEND finalResult ${resultFiles})
+		list(APPEND stamps ${stamp})
 	endforeach()
 
 	if(PAC_TARGET)
-		add_custom_target(${PAC_TARGET} DEPENDS ${finalResult})
+		# only this target runs the commands, if each target using the sources did so they would race each other
+		add_custom_target(${PAC_TARGET} DEPENDS ${stamps})
+	else()
+		# the stamps among the sources make the target compiling them run the commands
+		list(APPEND finalResult ${stamps})
 	endif()
 
 	set(${PAC_OUTVAR} ${finalResult} PARENT_SCOPE)
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+
+namespace Argonauts {
+namespace Runtime {
+/* Holds the rarely used (@cpp.cold) fields of a generated struct on the heap, so that they only take up the space of a
+ * pointer until one of them is set. Copies are deep, so the struct keeps its value semantics.
+ */
+template <typename Fields>
+class ColdStorage
+{
+	std::unique_ptr<Fields> m_fields;
+
+public:
+	ColdStorage() = default;
+	ColdStorage(const ColdStorage<Fields> &other) : m_fields(other.m_fields ? new Fields(*other.m_fields) : nullptr) {}
+	ColdStorage(ColdStorage<Fields> &&other) noexcept = default;
+	ColdStorage<Fields> &operator=(const ColdStorage<Fields> &other)
+	{
+		m_fields.reset(other.m_fields ? new Fields(*other.m_fields) : nullptr);
+		return *this;
+	}
+	ColdStorage<Fields> &operator=(ColdStorage<Fields> &&other) noexcept = default;
+
+	/// The fields, or default constructed ones if none has been set yet
+	const Fields &get() const
+	{
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+		static const Fields defaults{};
+#pragma clang diagnostic pop
+		return m_fields ? *m_fields : defaults;
+	}
+	/// The fields for writing, allocates them on first use
+	Fields &mutate()
+	{
+		if (!m_fields) {
+			m_fields.reset(new Fields());
+		}
+		return *m_fields;
+	}
+	bool isAllocated() const { return m_fields != nullptr; }
+};
+}
+}
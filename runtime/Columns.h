@@ -0,0 +1,243 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "util/SaxSink.h"
+#include "Parser.h"
+
+namespace Argonauts {
+namespace Runtime {
+/* Building blocks for the <Struct>Columns containers generated for structs annotated with @cpp.columns. Every field of
+ * the struct becomes one column with one entry per row: strings go into a StringColumn, lists into a ListColumn and
+ * everything else into a plain std::vector.
+ */
+
+/// All strings of a column in one contiguous buffer, plus the offset each one ends at
+class StringColumn
+{
+	std::string m_data;
+	std::vector<std::size_t> m_ends;
+
+public:
+	std::size_t size() const { return m_ends.size(); }
+	bool empty() const { return m_ends.empty(); }
+	void reserve(const std::size_t rows) { m_ends.reserve(rows); }
+	void clear() { m_data.clear(); m_ends.clear(); }
+
+	void push_back(const std::string &value)
+	{
+		m_data.append(value);
+		m_ends.push_back(m_data.size());
+	}
+
+	std::size_t begin(const std::size_t row) const { return row == 0 ? 0 : m_ends[row - 1]; }
+	std::size_t end(const std::size_t row) const { return m_ends[row]; }
+	std::size_t length(const std::size_t row) const { return end(row) - begin(row); }
+	const char *data(const std::size_t row) const { return m_data.data() + begin(row); }
+	std::string at(const std::size_t row) const { return m_data.substr(begin(row), length(row)); }
+
+	/// The characters of all rows, one after another
+	const std::string &buffer() const { return m_data; }
+};
+
+/// The elements of all lists of a column one after another in a nested column, plus the offset each list ends at
+template <typename Values>
+class ListColumn
+{
+	Values m_values;
+	std::vector<std::size_t> m_ends;
+
+public:
+	std::size_t size() const { return m_ends.size(); }
+	bool empty() const { return m_ends.empty(); }
+	void reserve(const std::size_t rows) { m_ends.reserve(rows); }
+	void clear() { m_values.clear(); m_ends.clear(); }
+
+	/// Ends the current row, all values added since the previous row end belong to it
+	void finishRow() { m_ends.push_back(m_values.size()); }
+
+	std::size_t begin(const std::size_t row) const { return row == 0 ? 0 : m_ends[row - 1]; }
+	std::size_t end(const std::size_t row) const { return m_ends[row]; }
+	std::size_t length(const std::size_t row) const { return end(row) - begin(row); }
+
+	Values &values() { return m_values; }
+	const Values &values() const { return m_values; }
+};
+
+// appending values to columns
+
+template <typename T, typename Value> void appendValue(std::vector<T> &column, const Value &value) { column.push_back(value); }
+inline void appendValue(StringColumn &column, const std::string &value) { column.push_back(value); }
+template <typename Values, typename List> void appendValue(ListColumn<Values> &column, const List &list)
+{
+	for (const auto &element : list) {
+		appendValue(column.values(), element);
+	}
+	column.finishRow();
+}
+
+/// Used for fields that are absent in a row, so that all columns keep the same number of rows
+template <typename T> void appendDefault(std::vector<T> &column) { column.emplace_back(); }
+inline void appendDefault(StringColumn &column) { column.push_back(std::string()); }
+template <typename Values> void appendDefault(ListColumn<Values> &column) { column.finishRow(); }
+
+template <typename T, typename Value> void readValue(const std::vector<T> &column, const std::size_t row, Value &value) { value = column[row]; }
+inline void readValue(const StringColumn &column, const std::size_t row, std::string &value) { value = column.at(row); }
+template <typename Values, typename List> void readValue(const ListColumn<Values> &column, const std::size_t row, List &list)
+{
+	list.clear();
+	for (std::size_t i = column.begin(row); i < column.end(row); ++i) {
+		typename List::value_type element{};
+		readValue(column.values(), i, element);
+		list.push_back(element);
+	}
+}
+
+// parsing straight into columns, like the handleParse* functions do for single values. scalars are parsed into a
+// temporary so that nothing is appended on error, objects and arrays are parsed in place
+
+template <typename Column> HandleParseAction handleAppendNull(Column &) { return HandleParseAction("Unexpected value of type 'null'"); }
+template <typename Column> HandleParseAction handleAppendBoolean(Column &, const bool) { return HandleParseAction("Unexpected value of type 'boolean'"); }
+template <typename Column> HandleParseAction handleAppendInteger(Column &, const int64_t) { return HandleParseAction("Unexpected value of type 'integer'"); }
+template <typename Column> HandleParseAction handleAppendDouble(Column &, const double) { return HandleParseAction("Unexpected value of type 'double'"); }
+template <typename Column> HandleParseAction handleAppendString(Column &, const std::string &) { return HandleParseAction("Unexpected value of type 'string'"); }
+template <typename Column> HandleParseAction handleAppendObject(Column &) { return HandleParseAction("Unexpected value of type 'object'"); }
+template <typename Column> HandleParseAction handleAppendArray(Column &) { return HandleParseAction("Unexpected value of type 'array'"); }
+
+namespace detail {
+template <typename T>
+HandleParseAction appendIfParsed(std::vector<T> &column, const T &value, const HandleParseAction &action)
+{
+	if (action.action == HandleParseAction::Success) {
+		column.push_back(value);
+	}
+	return action;
+}
+template <typename T>
+HandleParseAction removeIfFailed(std::vector<T> &column, const HandleParseAction &action)
+{
+	if (action.action == HandleParseAction::Error) {
+		column.pop_back();
+	}
+	return action;
+}
+}
+template <typename T> HandleParseAction handleAppendNull(std::vector<T> &column)
+{
+	T value{};
+	return detail::appendIfParsed(column, value, handleParseNull(value));
+}
+template <typename T> HandleParseAction handleAppendBoolean(std::vector<T> &column, const bool val)
+{
+	T value{};
+	return detail::appendIfParsed(column, value, handleParseBoolean(value, val));
+}
+template <typename T> HandleParseAction handleAppendInteger(std::vector<T> &column, const int64_t val)
+{
+	T value{};
+	return detail::appendIfParsed(column, value, handleParseInteger(value, val));
+}
+template <typename T> HandleParseAction handleAppendDouble(std::vector<T> &column, const double val)
+{
+	T value{};
+	return detail::appendIfParsed(column, value, handleParseDouble(value, val));
+}
+template <typename T> HandleParseAction handleAppendString(std::vector<T> &column, const std::string &val)
+{
+	T value{};
+	return detail::appendIfParsed(column, value, handleParseString(value, val));
+}
+template <typename T> HandleParseAction handleAppendObject(std::vector<T> &column)
+{
+	column.emplace_back();
+	return detail::removeIfFailed(column, handleParseObject(column.back()));
+}
+template <typename T> HandleParseAction handleAppendArray(std::vector<T> &column)
+{
+	column.emplace_back();
+	return detail::removeIfFailed(column, handleParseArray(column.back()));
+}
+// std::vector<bool> has no addressable elements
+inline HandleParseAction handleAppendBoolean(std::vector<bool> &column, const bool val) { column.push_back(val); return HandleParseAction::Success; }
+inline HandleParseAction handleAppendNull(std::vector<bool> &) { return HandleParseAction("Unexpected value of type 'null'"); }
+inline HandleParseAction handleAppendObject(std::vector<bool> &) { return HandleParseAction("Unexpected value of type 'object'"); }
+inline HandleParseAction handleAppendArray(std::vector<bool> &) { return HandleParseAction("Unexpected value of type 'array'"); }
+
+inline HandleParseAction handleAppendString(StringColumn &column, const std::string &val) { column.push_back(val); return HandleParseAction::Success; }
+
+template <typename Values> class ListColumnSaxSink;
+template <typename Values> HandleParseAction handleAppendArray(ListColumn<Values> &column)
+{
+	return HandleParseAction(HandleParseAction::DelegateToArray, new ListColumnSaxSink<Values>(column));
+}
+
+/// Parses one array into a new row of a ListColumn
+template <typename Values>
+class ListColumnSaxSink : public Util::DelegatingSaxSink
+{
+	ListColumn<Values> &m_column;
+	bool m_wasStarted = false;
+
+public:
+	explicit ListColumnSaxSink(ListColumn<Values> &column) : m_column(column) {}
+
+protected:
+	bool nullImpl() override { return handle(handleAppendNull(m_column.values())); }
+	bool booleanImpl(const bool val) override { return handle(handleAppendBoolean(m_column.values(), val)); }
+	bool integerNumberImpl(const int64_t val) override { return handle(handleAppendInteger(m_column.values(), val)); }
+	bool doubleNumberImpl(const double val) override { return handle(handleAppendDouble(m_column.values(), val)); }
+	bool stringImpl(const std::string &str) override { return handle(handleAppendString(m_column.values(), str)); }
+	bool startObjectImpl() override { return handle(handleAppendObject(m_column.values())); }
+	bool keyImpl(const std::string &) override { return reportError("Unexpected key outside of an object"); }
+	bool endObjectImpl(const std::size_t) override { return true; }
+	bool startArrayImpl() override
+	{
+		if (!m_wasStarted) {
+			m_wasStarted = true;
+			return true;
+		}
+		return handle(handleAppendArray(m_column.values()));
+	}
+	bool endArrayImpl(const std::size_t) override
+	{
+		m_column.finishRow();
+		return true;
+	}
+
+private:
+	bool handle(const HandleParseAction &action)
+	{
+		switch (action.action) {
+		case HandleParseAction::Success:
+			return true;
+		case HandleParseAction::DelegateToArray:
+			delegateToArray(action.delegationTarget);
+			return true;
+		case HandleParseAction::DelegateToObject:
+			delegateToObject(action.delegationTarget);
+			return true;
+		case HandleParseAction::Error:
+			break;
+		}
+		return reportError(action.error);
+	}
+};
+}
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "FieldMask.h"
+
+namespace Argonauts {
+namespace Runtime {
+FieldMask::FieldMask(const std::vector<std::string> &paths)
+	: m_all(false)
+{
+	for (const std::string &path : paths) {
+		add(path);
+	}
+}
+
+const FieldMask &FieldMask::all()
+{
+	// never destroyed, sinks might still refer to it during static destruction
+	static const FieldMask *mask = new FieldMask();
+	return *mask;
+}
+
+const FieldMask &FieldMask::child(const std::string &field) const
+{
+	const auto it = m_fields.find(field);
+	return it == m_fields.end() ? all() : it->second;
+}
+
+void FieldMask::add(const std::string &path)
+{
+	const std::size_t dot = path.find('.');
+	const std::string field = path.substr(0, dot);
+	const auto it = m_fields.find(field);
+	if (dot == std::string::npos) {
+		// the field as a whole wins over any nested fields selected before or after
+		m_fields[field] = FieldMask();
+	} else if (it == m_fields.end()) {
+		FieldMask child;
+		child.m_all = false;
+		child.add(path.substr(dot + 1));
+		m_fields.emplace(field, child);
+	} else if (!it->second.m_all) {
+		it->second.add(path.substr(dot + 1));
+	}
+	m_all = false;
+}
+}
+}
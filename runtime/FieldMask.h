@@ -0,0 +1,62 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Argonauts {
+namespace Runtime {
+/* Selects the fields of a struct (and of the structs nested in it) that should be parsed, all others are skipped by the
+ * reader without being decoded. Nested fields are given as paths separated by dots, lists, maps and variants are looked
+ * through, so "users.name" selects the name of every user in the users list. A field selected without any nested path
+ * is parsed completely.
+ *
+ * Usage:
+ * ```
+ * Site site;
+ * const FieldMask mask({"name", "users.name"});
+ * HandleParseAction action = handleParseObject(site, mask);
+ * ```
+ *
+ * The mask has to outlive parsing, sinks only keep references to it.
+ */
+class FieldMask
+{
+public:
+	/// Selects everything
+	explicit FieldMask() {}
+	explicit FieldMask(const std::vector<std::string> &paths);
+
+	/// The mask selecting everything, for when no projection is requested
+	static const FieldMask &all();
+
+	bool selectsAll() const { return m_all; }
+	bool selects(const std::string &field) const { return m_all || m_fields.find(field) != m_fields.end(); }
+	/// The mask for the value of the given field, which selects everything if no nested fields were selected
+	const FieldMask &child(const std::string &field) const;
+
+	void add(const std::string &path);
+
+private:
+	std::map<std::string, FieldMask> m_fields;
+	bool m_all = true;
+};
+}
+}
@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include "util/Instrumentation.h"
+#include "FieldMask.h"
+
 namespace Argonauts {
 namespace Util { class SaxSink; }
 namespace Runtime {
@@ -30,20 +33,26 @@ struct HandleParseAction
 		Success
 	} action;
 
-	Util::SaxSink *delegationTarget;
+	Util::SaxSink *delegationTarget = nullptr;
 	std::string error;
 
 	HandleParseAction(const Action &a) : action(a) {}
-	explicit HandleParseAction(const Action &a, Util::SaxSink *sink) : action(a), delegationTarget(sink) {}
+	explicit HandleParseAction(const Action &a, Util::SaxSink *sink) : action(a), delegationTarget(sink) { ARGONAUTS_COUNT(allocations, 1); }
 	explicit HandleParseAction(const std::string &err) : action(Error), error(err) {}
 };
 
 template <typename Type> HandleParseAction handleParseNull(Type &) { return HandleParseAction("Unexpected value of type 'null'"); }
-template <typename Type> HandleParseAction handleParseInteger(Type &type, const int64_t val);
-template <typename Type> HandleParseAction handleParseDouble(Type &type, const double val);
-template <typename Type> HandleParseAction handleParseString(Type &type, const std::string &string);
+template <typename Type> HandleParseAction handleParseBoolean(Type &, const bool) { return HandleParseAction("Unexpected value of type 'boolean'"); }
+template <typename Type> HandleParseAction handleParseInteger(Type &, const int64_t) { return HandleParseAction("Unexpected value of type 'integer'"); }
+template <typename Type> HandleParseAction handleParseDouble(Type &, const double) { return HandleParseAction("Unexpected value of type 'double'"); }
+template <typename Type> HandleParseAction handleParseString(Type &, const std::string &) { return HandleParseAction("Unexpected value of type 'string'"); }
 template <typename Type> HandleParseAction handleParseObject(Type &) { return HandleParseAction("Unexpected value of type 'object'"); }
-template <typename Type> HandleParseAction handleParseArray(Type &type);
+template <typename Type> HandleParseAction handleParseArray(Type &) { return HandleParseAction("Unexpected value of type 'array'"); }
+// only the fields selected by the mask are parsed, types that have no fields ignore it
+template <typename Type> HandleParseAction handleParseObject(Type &type, const FieldMask &) { return handleParseObject(type); }
+template <typename Type> HandleParseAction handleParseArray(Type &type, const FieldMask &) { return handleParseArray(type); }
+
+inline HandleParseAction handleParseBoolean(bool &type, const bool val) { type = val; return HandleParseAction::Success; }
 
 inline HandleParseAction handleParseInteger(int8_t &type, const int64_t val) { type = int8_t(val); return HandleParseAction::Success; }
 inline HandleParseAction handleParseInteger(int16_t &type, const int64_t val) { type = int16_t(val); return HandleParseAction::Success; }
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Argonauts {
+namespace Runtime {
+namespace detail {
+template <std::size_t Bits>
+using PresenceWord = typename std::conditional<Bits <= 8, std::uint8_t,
+	typename std::conditional<Bits <= 16, std::uint16_t,
+	typename std::conditional<Bits <= 32, std::uint32_t, std::uint64_t>::type>::type>::type;
+
+inline std::size_t countTrailingZeros(const std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return std::size_t(__builtin_ctzll(word));
+#else
+	std::size_t count = 0;
+	for (std::uint64_t w = word; (w & 1) == 0; w >>= 1) {
+		++count;
+	}
+	return count;
+#endif
+}
+}
+
+/* Which of the Bits fields of a generated struct have been set, one bit per field in declaration order. Uses the
+ * smallest integer that fits, and an array of 64 bit words for structs with more than 64 fields.
+ */
+template <std::size_t Bits>
+class PresenceMask
+{
+	using Word = detail::PresenceWord<Bits>;
+	static constexpr std::size_t wordBits = sizeof(Word) * 8;
+	static constexpr std::size_t words = Bits == 0 ? 1 : (Bits + wordBits - 1) / wordBits;
+	static constexpr std::size_t lastWordBits = Bits - (words - 1) * wordBits;
+	static constexpr Word lastWordMask = lastWordBits == wordBits ? Word(~Word(0)) : Word((Word(1) << lastWordBits) - 1);
+
+	Word m_words[words] = {};
+
+public:
+	constexpr bool test(const std::size_t bit) const { return (m_words[bit / wordBits] >> (bit % wordBits)) & 1; }
+	constexpr void set(const std::size_t bit) { m_words[bit / wordBits] |= Word(Word(1) << (bit % wordBits)); }
+	constexpr void reset(const std::size_t bit) { m_words[bit / wordBits] &= Word(~(Word(1) << (bit % wordBits))); }
+
+	/// True if every bit that is set in other is also set here
+	constexpr bool containsAll(const PresenceMask<Bits> &other) const
+	{
+		for (std::size_t i = 0; i < words; ++i) {
+			if ((m_words[i] & other.m_words[i]) != other.m_words[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+	constexpr PresenceMask<Bits> operator|(const PresenceMask<Bits> &other) const
+	{
+		PresenceMask<Bits> out;
+		for (std::size_t i = 0; i < words; ++i) {
+			out.m_words[i] = Word(m_words[i] | other.m_words[i]);
+		}
+		return out;
+	}
+	/// Sets exactly the bits below Bits that are not set here, the unused bits of the last word stay clear
+	constexpr PresenceMask<Bits> operator~() const
+	{
+		PresenceMask<Bits> out;
+		for (std::size_t i = 0; i < words; ++i) {
+			out.m_words[i] = Word(~m_words[i]);
+		}
+		out.m_words[words - 1] &= lastWordMask;
+		return out;
+	}
+	constexpr PresenceMask<Bits> operator&(const PresenceMask<Bits> &other) const
+	{
+		PresenceMask<Bits> out;
+		for (std::size_t i = 0; i < words; ++i) {
+			out.m_words[i] = Word(m_words[i] & other.m_words[i]);
+		}
+		return out;
+	}
+
+	/// Calls func with the index of every set bit, in ascending order
+	template <typename Func>
+	void forEach(Func &&func) const
+	{
+		for (std::size_t i = 0; i < words; ++i) {
+			for (std::uint64_t word = m_words[i]; word != 0; word &= word - 1) {
+				func(i * wordBits + detail::countTrailingZeros(word));
+			}
+		}
+	}
+	/// Index of the lowest set bit, or Bits if none is set
+	std::size_t first() const
+	{
+		for (std::size_t i = 0; i < words; ++i) {
+			if (m_words[i] != 0) {
+				return i * wordBits + detail::countTrailingZeros(m_words[i]);
+			}
+		}
+		return Bits;
+	}
+	std::size_t count() const
+	{
+		std::size_t count = 0;
+		forEach([&count](const std::size_t) { ++count; });
+		return count;
+	}
+};
+}
+}
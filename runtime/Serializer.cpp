@@ -16,10 +16,39 @@
 
 #include "Serializer.h"
 
+#include "util/json/JsonSaxReader.h"
+
 namespace Argonauts
 {
 namespace Runtime
 {
 Serializer::~Serializer() {}
+
+namespace {
+class SerializingSaxSink : public Util::SaxSink
+{
+	Serializer *m_serializer;
+
+public:
+	explicit SerializingSaxSink(Serializer *serializer) : m_serializer(serializer) {}
+
+	bool null() override { m_serializer->emitNull(); return true; }
+	bool boolean(const bool val) override { m_serializer->emitValue(val); return true; }
+	bool integerNumber(const int64_t val) override { m_serializer->emitValue(std::int64_t(val)); return true; }
+	bool doubleNumber(const double val) override { m_serializer->emitValue(val); return true; }
+	bool string(const std::string &str) override { m_serializer->emitValue(str); return true; }
+	bool startObject() override { m_serializer->emitObjectStart(); return true; }
+	bool key(const std::string &str) override { m_serializer->emitObjectKey(str); return true; }
+	bool endObject(const std::size_t size) override { m_serializer->emitObjectEnd(size); return true; }
+	bool startArray() override { m_serializer->emitArrayStart(); return true; }
+	bool endArray(const std::size_t size) override { m_serializer->emitArrayEnd(size); return true; }
+};
+}
+
+void Serializer::emitRawValue(const std::string &json)
+{
+	SerializingSaxSink sink(this);
+	Util::Json::readValue(json, &sink);
+}
 }
 }
@@ -19,14 +19,11 @@
 #include <string>
 #include <cstdint>
 #include <vector>
+#include <map>
 #include <unordered_map>
 
 #include "util/SaxSink.h"
-
-namespace std
-{
-template <typename A, typename B> class map;
-}
+#include "util/Variant.h"
 
 namespace Argonauts
 {
@@ -42,7 +39,9 @@ public:
 
 	virtual bool packedEnums() const { return false; }
 
+	virtual void emitNull() = 0;
 	virtual void emitValue(const std::string &val) = 0;
+	virtual void emitValue(const bool val) = 0;
 	virtual void emitValue(const std::int8_t val) { return emitValue(std::int64_t(val)); }
 	virtual void emitValue(const std::int16_t val) { return emitValue(std::int64_t(val)); }
 	virtual void emitValue(const std::int32_t val) { return emitValue(std::int64_t(val)); }
@@ -58,6 +57,10 @@ public:
 	virtual void emitObjectKey(const std::string &key) = 0;
 	virtual void emitObjectEnd(const std::size_t size) = 0;
 
+	/// Emits a value given as JSON text, like the unknown fields kept by @unknownFields("keep"). It has to be valid.
+	/// By default it is read and emitted value by value, serializers that write JSON can pass the text on as it is
+	virtual void emitRawValue(const std::string &json);
+
 	template <typename Type>
 	void emitValue(const std::map<std::string, Type> &map)
 	{
@@ -79,6 +82,12 @@ public:
 		emitArrayEnd(array.size());
 	}
 
+	template <typename... Types>
+	void emitValue(const Util::Variant<Types...> &variant)
+	{
+		variant.visit([this](const auto &value) { emitValue(value); });
+	}
+
 	template <typename Type>
 	void emitValue(const Type &t)
 	{
@@ -101,18 +110,26 @@ private:
 class SaxSinkSerializer : public Serializer
 {
 	Argonauts::Util::SaxSink *m_sink;
+	bool m_failed = false;
 
 public:
 	explicit SaxSinkSerializer(Argonauts::Util::SaxSink *sink) : m_sink(sink) {}
 
-	void emitValue(const std::string &val) override { m_sink->string(val); }
-	void emitValue(const std::int64_t val) override { m_sink->integerNumber(val); }
-	void emitValue(const double val) override { m_sink->doubleNumber(val); }
-	void emitArrayStart() override { m_sink->startArray(); }
-	void emitArrayEnd(const std::size_t size) override { m_sink->endArray(size); }
-	void emitObjectStart() override { m_sink->startObject(); }
-	void emitObjectKey(const std::string &key) override { m_sink->key(key); }
-	void emitObjectEnd(const std::size_t size) override { m_sink->endObject(size); }
+	/// True once the sink has refused something, for example because the output stream could not be written to.
+	/// Everything emitted after that is dropped
+	bool hasFailed() const { return m_failed; }
+
+	void emitNull() override { m_failed = m_failed || !m_sink->null(); }
+	void emitValue(const std::string &val) override { m_failed = m_failed || !m_sink->string(val); }
+	void emitValue(const bool val) override { m_failed = m_failed || !m_sink->boolean(val); }
+	void emitValue(const std::int64_t val) override { m_failed = m_failed || !m_sink->integerNumber(val); }
+	void emitValue(const double val) override { m_failed = m_failed || !m_sink->doubleNumber(val); }
+	void emitArrayStart() override { m_failed = m_failed || !m_sink->startArray(); }
+	void emitArrayEnd(const std::size_t size) override { m_failed = m_failed || !m_sink->endArray(size); }
+	void emitObjectStart() override { m_failed = m_failed || !m_sink->startObject(); }
+	void emitObjectKey(const std::string &key) override { m_failed = m_failed || !m_sink->key(key); }
+	void emitObjectEnd(const std::size_t size) override { m_failed = m_failed || !m_sink->endObject(size); }
+	void emitRawValue(const std::string &json) override { m_failed = m_failed || !m_sink->rawValue(json); }
 };
 }
 }
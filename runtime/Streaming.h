@@ -0,0 +1,209 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "util/SaxSink.h"
+#include "Parser.h"
+
+namespace Argonauts {
+namespace Runtime {
+/* Parses a JSON array element by element and hands each element to a callback as soon as it is complete, instead of
+ * collecting all of them in a container. Only one element is held in memory at a time. Elements can be of any type
+ * that can be parsed on its own, i.e. built-ins, enums and structs. The callback can return false to stop parsing.
+ * With a FieldMask only the selected fields of each element are parsed.
+ *
+ * Usage:
+ * ```
+ * ArrayStreamSink<User> sink([](User &&user) { process(user); return true; });
+ * Util::Json::SaxReader reader(&sink);
+ * ```
+ */
+template <typename Element>
+class ArrayStreamSink : public Util::DelegatingSaxSink
+{
+public:
+	using Callback = std::function<bool(Element &&element)>;
+
+	explicit ArrayStreamSink(const Callback &callback, const FieldMask &mask = FieldMask()) : m_callback(callback), m_mask(mask) {}
+
+	/// Number of elements passed to the callback so far
+	std::size_t count() const { return m_count; }
+
+protected:
+	bool nullImpl() override { return handle(handleParseNull(m_current)); }
+	bool booleanImpl(const bool val) override { return handle(handleParseBoolean(m_current, val)); }
+	bool integerNumberImpl(const int64_t val) override { return handle(handleParseInteger(m_current, val)); }
+	bool doubleNumberImpl(const double val) override { return handle(handleParseDouble(m_current, val)); }
+	bool stringImpl(const std::string &str) override { return handle(handleParseString(m_current, str)); }
+	bool startObjectImpl() override { return handle(handleParseObject(m_current, m_mask)); }
+	bool keyImpl(const std::string &) override { return reportError("Unexpected key outside of an object"); }
+	bool endObjectImpl(const std::size_t) override { return true; }
+	bool startArrayImpl() override
+	{
+		if (!m_wasStarted) {
+			m_wasStarted = true;
+			return true;
+		}
+		return handle(handleParseArray(m_current, m_mask));
+	}
+	bool endArrayImpl(const std::size_t) override { return true; }
+	bool delegationFinishedImpl() override { return emit(); }
+
+private:
+	Callback m_callback;
+	FieldMask m_mask;
+	Element m_current = Element();
+	std::size_t m_count = 0;
+	bool m_wasStarted = false;
+
+	bool handle(const HandleParseAction &action)
+	{
+		switch (action.action) {
+		case HandleParseAction::Success:
+			return emit();
+		case HandleParseAction::DelegateToArray:
+			delegateToArray(action.delegationTarget);
+			return true;
+		case HandleParseAction::DelegateToObject:
+			delegateToObject(action.delegationTarget);
+			return true;
+		case HandleParseAction::Error:
+			break;
+		}
+		return reportError(action.error);
+	}
+	bool emit()
+	{
+		++m_count;
+		const bool result = m_callback(std::move(m_current));
+		m_current = Element();
+		return result || reportError("Stopped after element %zu", m_count);
+	}
+};
+
+/* Parses an object of type Type, but instead of collecting the elements of the list member named `field` they are
+ * passed to a callback one by one, like ArrayStreamSink does. All other members end up in `value` as usual. A mask
+ * applies to the object, and the part of it for `field` to the elements.
+ */
+template <typename Type, typename Element>
+class FieldStreamSink : public Util::SaxSink
+{
+public:
+	using Callback = typename ArrayStreamSink<Element>::Callback;
+
+	explicit FieldStreamSink(Type &value, const std::string &field, const Callback &callback, const FieldMask &mask = FieldMask::all())
+		: m_value(handleParseObject(value, mask).delegationTarget), m_field(field), m_elements(callback, mask.child(field)) {}
+	~FieldStreamSink()
+	{
+		delete m_value;
+	}
+
+	std::size_t count() const { return m_elements.count(); }
+
+	bool null() override { return expectNoField() && forward(target()->null()); }
+	bool boolean(const bool val) override { return expectNoField() && forward(target()->boolean(val)); }
+	bool integerNumber(const int64_t val) override { return expectNoField() && forward(target()->integerNumber(val)); }
+	bool doubleNumber(const double val) override { return expectNoField() && forward(target()->doubleNumber(val)); }
+	bool string(const std::string &str) override { return expectNoField() && forward(target()->string(str)); }
+	bool startObject() override
+	{
+		if (!expectNoField()) {
+			return false;
+		}
+		++m_depth;
+		const bool result = target()->startObject();
+		// the sink of the object itself does not expect to be told about its own start
+		return (m_depth == 1 && !isStreaming()) || forward(result);
+	}
+	bool key(const std::string &str) override
+	{
+		if (!isStreaming() && m_depth == 1 && str == m_field) {
+			m_fieldIsNext = true;
+			return forward(m_value->key(str));
+		}
+		return forward(target()->key(str));
+	}
+	bool endObject(const std::size_t size) override
+	{
+		--m_depth;
+		return forward(target()->endObject(size));
+	}
+	bool startArray() override
+	{
+		++m_depth;
+		if (m_fieldIsNext) {
+			// the field itself stays empty, but counts as present
+			m_fieldIsNext = false;
+			if (!forward(m_value->startArray()) || !forward(m_value->endArray(0))) {
+				return false;
+			}
+			m_streamingDepth = m_depth;
+		}
+		return forward(target()->startArray());
+	}
+	Skip skipValue() override
+	{
+		const Skip skip = target()->skipValue();
+		if (skip != Skip::None) {
+			// the field was not selected by the mask, so there is nothing to stream
+			m_fieldIsNext = false;
+		}
+		return skip;
+	}
+	bool skipped(const std::string &raw) override { return forward(target()->skipped(raw)); }
+	bool endArray(const std::size_t size) override
+	{
+		const bool result = forward(target()->endArray(size));
+		if (m_depth == m_streamingDepth) {
+			m_streamingDepth = 0;
+		}
+		--m_depth;
+		return result;
+	}
+
+private:
+	Util::SaxSink *m_value;
+	std::string m_field;
+	ArrayStreamSink<Element> m_elements;
+	int m_depth = 0;
+	int m_streamingDepth = 0;
+	bool m_fieldIsNext = false;
+
+	bool isStreaming() const { return m_streamingDepth > 0; }
+	Util::SaxSink *target()
+	{
+		if (isStreaming()) {
+			return &m_elements;
+		}
+		return m_value;
+	}
+	bool expectNoField()
+	{
+		return !m_fieldIsNext || reportError(std::string("Expected an array for '") + m_field + "'");
+	}
+	bool forward(const bool result)
+	{
+		return result || reportError(isStreaming() ? m_elements.error() : m_value->error());
+	}
+};
+}
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "AllocationTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+// plain counters, so that counting itself never allocates
+static thread_local std::size_t allocationCount = 0;
+static thread_local std::size_t allocationBytes = 0;
+static thread_local std::size_t deallocationCount = 0;
+
+static void *allocate(const std::size_t size)
+{
+	++allocationCount;
+	allocationBytes += size;
+	void *ptr = std::malloc(size == 0 ? 1 : size);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+static void deallocate(void *ptr)
+{
+	if (ptr) {
+		++deallocationCount;
+		std::free(ptr);
+	}
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	try {
+		return allocate(size);
+	} catch (std::bad_alloc &) {
+		return nullptr;
+	}
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	try {
+		return allocate(size);
+	} catch (std::bad_alloc &) {
+		return nullptr;
+	}
+}
+void operator delete(void *ptr) noexcept { deallocate(ptr); }
+void operator delete[](void *ptr) noexcept { deallocate(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { deallocate(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { deallocate(ptr); }
+
+namespace Argonauts {
+namespace Testing {
+AllocationScope::AllocationScope()
+	: m_startAllocations(allocationCount), m_startBytes(allocationBytes), m_startDeallocations(deallocationCount) {}
+
+std::size_t AllocationScope::allocations() const
+{
+	return allocationCount - m_startAllocations;
+}
+std::size_t AllocationScope::bytes() const
+{
+	return allocationBytes - m_startBytes;
+}
+std::size_t AllocationScope::deallocations() const
+{
+	return deallocationCount - m_startDeallocations;
+}
+}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace Argonauts {
+namespace Testing {
+/* Counts the heap allocations made by the current thread while it exists. Linking AllocationTracker.cpp into an
+ * executable replaces the global operator new/delete to make this possible. Scopes can be nested, each one sees all
+ * allocations made during its lifetime.
+ *
+ * Usage:
+ * ```
+ * AllocationScope scope;
+ * doSomething();
+ * REQUIRE(scope.allocations() <= 3);
+ * ```
+ */
+class AllocationScope
+{
+	const std::size_t m_startAllocations;
+	const std::size_t m_startBytes;
+	const std::size_t m_startDeallocations;
+public:
+	explicit AllocationScope();
+
+	/// Number of calls to operator new since the scope was created
+	std::size_t allocations() const;
+	/// Total size requested from operator new since the scope was created
+	std::size_t bytes() const;
+	/// Number of calls to operator delete (with a non-null pointer) since the scope was created
+	std::size_t deallocations() const;
+};
+}
+}
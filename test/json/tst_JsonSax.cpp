@@ -16,6 +16,10 @@
 
 #include <catch.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
 #include "SaxSink.h"
 #include "json/JsonSaxWriter.h"
 #include "json/JsonSaxReader.h"
@@ -172,3 +176,378 @@ TEST_CASE("can do roundtrip", "[Json::SaxReader][Json::SaxWriter][StringOutputSt
 	REQUIRE_FALSE(parser.isError());
 	REQUIRE(output.result() == jsonData2);
 }
+
+TEST_CASE("handles values directly followed by the end of their container", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	parser.addData("[1,2.5,true,{\"a\":null}]");
+	parser.end();
+	REQUIRE_FALSE(parser.isError());
+	REQUIRE(handler.m_items.size() == 9);
+	REQUIRE(handler.m_items.at(6) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::Null));
+	REQUIRE(handler.m_items.at(7) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndObject, std::size_t(1)));
+	REQUIRE(handler.m_items.at(8) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndArray, std::size_t(4)));
+}
+
+TEST_CASE("gives the same result regardless of chunk boundaries", "[Json::SaxReader]") {
+	TestingJsonSaxHandler whole;
+	SaxReader wholeParser(&whole);
+	wholeParser.addData(jsonData1);
+	wholeParser.end();
+
+	TestingJsonSaxHandler chunked;
+	SaxReader chunkedParser(&chunked);
+	for (const char c : jsonData1) {
+		chunkedParser.addData(&c, 1);
+	}
+	chunkedParser.end();
+
+	REQUIRE_FALSE(chunkedParser.isError());
+	REQUIRE(chunked.m_items == whole.m_items);
+}
+
+class SkippingJsonSaxHandler : public TestingJsonSaxHandler
+{
+public:
+	std::vector<std::string> m_skip;
+	std::vector<std::string> m_raw;
+
+	Skip skipValue() override
+	{
+		const Item &last = m_items.back();
+		return std::find(m_skip.begin(), m_skip.end(), last.string) != m_skip.end() ? Skip::Keep : Skip::None;
+	}
+	bool skipped(const std::string &raw) override
+	{
+		m_raw.push_back(raw);
+		return true;
+	}
+};
+
+TEST_CASE("skips values on request", "[Json::SaxReader]") {
+	const std::vector<std::string> expectedRaw = {"42.42", "{\"keywithspecialchars!#\\\"+-\":\"stringwith specialchars!#\\\"+-\",\"object\":{}}", "[\"string\",24.24,[[[[]]]]]"};
+
+	SkippingJsonSaxHandler whole;
+	whole.m_skip = {"double", "object", "array"};
+	SaxReader wholeParser(&whole);
+	wholeParser.addData(jsonData2);
+	wholeParser.end();
+	REQUIRE_FALSE(wholeParser.isError());
+	REQUIRE(whole.m_items.size() == 11);
+	REQUIRE(whole.m_items.back() == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndObject, std::size_t(6)));
+	REQUIRE(whole.m_raw == expectedRaw);
+
+	SkippingJsonSaxHandler chunked;
+	chunked.m_skip = whole.m_skip;
+	SaxReader chunkedParser(&chunked);
+	for (const char c : jsonData2) {
+		chunkedParser.addData(&c, 1);
+	}
+	chunkedParser.end();
+	REQUIRE_FALSE(chunkedParser.isError());
+	REQUIRE(chunked.m_items == whole.m_items);
+	REQUIRE(chunked.m_raw == expectedRaw);
+}
+
+TEST_CASE("reports invalid input", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	SECTION("invalid number") {
+		parser.addData("[1-2]");
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Invalid number '1-2'");
+		REQUIRE(parser.errorOffset() == 4);
+	}
+	SECTION("data after the root entity") {
+		parser.addData("{} {}");
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorOffset() == 3);
+	}
+	SECTION("scalar as root entity") {
+		parser.addData("42");
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Number cannot be root entity");
+	}
+}
+
+TEST_CASE("decodes \\u escapes", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	SECTION("basic multilingual plane") {
+		parser.addData("[\"\\u0041\\u00fc\\u20AC\"]");
+		parser.end();
+		REQUIRE_FALSE(parser.isError());
+		REQUIRE(handler.m_items.at(1) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::String, std::string("A\xc3\xbc\xe2\x82\xac")));
+	}
+	SECTION("surrogate pair split across chunks") {
+		const std::string data = "[\"\\ud83d\\ude00\"]";
+		for (const char c : data) {
+			parser.addData(&c, 1);
+		}
+		parser.end();
+		REQUIRE_FALSE(parser.isError());
+		REQUIRE(handler.m_items.at(1) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::String, std::string("\xf0\x9f\x98\x80")));
+	}
+	SECTION("unpaired surrogate") {
+		parser.addData("[\"\\ud83dx\"]");
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Unpaired surrogate \\ud83d");
+	}
+	SECTION("invalid hex digit") {
+		parser.addData("[\"\\u00g0\"]");
+		REQUIRE(parser.isError());
+	}
+}
+
+TEST_CASE("validates UTF-8", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	SECTION("rejects invalid strings") {
+		parser.addData("[\"\xc3(\"]");
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "String is not valid UTF-8");
+	}
+	SECTION("can be turned off") {
+		parser.setValidateUtf8(false);
+		parser.addData("[\"\xc3(\"]");
+		parser.end();
+		REQUIRE_FALSE(parser.isError());
+	}
+}
+
+TEST_CASE("escapes control characters", "[Json::SaxWriter]") {
+	StringOutputStream output;
+	SaxWriter writer(&output);
+	SaxSink &sink = writer;
+	sink.startArray();
+	sink.string(std::string("a\x01" "b\x1f", 4));
+	sink.endArray(1);
+	REQUIRE(output.result() == "[\"a\\u0001b\\u001f\"]");
+}
+
+TEST_CASE("writes doubles so that they read back the same", "[Json::SaxWriter]") {
+	const auto written = [](const double value) {
+		StringOutputStream output;
+		SaxWriter writer(&output);
+		SaxSink &sink = writer;
+		sink.startArray();
+		sink.doubleNumber(value);
+		sink.endArray(1);
+		return output.result();
+	};
+	REQUIRE(written(3.25) == "[3.25]");
+	REQUIRE(written(0.1) == "[0.1]");
+	REQUIRE(written(1.0 / 3.0) == "[0.3333333333333333]");
+	REQUIRE(written(123456789.0) == "[123456789.0]");
+	REQUIRE(written(-2.0) == "[-2.0]");
+	REQUIRE(written(1e300) == "[1e+300]");
+	REQUIRE(written(std::numeric_limits<double>::quiet_NaN()) == "[null]");
+	REQUIRE(written(-std::numeric_limits<double>::infinity()) == "[null]");
+
+	SECTION("and as doubles") {
+		TestingJsonSaxHandler handler;
+		SaxReader parser(&handler);
+		parser.addData(written(2.0));
+		parser.end();
+		REQUIRE_FALSE(parser.isError());
+		REQUIRE(handler.m_items.at(1) == TestingJsonSaxHandler::Item(2.0));
+	}
+}
+
+TEST_CASE("ends containers right after numbers and keywords in any chunk", "[Json::SaxReader]") {
+	const std::string data = "{\"a\":[1,true,-2.5],\"b\":null}";
+	const std::vector<TestingJsonSaxHandler::Item> expected = {
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::StartObject),
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::Key, std::string("a")),
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::StartArray),
+		TestingJsonSaxHandler::Item(int64_t(1)),
+		TestingJsonSaxHandler::Item(true),
+		TestingJsonSaxHandler::Item(-2.5),
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndArray, std::size_t(3)),
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::Key, std::string("b")),
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::Null),
+		TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndObject, std::size_t(2))
+	};
+	// the character that ends a number or keyword is also the one that ends the container, wherever the chunks split
+	for (std::size_t split = 0; split <= data.size(); ++split) {
+		TestingJsonSaxHandler handler;
+		SaxReader parser(&handler);
+		parser.addData(data.substr(0, split));
+		parser.addData(data.substr(split));
+		parser.end();
+		INFO("split at " << split);
+		REQUIRE_FALSE(parser.isError());
+		REQUIRE(handler.m_items == expected);
+	}
+}
+
+TEST_CASE("accepts scalars inside a root array", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	parser.addData("[\"a\",1,null]");
+	parser.end();
+	REQUIRE_FALSE(parser.isError());
+	REQUIRE(handler.m_items.size() == 5);
+	REQUIRE(handler.m_items.at(1) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::String, std::string("a")));
+	REQUIRE(handler.m_items.at(2) == TestingJsonSaxHandler::Item(int64_t(1)));
+	REQUIRE(handler.m_items.at(3) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::Null));
+
+	SECTION("but not as the root itself") {
+		TestingJsonSaxHandler rootHandler;
+		SaxReader rootParser(&rootHandler);
+		rootParser.addData("\"a\"");
+		REQUIRE(rootParser.isError());
+		REQUIRE(rootParser.errorMessage() == "String cannot be root entity");
+		REQUIRE(rootHandler.m_items.empty());
+	}
+}
+
+TEST_CASE("does not count whitespace as array elements", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	parser.addData("[ [ ] ,\r\n\t[ 1 , 2 ] ]");
+	parser.end();
+	REQUIRE_FALSE(parser.isError());
+	REQUIRE(handler.m_items.at(2) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndArray, std::size_t(0)));
+	REQUIRE(handler.m_items.at(6) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndArray, std::size_t(2)));
+	REQUIRE(handler.m_items.at(7) == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndArray, std::size_t(2)));
+}
+
+TEST_CASE("stops at the end of the root entity", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	SECTION("trailing whitespace is fine") {
+		parser.addData("[]");
+		parser.addData(" \r\n\t");
+		parser.end();
+		REQUIRE_FALSE(parser.isError());
+		REQUIRE(handler.m_items.size() == 2);
+	}
+	SECTION("a second closing bracket is not") {
+		parser.addData("[]");
+		parser.addData("]");
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Unexpected ']' after the root entity");
+		REQUIRE(parser.errorOffset() == 2);
+		REQUIRE(handler.m_items.size() == 2);
+	}
+}
+
+TEST_CASE("reports numbers it can not represent instead of throwing", "[Json::SaxReader]") {
+	TestingJsonSaxHandler handler;
+	SaxReader parser(&handler);
+	SECTION("integer overflow") {
+		REQUIRE_NOTHROW(parser.addData("[99999999999999999999]"));
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Invalid number '99999999999999999999'");
+	}
+	SECTION("double overflow") {
+		REQUIRE_NOTHROW(parser.addData("[1e999]"));
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Invalid number '1e999'");
+	}
+	SECTION("nothing but a sign") {
+		REQUIRE_NOTHROW(parser.addData("[-]"));
+		REQUIRE(parser.isError());
+		REQUIRE(parser.errorMessage() == "Invalid number '-'");
+	}
+}
+
+TEST_CASE("reads whole streams", "[Json::SaxReader]") {
+	// more than one chunk of operator>>
+	std::string data = "[";
+	for (int i = 0; i < 1000; ++i) {
+		data += std::to_string(i) + ",";
+	}
+	data += "true]";
+
+	TestingJsonSaxHandler handler;
+	std::istringstream stream(data);
+	REQUIRE_NOTHROW(stream >> static_cast<SaxSink *>(&handler));
+	REQUIRE(handler.m_items.size() == 1003);
+	REQUIRE(handler.m_items.at(1000) == TestingJsonSaxHandler::Item(int64_t(999)));
+	REQUIRE(handler.m_items.back() == TestingJsonSaxHandler::Item(TestingJsonSaxHandler::Item::EndArray, std::size_t(1001)));
+}
+
+class CountedJsonSaxHandler : public TestingJsonSaxHandler
+{
+public:
+	static int alive;
+	CountedJsonSaxHandler() { ++alive; }
+	~CountedJsonSaxHandler() { --alive; }
+
+	bool integerNumber(const int64_t val) override
+	{
+		if (val < 0) {
+			return reportError("negative numbers are not allowed");
+		}
+		return TestingJsonSaxHandler::integerNumber(val);
+	}
+	bool string(const std::string &str) override
+	{
+		return reportError("Unexpected string '" + str + "'");
+	}
+};
+int CountedJsonSaxHandler::alive = 0;
+
+// delegates every array to a new CountedJsonSaxHandler
+class ArrayDelegatingSaxSink : public DelegatingSaxSink
+{
+public:
+	int finished = 0;
+
+protected:
+	bool nullImpl() override { return true; }
+	bool booleanImpl(const bool) override { return true; }
+	bool integerNumberImpl(const int64_t) override { return true; }
+	bool doubleNumberImpl(const double) override { return true; }
+	bool stringImpl(const std::string &) override { return true; }
+	bool startObjectImpl() override { return true; }
+	bool keyImpl(const std::string &) override { return true; }
+	bool endObjectImpl(const std::size_t) override { return true; }
+	bool startArrayImpl() override
+	{
+		delegateToArray(new CountedJsonSaxHandler);
+		return true;
+	}
+	bool endArrayImpl(const std::size_t) override { return true; }
+	bool delegationFinishedImpl() override
+	{
+		++finished;
+		return true;
+	}
+};
+
+TEST_CASE("delegating sinks own the sinks they delegate to", "[SaxSink]") {
+	REQUIRE(CountedJsonSaxHandler::alive == 0);
+	SECTION("deleted once their container ends") {
+		ArrayDelegatingSaxSink sink;
+		SaxReader parser(&sink);
+		parser.addData("{\"a\":[1,[2]],\"b\":[]}");
+		parser.end();
+		REQUIRE_FALSE(parser.isError());
+		REQUIRE(sink.finished == 2);
+		REQUIRE(CountedJsonSaxHandler::alive == 0);
+	}
+	SECTION("deleted with the delegating sink if parsing stops early") {
+		{
+			ArrayDelegatingSaxSink sink;
+			SaxReader parser(&sink);
+			parser.addData("{\"a\":[1,-2,3]}");
+			REQUIRE(parser.isError());
+			REQUIRE(parser.errorMessage() == "negative numbers are not allowed");
+			REQUIRE(sink.finished == 0);
+			REQUIRE(CountedJsonSaxHandler::alive == 1);
+		}
+		REQUIRE(CountedJsonSaxHandler::alive == 0);
+	}
+}
+
+TEST_CASE("delegating sinks pass on the errors of their delegates unchanged", "[SaxSink]") {
+	ArrayDelegatingSaxSink sink;
+	SaxReader parser(&sink);
+	// used to be passed to reportError() as the format string
+	parser.addData("{\"a\":[\"100%s %d%n\"]}");
+	REQUIRE(parser.isError());
+	REQUIRE(parser.errorMessage() == "Unexpected string '100%s %d%n'");
+}
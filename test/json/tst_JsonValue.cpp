@@ -18,6 +18,7 @@
 
 #include "util/json/JsonValue.h"
 #include "util/json/JsonSaxReader.h"
+#include "util/json/JsonSaxWriter.h"
 
 using namespace Argonauts::Util;
 using namespace Json;
@@ -64,3 +65,21 @@ TEST_CASE("DOM parser works", "[Json::Value][Json::SaxReader]") {
 	REQUIRE(val["array"][2][0][0].isArray());
 	REQUIRE(val["array"][2][0][0][0].isArray());
 }
+
+TEST_CASE("copies and serializes values", "[Json::Value][Json::SaxWriter]") {
+	// the members for the other types used to be uninitialized, and were read by the copy
+	const Value string(std::string("a"));
+	const Value copy = string;
+	REQUIRE(copy == string);
+
+	Value val;
+	SaxReader reader(Value::parserSink(&val));
+	reader.addData("{\"b\":[1,2.5,\"c\",true,null],\"a\":{}}");
+	reader.end();
+	REQUIRE_FALSE(reader.isError());
+
+	StringOutputStream output;
+	SaxWriter writer(&output);
+	REQUIRE(val.serialize(&writer));
+	REQUIRE(output.result() == "{\"a\":{},\"b\":[1,2.5,\"c\",true,null]}");
+}
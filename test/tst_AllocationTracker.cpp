@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "example/Site.arg.h"
+#include "json/JsonSaxReader.h"
+#include "json/JsonSaxWriter.h"
+#include "FSUtil.h"
+
+using namespace Argonauts::Testing;
+using namespace Argonauts::Util;
+
+TEST_CASE("counts allocations", "[AllocationTracker]") {
+	AllocationScope outer;
+	REQUIRE(outer.allocations() == 0);
+	{
+		AllocationScope inner;
+		std::unique_ptr<int> value(new int(42));
+		std::vector<char> buffer(100);
+		REQUIRE(inner.allocations() == 2);
+		REQUIRE(inner.bytes() >= sizeof(int) + 100);
+	}
+	REQUIRE(outer.allocations() == 2);
+	REQUIRE(outer.deallocations() == 2);
+}
+
+TEST_CASE("serializing into a reserved buffer does not allocate", "[AllocationTracker][Json::SaxWriter]") {
+	std::string out;
+	out.reserve(1024);
+	StringOutputStream stream(&out);
+	Json::SaxWriter writer(&stream);
+	SaxSink &sink = writer;
+
+	const std::string key = "a key that is too long for the small string optimization";
+	const std::string value = "a \"value\"\nwith/characters that need\tto be escaped";
+
+	AllocationScope scope;
+	sink.startObject();
+	sink.key(key);
+	sink.string(value);
+	sink.key("numbers");
+	sink.startArray();
+	sink.integerNumber(-1234567890123);
+	sink.doubleNumber(3.25);
+	sink.boolean(true);
+	sink.null();
+	sink.endArray(4);
+	sink.endObject(2);
+	REQUIRE(scope.allocations() == 0);
+
+	REQUIRE(out == "{\"" + key + "\":\"a \\\"value\\\"\\nwith\\/characters that need\\tto be escaped\",\"numbers\":[-1234567890123,3.25,true,null]}");
+}
+
+TEST_CASE("parsing the Site fixture stays within its allocation budget", "[AllocationTracker][Generated]") {
+	// 49 with libstdc++ when this was written, the rest leaves room for other standard libraries. raise it only together
+	// with an explanation of where the new allocations come from
+	const std::size_t budget = 56;
+
+	const std::string data = FS::readFile(ARGONAUTS_SITE_FIXTURE);
+	std::vector<Site> sites;
+	sites.reserve(2);
+
+	AllocationScope scope;
+	{
+		Argonauts::Runtime::ArrayStreamSink<Site> sink([&sites](Site &&site) { sites.push_back(std::move(site)); return true; });
+		Json::SaxReader reader(&sink);
+		reader.addData(data);
+		reader.end();
+		REQUIRE_FALSE(reader.isError());
+	}
+	INFO("allocations: " << scope.allocations());
+	REQUIRE(sites.size() == 2);
+	REQUIRE(scope.allocations() <= budget);
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch.hpp>
+
+#include "Arena.h"
+
+#include <string>
+
+using namespace Argonauts::Util;
+
+namespace {
+struct Counted
+{
+	explicit Counted(int *alive_, const std::string &name_) : alive(alive_), name(name_) { ++*alive; }
+	Counted(Counted &&other) : alive(other.alive), name(std::move(other.name)) { ++*alive; }
+	~Counted() { --*alive; }
+
+	int *alive;
+	std::string name;
+};
+}
+
+TEST_CASE("values of an arena stay where they are", "[Arena]") {
+	int alive = 0;
+	const auto arena = std::make_shared<Arena<Counted, 4>>();
+	std::vector<std::shared_ptr<Counted>> values;
+	for (int i = 0; i < 10; ++i) {
+		values.push_back(arena->make(&alive, std::to_string(i)));
+	}
+	REQUIRE(arena->size() == 10);
+	REQUIRE(alive == 10);
+	for (int i = 0; i < 10; ++i) {
+		REQUIRE(values.at(std::size_t(i))->name == std::to_string(i));
+	}
+}
+
+TEST_CASE("values of an arena keep it alive", "[Arena]") {
+	int alive = 0;
+	std::shared_ptr<Counted> kept;
+	{
+		const auto arena = std::make_shared<Arena<Counted, 4>>();
+		for (int i = 0; i < 6; ++i) {
+			kept = arena->make(&alive, std::to_string(i));
+		}
+	}
+	REQUIRE(alive == 6);
+	REQUIRE(kept->name == "5");
+	kept.reset();
+	REQUIRE(alive == 0);
+}
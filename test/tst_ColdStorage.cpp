@@ -0,0 +1,102 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch.hpp>
+
+#include <string>
+#include <utility>
+
+#include "runtime/ColdStorage.h"
+
+using namespace Argonauts::Runtime;
+
+namespace {
+struct Fields
+{
+	std::string name;
+	int count = 0;
+};
+}
+
+TEST_CASE("reads defaults without allocating", "[ColdStorage]") {
+	const ColdStorage<Fields> storage;
+	REQUIRE_FALSE(storage.isAllocated());
+	REQUIRE(storage.get().name.empty());
+	REQUIRE(storage.get().count == 0);
+	REQUIRE_FALSE(storage.isAllocated());
+}
+
+TEST_CASE("allocates on the first write", "[ColdStorage]") {
+	ColdStorage<Fields> storage;
+	storage.mutate().count = 3;
+	REQUIRE(storage.isAllocated());
+	REQUIRE(storage.get().count == 3);
+	REQUIRE(ColdStorage<Fields>().get().count == 0);
+}
+
+TEST_CASE("copies deeply", "[ColdStorage]") {
+	ColdStorage<Fields> original;
+	original.mutate().name = "original";
+
+	SECTION("copy construction") {
+		ColdStorage<Fields> copy(original);
+		REQUIRE(copy.isAllocated());
+		REQUIRE(&copy.get() != &original.get());
+		copy.mutate().name = "copy";
+		REQUIRE(original.get().name == "original");
+		REQUIRE(copy.get().name == "copy");
+	}
+	SECTION("copy assignment") {
+		ColdStorage<Fields> copy;
+		copy.mutate().count = 5;
+		copy = original;
+		REQUIRE(&copy.get() != &original.get());
+		REQUIRE(copy.get().name == "original");
+		REQUIRE(copy.get().count == 0);
+		original.mutate().name = "changed";
+		REQUIRE(copy.get().name == "original");
+	}
+	SECTION("self assignment") {
+		ColdStorage<Fields> &self = original;
+		original = self;
+		REQUIRE(original.get().name == "original");
+	}
+	SECTION("from an unallocated block") {
+		const ColdStorage<Fields> empty;
+		ColdStorage<Fields> copy(empty);
+		REQUIRE_FALSE(copy.isAllocated());
+
+		ColdStorage<Fields> assigned(original);
+		assigned = empty;
+		REQUIRE_FALSE(assigned.isAllocated());
+		REQUIRE(assigned.get().name.empty());
+	}
+}
+
+TEST_CASE("moves the allocation", "[ColdStorage]") {
+	ColdStorage<Fields> original;
+	original.mutate().name = "moved";
+	const Fields *fields = &original.get();
+
+	ColdStorage<Fields> moved(std::move(original));
+	REQUIRE(&moved.get() == fields);
+	REQUIRE(moved.get().name == "moved");
+
+	ColdStorage<Fields> assigned;
+	assigned = std::move(moved);
+	REQUIRE(&assigned.get() == fields);
+	REQUIRE(assigned.isAllocated());
+}
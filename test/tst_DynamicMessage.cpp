@@ -0,0 +1,187 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include <memory>
+
+#include "AllocationTracker.h"
+#include "dynamic/DynamicMessage.h"
+#include "json/JsonSaxReader.h"
+#include "json/JsonSaxWriter.h"
+#include "json/JsonValue.h"
+#include "runtime/Serializer.h"
+#include "ArgonautsException.h"
+
+using namespace Argonauts;
+using namespace Argonauts::Dynamic;
+using namespace Argonauts::Testing;
+
+static const char *idl = R"(
+enum Color<UInt8> {
+	Red = 1;
+	Green = 2;
+}
+using Tags = List<String>;
+struct Point {
+	x Int32 = 0;
+	y Int32 = 1;
+}
+@unknownFields("keep")
+struct Shape {
+	name String = 0;
+	@optional
+	color Color = 1;
+	points List<Point> = 2;
+	@optional
+	tags Tags = 3;
+	@optional
+	weights Map<String, Double> = 4;
+	@optional
+	label Variant<String, Int64> = 5;
+	@optional
+	visible Bool = 6;
+}
+)";
+
+static bool parse(const std::string &data, DynamicMessage *message, std::string *error = nullptr)
+{
+	std::unique_ptr<Util::SaxSink> sink(DynamicMessage::parserSink(message));
+	Util::Json::SaxReader reader(sink.get());
+	reader.addData(data);
+	reader.end();
+	if (error) {
+		*error = reader.error().errorMessage();
+	}
+	return !reader.isError();
+}
+static std::string write(const DynamicMessage &message)
+{
+	Util::StringOutputStream stream;
+	Util::Json::SaxWriter writer(&stream);
+	Runtime::SaxSinkSerializer serializer(&writer);
+	message.serialize(&serializer);
+	return stream.result();
+}
+
+static const std::string shape = R"({"name":"triangle","color":"Green","points":[{"x":0,"y":0},{"x":4,"y":0},{"x":0,"y":3}],)"
+		R"("weights":{"a":0.5,"b":2},"label":7,"extra":{"kept":[1,2]}})";
+
+TEST_CASE("loads structs and enums from an IDL file", "[DynamicMessage]") {
+	const std::shared_ptr<const Schema> schema = Schema::load(idl);
+	REQUIRE(schema->message("Shape"));
+	REQUIRE(schema->message("Shape")->fields.size() == 7);
+	REQUIRE(schema->message("Tags") == nullptr);
+	REQUIRE(schema->enumeration("Color")->entries.size() == 2);
+	// presence bits, then by decreasing alignment
+	REQUIRE(schema->message("Point")->size == 16);
+	REQUIRE_THROWS_AS(DynamicMessage(schema, "Nothing"), Util::Exception);
+	REQUIRE_THROWS_AS(Schema::load("struct A { a Map<Int32, String>; }"), Util::Exception);
+	REQUIRE_THROWS_AS(Schema::load("struct A { b A; }"), Util::Exception);
+}
+
+TEST_CASE("parses and serializes like generated code", "[DynamicMessage]") {
+	const std::shared_ptr<const Schema> schema = Schema::load(idl);
+	DynamicMessage message(schema, "Shape");
+	REQUIRE(parse(shape, &message));
+
+	REQUIRE(message["name"].toString() == "triangle");
+	REQUIRE(message["color"].toEnumName() == "Green");
+	REQUIRE(message["color"].toInteger() == 2);
+	REQUIRE(message["points"].size() == 3);
+	REQUIRE(message["points"].at(2)["y"].toInteger() == 3);
+	REQUIRE(message["weights"].value("b").toDouble() == 2.0);
+	REQUIRE(message["label"].alternative().toInteger() == 7);
+	REQUIRE(message.has("weights"));
+	REQUIRE_FALSE(message.has("tags"));
+	REQUIRE(message.root().unknownFields().size() == 1);
+	REQUIRE_THROWS_AS(message["name"].toInteger(), Util::Exception);
+	REQUIRE_THROWS_AS(message["points"].at(3), Util::Exception);
+	REQUIRE_THROWS_AS(message["nothing"], Util::Exception);
+
+	const std::string written = write(message);
+	REQUIRE(written == R"({"name":"triangle","color":"Green","points":[{"x":0,"y":0},{"x":4,"y":0},{"x":0,"y":3}],)"
+			R"("weights":{"a":0.5,"b":2.0},"label":7,"extra":{"kept":[1,2]}})");
+
+	DynamicMessage copy = message;
+	DynamicMessage reread(schema, "Shape");
+	REQUIRE(parse(written, &reread));
+	REQUIRE(write(reread) == written);
+	REQUIRE(write(copy) == written);
+}
+
+TEST_CASE("checks values against the schema", "[DynamicMessage]") {
+	const std::shared_ptr<const Schema> schema = Schema::load(idl);
+	DynamicMessage message(schema, "Shape");
+	std::string error;
+
+	REQUIRE_FALSE(parse(R"({"name":"a"})", &message, &error));
+	REQUIRE(error.find("Missing required field 'points'") != std::string::npos);
+	REQUIRE_FALSE(parse(R"({"name":1,"points":[]})", &message, &error));
+	REQUIRE(error.find("Unexpected value of type 'integer' for 'name'") != std::string::npos);
+	REQUIRE_FALSE(parse(R"({"name":"a","color":"Blue","points":[]})", &message, &error));
+	REQUIRE(error.find("Invalid value for 'color'") != std::string::npos);
+	REQUIRE_FALSE(parse(R"({"name":"a","points":[{"x":3000000000,"y":0}]})", &message, &error));
+	REQUIRE(error.find("Invalid value for 'x'") != std::string::npos);
+	REQUIRE_FALSE(parse(R"({"name":"a","points":[{"x":1,"y":0,"z":2}]})", &message, &error));
+	REQUIRE(error.find("Unexpected key 'z'") != std::string::npos);
+	REQUIRE_FALSE(parse(R"({"name":"a","points":[],"visible":null})", &message, &error));
+
+	REQUIRE(parse(R"({"name":"a","color":1,"points":[],"label":"b","name":"c"})", &message));
+	REQUIRE(message["name"].toString() == "c");
+	REQUIRE(message["color"].toEnumName() == "Red");
+	REQUIRE(message["label"].which() == 0);
+}
+
+TEST_CASE("sets fields with checks", "[DynamicMessage]") {
+	const std::shared_ptr<const Schema> schema = Schema::load(idl);
+	DynamicMessage message(schema, "Shape");
+	message.set("name", "square");
+	message.set("color", "Red");
+	message.set("visible", true);
+	REQUIRE(write(message) == R"({"name":"square","color":"Red","points":[],"visible":true})");
+	REQUIRE_THROWS_AS(message.set("color", 3), Util::Exception);
+	REQUIRE_THROWS_AS(message.set("name", 3), Util::Exception);
+	message.clear("visible");
+	REQUIRE_FALSE(message.has("visible"));
+}
+
+TEST_CASE("allocates less than Json::Value", "[DynamicMessage][AllocationTracker]") {
+	const std::shared_ptr<const Schema> schema = Schema::load(idl);
+	std::string data = R"({"name":"many","points":[)";
+	for (int i = 0; i < 100; ++i) {
+		data += std::string(i == 0 ? "" : ",") + R"({"x":)" + std::to_string(i) + R"(,"y":)" + std::to_string(-i) + "}";
+	}
+	data += "]}";
+
+	AllocationScope dynamicScope;
+	DynamicMessage message(schema, "Shape");
+	REQUIRE(parse(data, &message));
+	const std::size_t dynamicAllocations = dynamicScope.allocations();
+	const std::size_t dynamicBytes = dynamicScope.bytes();
+
+	AllocationScope valueScope;
+	Util::Json::Value value;
+	std::unique_ptr<Util::SaxSink> sink(Util::Json::Value::parserSink(&value));
+	Util::Json::SaxReader reader(sink.get());
+	reader.addData(data);
+	reader.end();
+	REQUIRE_FALSE(reader.isError());
+
+	REQUIRE(dynamicAllocations * 4 < valueScope.allocations());
+	REQUIRE(dynamicBytes < valueScope.bytes());
+}
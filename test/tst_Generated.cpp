@@ -0,0 +1,217 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch.hpp>
+
+#include "generated/Contact.arg.h"
+#include "generated/Opcode.arg.h"
+#include "generated/Program.arg.h"
+#include "generated/Settings.arg.h"
+#include "generated/Shapes.arg.h"
+#include "util/json/JsonSaxReader.h"
+#include "util/json/JsonSaxWriter.h"
+
+using namespace Argonauts;
+
+// parses an array of values of type Type, returns the error of the reader if it fails
+template <typename Type>
+static std::string parse(const std::string &data, std::vector<Type> *values, const Runtime::FieldMask &mask = Runtime::FieldMask())
+{
+	Runtime::ArrayStreamSink<Type> sink([values](Type &&value) { values->push_back(std::move(value)); return true; }, mask);
+	Util::Json::SaxReader reader(&sink);
+	reader.addData(data);
+	reader.end();
+	return reader.errorMessage();
+}
+
+TEST_CASE("variants pick the alternative by the kind of value", "[Generated]") {
+	std::vector<Shapes> shapes;
+	REQUIRE(parse(R"([
+		{"shape": {"radius": 1.5}, "number": 2.5, "label": "a", "scale": 2},
+		{"shape": {"side": 2}, "number": 3, "label": true, "scale": {"x": 0.5}},
+		{"shape": {"side": 2, "rounded": true}, "number": -4, "label": [1, 2]}
+	])", &shapes) == "");
+	REQUIRE(shapes.size() == 3);
+
+	REQUIRE(shapes.at(0).shape().is<Circle>());
+	REQUIRE(shapes.at(0).shape().get<Circle>().radius() == 1.5);
+	REQUIRE(shapes.at(1).shape().is<Square>());
+	REQUIRE(shapes.at(1).shape().get<Square>().side() == 2.0);
+	REQUIRE(shapes.at(2).shape().get<Square>().rounded());
+
+	// integers are not turned into doubles if there is an alternative that takes them as they are
+	REQUIRE(shapes.at(0).number().is<double>());
+	REQUIRE(shapes.at(0).number().get<double>() == 2.5);
+	REQUIRE(shapes.at(1).number().is<int64_t>());
+	REQUIRE(shapes.at(1).number().get<int64_t>() == 3);
+	REQUIRE(shapes.at(2).number().get<int64_t>() == -4);
+
+	REQUIRE(shapes.at(0).label().get<std::string>() == "a");
+	REQUIRE(shapes.at(1).label().get<bool>());
+	REQUIRE(shapes.at(2).label().get<std::vector<int32_t>>() == std::vector<int32_t>({1, 2}));
+
+	// but they do go into a double if nothing else takes them
+	REQUIRE(shapes.at(0).scale().get<double>() == 2.0);
+	REQUIRE(shapes.at(1).scale().get<std::unordered_map<std::string, double>>().at("x") == 0.5);
+	REQUIRE_FALSE(shapes.at(2).has_scale());
+}
+
+TEST_CASE("variants reject values none of their alternatives take", "[Generated]") {
+	std::vector<Shapes> shapes;
+	REQUIRE(parse(R"([{"shape": {"radius": 1}, "number": "3"}])", &shapes) != "");
+	REQUIRE(parse(R"([{"shape": {"radius": 1}, "number": 3, "label": null}])", &shapes) != "");
+	REQUIRE(parse(R"([{"shape": {"radius": 1}, "number": 3, "label": 1.5}])", &shapes) != "");
+	REQUIRE(parse(R"([{"shape": {"edges": 4}, "number": 3}])", &shapes) != "");
+	REQUIRE(parse(R"([{"shape": [], "number": 3}])", &shapes) != "");
+	REQUIRE(shapes.empty());
+}
+
+// the entry that name is parsed into, or the error
+static std::string parseOpcode(const std::string &name, Opcode *opcode)
+{
+	const Runtime::HandleParseAction action = Runtime::handleParseString(*opcode, name);
+	return action.action == Runtime::HandleParseAction::Success ? std::string() : action.error;
+}
+
+TEST_CASE("enums are parsed by name", "[Generated]") {
+	Opcode opcode = Opcode::NOP;
+	const std::vector<std::pair<std::string, Opcode>> entries = {
+		{"LOAD", Opcode::LOAD}, {"LOOP", Opcode::LOOP}, {"LEAD", Opcode::LEAD}, {"READ", Opcode::READ}, {"ROAD", Opcode::ROAD},
+		{"MOVE", Opcode::MOVE}, {"JUMP", Opcode::JUMP}, {"NOP", Opcode::NOP}, {"STORE", Opcode::STORE}, {"STOLE", Opcode::STOLE}
+	};
+	for (const auto &entry : entries) {
+		INFO(entry.first);
+		REQUIRE(parseOpcode(entry.first, &opcode) == "");
+		REQUIRE(opcode == entry.second);
+	}
+
+	SECTION("names that only match the characters that are switched on") {
+		// LOAD vs. LOOP is decided by the third character, LOxD has to be compared in full after that
+		for (const std::string name : {"LOAP", "LEAP", "REAL", "ROAM", "MOVA", "JAMP", "STORK", "STALE", "NIP"}) {
+			INFO(name);
+			REQUIRE(parseOpcode(name, &opcode) == std::string("Invalid entry '") + name + "', expected one of 'LOAD', 'LOOP', 'LEAD', 'READ', 'ROAD', 'MOVE', 'JUMP', 'NOP', 'STORE', 'STOLE'");
+		}
+	}
+	SECTION("prefixes and extensions of names") {
+		for (const std::string name : {"", "L", "LO", "LOA", "LOADS", "NO", "NOPE", "STOR", "STORES", "load"}) {
+			INFO(name);
+			REQUIRE(parseOpcode(name, &opcode) != "");
+		}
+	}
+	SECTION("a failed parse keeps the previous value") {
+		REQUIRE(parseOpcode("JUMP", &opcode) == "");
+		REQUIRE(parseOpcode("JUMPS", &opcode) != "");
+		REQUIRE(opcode == Opcode::JUMP);
+	}
+}
+
+template <typename Type>
+static std::string write(const Type &value)
+{
+	Util::StringOutputStream stream;
+	Util::Json::SaxWriter writer(&stream);
+	Runtime::SaxSinkSerializer serializer(&writer);
+	value.serialize(&serializer);
+	REQUIRE_FALSE(serializer.hasFailed());
+	return stream.result();
+}
+
+TEST_CASE("kept unknown fields are written back as they were", "[Generated]") {
+	std::vector<Settings> settings;
+	REQUIRE(parse(R"([{"name": "a", "ratio": 12.5e3, "nested": {"x": [1, 2.50, "\u0041"]}}])", &settings) == "");
+	REQUIRE(settings.size() == 1);
+	REQUIRE(settings.at(0).unknownFields().size() == 2);
+
+	REQUIRE(write(settings.at(0)) == R"({"name":"a","ratio":12.5e3,"nested":{"x": [1, 2.50, "\u0041"]}})");
+}
+
+TEST_CASE("field masks select what is parsed and serialized", "[Generated]") {
+	const std::string data = R"([{"shape": {"side": 2, "rounded": true}, "number": 3, "label": "a"}])";
+
+	SECTION("everything") {
+		std::vector<Shapes> shapes;
+		REQUIRE(parse(data, &shapes) == "");
+		REQUIRE_FALSE(shapes.at(0).isProjected());
+		REQUIRE(write(shapes.at(0)) == R"({"shape":{"side":2.0,"rounded":true},"number":3,"label":"a"})");
+	}
+	SECTION("required fields that are not selected are neither required nor written") {
+		std::vector<Shapes> shapes;
+		REQUIRE(parse(R"([{"number": 3, "label": "a"}])", &shapes, Runtime::FieldMask({"number"})) == "");
+		REQUIRE(parse(data, &shapes, Runtime::FieldMask({"number"})) == "");
+		REQUIRE(shapes.size() == 2);
+		for (const Shapes &projected : shapes) {
+			REQUIRE(projected.isProjected());
+			REQUIRE_FALSE(projected.has_shape());
+			REQUIRE_FALSE(projected.has_label());
+			REQUIRE(write(projected) == R"({"number":3})");
+		}
+	}
+	SECTION("nested fields") {
+		std::vector<Shapes> shapes;
+		REQUIRE(parse(data, &shapes, Runtime::FieldMask({"shape.rounded", "number"})) == "");
+		// all required fields of the outer object are there, only the nested one is missing some
+		REQUIRE_FALSE(shapes.at(0).isProjected());
+		const Square square = shapes.at(0).shape().get<Square>();
+		REQUIRE(square.isProjected());
+		REQUIRE(square.rounded());
+		REQUIRE(write(shapes.at(0)) == R"({"shape":{"rounded":true},"number":3})");
+	}
+	SECTION("selecting all required fields is not a projection") {
+		std::vector<Shapes> shapes;
+		REQUIRE(parse(data, &shapes, Runtime::FieldMask({"shape", "number"})) == "");
+		REQUIRE_FALSE(shapes.at(0).isProjected());
+		REQUIRE(write(shapes.at(0)) == R"({"shape":{"side":2.0,"rounded":true},"number":3})");
+	}
+	SECTION("rebuilding gives a complete object") {
+		std::vector<Shapes> shapes;
+		REQUIRE(parse(data, &shapes, Runtime::FieldMask({"number"})) == "");
+		REQUIRE_FALSE(shapes.at(0).rebuild().build().isProjected());
+	}
+}
+
+TEST_CASE("enumerations are parsed from names and from values", "[Generated]") {
+	std::vector<Program> programs;
+	REQUIRE(parse(R"([{"opcode": "JUMP", "steps": ["LOAD", 3, "STOLE"]}, {"opcode": 6}])", &programs) == "");
+	REQUIRE(programs.size() == 2);
+	REQUIRE(programs.at(0).opcode() == Opcode::JUMP);
+	REQUIRE(programs.at(0).steps() == std::vector<Opcode>({Opcode::LOAD, Opcode::READ, Opcode::STOLE}));
+	REQUIRE(programs.at(1).opcode() == Opcode::JUMP);
+
+	REQUIRE(parse(R"([{"opcode": "JUMPS"}])", &programs) != "");
+	REQUIRE(parse(R"([{"opcode": 42}])", &programs) != "");
+}
+
+TEST_CASE("strings are verified against their regex and format", "[Generated]") {
+	std::vector<Contact> contacts;
+	REQUIRE(parse(R"([{"phone": "0123"}, {"phone": "42 \"home\"", "host": "192.168.0.1"}])", &contacts) == "");
+	REQUIRE(contacts.size() == 2);
+	REQUIRE(contacts.at(1).phone() == "42 \"home\"");
+	REQUIRE(contacts.at(1).host() == "192.168.0.1");
+
+	// the regex is inherited from the alias
+	REQUIRE(parse(R"([{"phone": "home"}])", &contacts).find("does not match") != std::string::npos);
+	REQUIRE(parse(R"([{"phone": "0123", "host": "192.168.0.256"}])", &contacts).find("'ipv4'") != std::string::npos);
+}
+
+TEST_CASE("members of default constructed values are value-initialized", "[Generated]") {
+	const Square square;
+	REQUIRE(square.side() == 0.0);
+	REQUIRE_FALSE(square.rounded());
+
+	const Program program = Program::Builder().build();
+	REQUIRE(program.opcode() == Opcode::LOAD);
+	REQUIRE(program.steps().empty());
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "generated/Shapes.arg.h"
+#include "Instrumentation.h"
+#include "SaxSink.h"
+#include "json/JsonSaxReader.h"
+#include "json/JsonValue.h"
+
+using namespace Argonauts;
+using namespace Argonauts::Util;
+
+TEST_CASE("counts reader statistics", "[Instrumentation]") {
+	Instrumentation::reset();
+
+	const std::string data = "{\"a\":[{\"b\":\"x\"},{\"c\":\"y\"}],\"d\":\"e\"}";
+	Json::Value value;
+	const std::unique_ptr<SaxSink> sink(Json::Value::parserSink(&value));
+	Json::SaxReader reader(sink.get());
+	reader.addData(data);
+	reader.end();
+	REQUIRE_FALSE(reader.isError());
+
+	const Instrumentation::Stats stats = Instrumentation::stats();
+#ifdef ARGONAUTS_INSTRUMENTATION
+	REQUIRE(stats.bytes == data.size());
+	// { a [ { b x } { c y } ] d e }, where a, b, c and d are keys
+	REQUIRE(stats.tokens == 15);
+	REQUIRE(stats.maxDepth == 3);
+#else
+	REQUIRE(stats.bytes == 0);
+	REQUIRE(stats.tokens == 0);
+	REQUIRE(stats.maxDepth == 0);
+#endif
+
+	Instrumentation::reset();
+	REQUIRE(Instrumentation::stats().bytes == 0);
+}
+
+TEST_CASE("counts the sinks of generated types", "[Instrumentation]") {
+	Instrumentation::reset();
+
+	std::vector<Shapes> shapes;
+	Runtime::ArrayStreamSink<Shapes> sink([&shapes](Shapes &&value) { shapes.push_back(std::move(value)); return true; });
+	Json::SaxReader reader(&sink);
+	reader.addData(R"([{"shape": {"radius": 1}, "number": 2, "label": [1]}, {"shape": {"side": 2}, "number": 3)");
+	// waiting for more input is not part of the time spent in the sinks, even though they are alive meanwhile
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	reader.addData("}]");
+	reader.end();
+	REQUIRE_FALSE(reader.isError());
+	REQUIRE(shapes.size() == 2);
+
+	const Instrumentation::Stats stats = Instrumentation::stats();
+#ifdef ARGONAUTS_INSTRUMENTATION
+	// per element the sinks of Shapes, of the variant and of Circle or Square, and one more for the list of labels
+	REQUIRE(stats.allocations == 7);
+	REQUIRE(stats.delegations == 7);
+	REQUIRE(stats.types.size() == 3);
+	REQUIRE(stats.types.at("Shapes").count == 2);
+	REQUIRE(stats.types.at("Circle").count == 1);
+	REQUIRE(stats.types.at("Square").count == 1);
+	// the time of a type includes its nested values
+	REQUIRE(stats.types.at("Shapes").nanoseconds >= stats.types.at("Circle").nanoseconds + stats.types.at("Square").nanoseconds);
+	REQUIRE(stats.types.at("Shapes").nanoseconds < 50000000);
+#else
+	REQUIRE(stats.allocations == 0);
+	REQUIRE(stats.delegations == 0);
+	REQUIRE(stats.types.empty());
+#endif
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include <sstream>
+#include <vector>
+
+#include "OutputStream.h"
+
+using namespace Argonauts::Util;
+
+TEST_CASE("buffers writes into chunks", "[OutputStream]") {
+	std::vector<std::string> chunks;
+	{
+		CallbackOutputStream stream([&chunks](const char *data, const std::size_t size) { chunks.emplace_back(data, size); return true; }, 4);
+		REQUIRE(stream.write("ab"));
+		REQUIRE(stream.write('c'));
+		REQUIRE(chunks.empty());
+		REQUIRE(stream.write("de"));
+		REQUIRE(chunks.size() == 1);
+		REQUIRE(chunks[0] == "abc");
+
+		SECTION("larger than the buffer") {
+			REQUIRE(stream.write("fghijk"));
+			REQUIRE(chunks.size() == 3);
+			REQUIRE(chunks[1] == "de");
+			REQUIRE(chunks[2] == "fghijk");
+		}
+		SECTION("flushed explicitly") {
+			REQUIRE(stream.flush());
+			REQUIRE(chunks.size() == 2);
+			REQUIRE(chunks[1] == "de");
+		}
+	}
+	REQUIRE(chunks.size() >= 2);
+}
+
+TEST_CASE("reports backpressure", "[OutputStream]") {
+	int calls = 0;
+	CallbackOutputStream stream([&calls](const char *, const std::size_t) { ++calls; return false; }, 2);
+	REQUIRE(stream.write("ab"));
+	REQUIRE_FALSE(stream.write("cd"));
+	REQUIRE(stream.hasFailed());
+	REQUIRE_FALSE(stream.write('e'));
+	REQUIRE_FALSE(stream.flush());
+	REQUIRE(calls == 1);
+}
+
+TEST_CASE("writes to std::ostream", "[OutputStream]") {
+	std::ostringstream out;
+	{
+		StdOutputStream stream(out, 3);
+		for (int i = 0; i < 10; ++i) {
+			REQUIRE(stream.write(std::to_string(i)));
+		}
+	}
+	REQUIRE(out.str() == "0123456789");
+}
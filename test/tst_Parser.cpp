@@ -0,0 +1,104 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include <algorithm>
+
+#include "tool/DataTypes.h"
+#include "Error.h"
+
+using namespace Argonauts;
+using namespace Argonauts::Tool;
+
+// line and column of the error of parsing data
+static std::pair<long, long> errorPosition(const std::string &data, std::string *message = nullptr)
+{
+	try {
+		lexAndParse(data, "test.arg");
+	} catch (Util::Error &e) {
+		if (message) {
+			*message = e.errorMessage();
+		}
+		return e.lineColumnFromDataAndOffset();
+	}
+	FAIL("no error for " << data);
+	return std::make_pair(-1l, -1l);
+}
+
+TEST_CASE("parses IDL files", "[Parser]") {
+	const File file = lexAndParse(R"(
+// a comment
+@doc("A color" " of something")
+enum Color<UInt8> {
+	Red = 1;
+	@hidden
+	Green = 2;
+}
+using Names = List<String>;
+struct Base {
+	a Int32;
+}
+@unknownFields("skip")
+struct Shape : Base {
+	@optional
+	@verification.oneOf("a", "b")
+	name String = 0;
+	points Map<String, List<Variant<Int32, Double>>> = 1;
+}
+)", "test.arg");
+	REQUIRE(file.enums.size() == 1);
+	REQUIRE(file.enums.front().name == "Color");
+	REQUIRE(file.enums.front().type == "UInt8");
+	REQUIRE(file.enums.front().entries.size() == 2);
+	REQUIRE(file.enums.front().entries.at(1).value.value == 2);
+	REQUIRE(file.enums.front().annotations.docBrief() == "A color of something");
+	REQUIRE(file.usings.size() == 1);
+	REQUIRE(file.usings.front().type->toString() == "List<String>");
+	REQUIRE(file.structs.size() == 2);
+	const Struct &shape = file.structs.at(1);
+	REQUIRE(shape.includes == "Base");
+	REQUIRE(shape.annotations.getString("unknownFields") == "skip");
+	REQUIRE(shape.members.size() == 2);
+	REQUIRE(shape.members.front().annotations.contains(Annotations::Keys::optional));
+	std::vector<std::string> oneOf = shape.members.front().annotations.getStrings("verification.oneOf");
+	std::sort(oneOf.begin(), oneOf.end());
+	REQUIRE(oneOf == std::vector<std::string>({"a", "b"}));
+	REQUIRE(shape.members.at(1).index.value == 1);
+	REQUIRE(shape.members.at(1).type->toString() == "Map<String, List<Variant<Int32, Double>>>");
+
+	REQUIRE(lexAndParse("", "empty.arg").structs.empty());
+}
+
+TEST_CASE("reports parse errors at the offending token", "[Parser]") {
+	std::string message;
+	REQUIRE(errorPosition("struct A { a String = ; }", &message) == std::make_pair(1l, 23l));
+	REQUIRE(message.find("Unexpected token SEMICOLON") != std::string::npos);
+	REQUIRE(errorPosition("struct A {\n\ta String = 0;\n}\n}") == std::make_pair(4l, 1l));
+	REQUIRE(errorPosition("enum E { A = 1; }") == std::make_pair(1l, 8l));
+	REQUIRE(errorPosition("struct A { a String = \"x\"; }", &message) == std::make_pair(1l, 23l));
+	REQUIRE(message.find("Unexpected token STRING (\"x\")") != std::string::npos);
+}
+
+TEST_CASE("reports a truncated file at its last token", "[Parser]") {
+	std::string message;
+	REQUIRE(errorPosition("struct A { a String = 0;\n", &message) == std::make_pair(1l, 24l));
+	REQUIRE(message.find("Unexpected end of file") != std::string::npos);
+	REQUIRE(errorPosition("struct A { a String = 0;") == std::make_pair(1l, 24l));
+	REQUIRE(errorPosition("struct") == std::make_pair(1l, 1l));
+	REQUIRE(errorPosition("@doc(\"x\")\n\n") == std::make_pair(1l, 9l));
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch.hpp>
+
+#include <vector>
+
+#include "runtime/PresenceMask.h"
+
+using namespace Argonauts::Runtime;
+
+template <std::size_t Bits>
+static std::vector<std::size_t> setBits(const PresenceMask<Bits> &mask)
+{
+	std::vector<std::size_t> out;
+	mask.forEach([&out](const std::size_t bit) { out.push_back(bit); });
+	return out;
+}
+
+TEST_CASE("sets, resets and tests bits", "[PresenceMask]") {
+	PresenceMask<130> mask;
+	REQUIRE(mask.count() == 0);
+	REQUIRE(mask.first() == 130);
+
+	for (const std::size_t bit : {0, 63, 64, 127, 128, 129}) {
+		mask.set(bit);
+	}
+	REQUIRE(mask.test(63));
+	REQUIRE(mask.test(64));
+	REQUIRE_FALSE(mask.test(65));
+	REQUIRE(mask.count() == 6);
+	REQUIRE(setBits(mask) == std::vector<std::size_t>({0, 63, 64, 127, 128, 129}));
+
+	mask.reset(0);
+	mask.reset(63);
+	REQUIRE(mask.first() == 64);
+	mask.reset(64);
+	mask.reset(127);
+	REQUIRE(mask.first() == 128);
+}
+
+TEST_CASE("combines masks across word boundaries", "[PresenceMask]") {
+	PresenceMask<100> a;
+	PresenceMask<100> b;
+	a.set(10);
+	a.set(70);
+	b.set(70);
+	b.set(99);
+
+	REQUIRE(setBits(a | b) == std::vector<std::size_t>({10, 70, 99}));
+	REQUIRE(setBits(a & b) == std::vector<std::size_t>({70}));
+	REQUIRE((a | b).containsAll(a));
+	REQUIRE((a | b).containsAll(b));
+	REQUIRE_FALSE(a.containsAll(b));
+	REQUIRE(a.containsAll(PresenceMask<100>()));
+
+	// the fields of b that are missing in a, like a required field that has not been parsed
+	REQUIRE((b & ~a).first() == 99);
+	REQUIRE((a & ~a).first() == 100);
+}
+
+TEST_CASE("complements only the bits of the mask", "[PresenceMask]") {
+	SECTION("in a single word") {
+		PresenceMask<3> mask;
+		mask.set(1);
+		REQUIRE(setBits(~mask) == std::vector<std::size_t>({0, 2}));
+		REQUIRE((~PresenceMask<3>()).count() == 3);
+	}
+	SECTION("in several words") {
+		PresenceMask<70> mask;
+		mask.set(0);
+		mask.set(64);
+		const PresenceMask<70> inverted = ~mask;
+		REQUIRE(inverted.count() == 68);
+		REQUIRE(inverted.first() == 1);
+		REQUIRE_FALSE(inverted.test(64));
+		REQUIRE(inverted.test(69));
+		REQUIRE((~inverted).count() == 2);
+		REQUIRE(setBits(~PresenceMask<70>()).back() == 69);
+	}
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include "generated/Program.arg.h"
+#include "runtime/Streaming.h"
+#include "util/json/JsonSaxReader.h"
+
+using namespace Argonauts;
+
+TEST_CASE("streams the elements of a top-level array", "[Streaming]") {
+	std::vector<Program> programs;
+	Runtime::ArrayStreamSink<Program> sink([&programs](Program &&program) { programs.push_back(std::move(program)); return true; });
+	Util::Json::SaxReader reader(&sink);
+	reader.addData(R"([{"opcode": "LOAD"}, {"opcode": "JUMP", "steps": ["MOVE", "NOP"]}, {"opcode": 8}])");
+	reader.end();
+	REQUIRE_FALSE(reader.isError());
+	REQUIRE(sink.count() == 3);
+	REQUIRE(programs.size() == 3);
+	REQUIRE(programs.at(1).opcode() == Opcode::JUMP);
+	REQUIRE(programs.at(1).steps() == std::vector<Opcode>({Opcode::MOVE, Opcode::NOP}));
+	REQUIRE(programs.at(2).opcode() == Opcode::STORE);
+}
+
+TEST_CASE("hands elements over by move", "[Streaming]") {
+	// longer than the small string optimization, so that a move keeps the buffer
+	const std::string first(100, 'a');
+	const std::string second(100, 'b');
+
+	std::vector<const std::string *> elements;
+	std::vector<std::string> taken;
+	Runtime::ArrayStreamSink<std::string> sink([&](std::string &&element) {
+		elements.push_back(&element);
+		const char *buffer = element.data();
+		taken.push_back(std::move(element));
+		REQUIRE(taken.back().data() == buffer);
+		return true;
+	});
+	Util::Json::SaxReader reader(&sink);
+	reader.addData("[\"" + first + "\",\"" + second + "\"]");
+	reader.end();
+	REQUIRE_FALSE(reader.isError());
+	REQUIRE(taken == std::vector<std::string>({first, second}));
+	// no copy on the way, every element is the one the sink has parsed into
+	REQUIRE(elements.size() == 2);
+	REQUIRE(elements.at(0) == elements.at(1));
+}
+
+TEST_CASE("stops when the callback fails", "[Streaming]") {
+	std::vector<int> received;
+	Runtime::ArrayStreamSink<int> sink([&received](int &&element) {
+		received.push_back(element);
+		return element != 2;
+	});
+	Util::Json::SaxReader reader(&sink);
+	reader.addData("[1, 2, 3, 4]");
+	reader.end();
+	REQUIRE(reader.isError());
+	REQUIRE(reader.errorMessage() == "Stopped after element 2");
+	REQUIRE(received == std::vector<int>({1, 2}));
+	REQUIRE(sink.count() == 2);
+}
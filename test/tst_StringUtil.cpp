@@ -39,6 +39,7 @@ TEST_CASE("can split a string", "[StringUtil]") {
 	REQUIRE(String::splitStrings("asdf;bdeaf", ";") == std::vector<std::string>({"asdf", "bdeaf"}));
 	REQUIRE(String::splitStrings("asdf;bdeaf;foo", ";") == std::vector<std::string>({"asdf", "bdeaf", "foo"}));
 	REQUIRE(String::splitStrings("asdf;bdeaf;;foo;", ";") == std::vector<std::string>({"asdf", "bdeaf", "", "foo", ""}));
+	REQUIRE(String::splitStrings("a::b::c", "::") == std::vector<std::string>({"a", "b", "c"}));
 }
 
 TEST_CASE("can replace all in strings", "[StringUtil]") {
@@ -68,3 +69,30 @@ TEST_CASE("can check endsWith", "[StringUtil]") {
 	REQUIRE(String::endsWith("asdf", "df"));
 	REQUIRE_FALSE(String::endsWith("asdf", "sd"));
 }
+
+TEST_CASE("can hash content", "[StringUtil]") {
+	REQUIRE(String::contentHash("") == 0xcbf29ce484222325ull);
+	REQUIRE(String::contentHash("a") == 0xaf63dc4c8601ec8cull);
+	REQUIRE(String::contentHash("foobar") == 0x85944171f73967e8ull);
+	REQUIRE(String::toHexString(0x0123456789abcdefull) == "0123456789abcdef");
+}
+
+TEST_CASE("can validate UTF-8", "[StringUtil]") {
+	REQUIRE(String::isValidUtf8(""));
+	REQUIRE(String::isValidUtf8("plain ASCII that is longer than a word"));
+	REQUIRE(String::isValidUtf8("gr\xc3\xbc\xc3\x9f" "e \xe2\x82\xac \xf0\x9f\x98\x80 after a longer ASCII run"));
+	REQUIRE_FALSE(String::isValidUtf8("a long ASCII prefix then \xc3"));
+	REQUIRE_FALSE(String::isValidUtf8("\xc0\xaf")); // overlong
+	REQUIRE_FALSE(String::isValidUtf8("\xed\xa0\x80")); // surrogate
+	REQUIRE_FALSE(String::isValidUtf8("\xf4\x90\x80\x80")); // above U+10FFFF
+	REQUIRE_FALSE(String::isValidUtf8("\xe2\x82" "a"));
+}
+
+TEST_CASE("can encode UTF-8", "[StringUtil]") {
+	std::string out;
+	String::appendUtf8(out, 'a');
+	String::appendUtf8(out, 0xfc);
+	String::appendUtf8(out, 0x20ac);
+	String::appendUtf8(out, 0x1f600);
+	REQUIRE(out == "a\xc3\xbc\xe2\x82\xac\xf0\x9f\x98\x80");
+}
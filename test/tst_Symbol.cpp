@@ -0,0 +1,56 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include <unordered_set>
+
+#include "tool/Symbol.h"
+#include "util/ThreadUtil.h"
+
+using namespace Argonauts;
+using namespace Argonauts::Tool;
+
+TEST_CASE("symbols with the same text are the same", "[Symbol]") {
+	REQUIRE(Symbol("tst_Symbol.a") == Symbol("tst_Symbol.a"));
+	REQUIRE(Symbol("tst_Symbol.a") != Symbol("tst_Symbol.b"));
+	REQUIRE(Symbol("tst_Symbol.a").string() == "tst_Symbol.a");
+	REQUIRE(Symbol::find("tst_Symbol.a") == Symbol("tst_Symbol.a"));
+	REQUIRE(Symbol::find("tst_Symbol.never interned").empty());
+	REQUIRE(Symbol(std::string()) == Symbol());
+	REQUIRE(Symbol::find(std::string()) == Symbol());
+	REQUIRE(Symbol().id() == 0);
+}
+
+TEST_CASE("symbols can be interned from several threads", "[Symbol]") {
+	const std::size_t count = 2000;
+	// every string is interned by several threads at once
+	std::vector<Symbol> symbols(count * 4);
+	Util::Thread::parallelFor(symbols.size(), 4, [&symbols](const std::size_t index) {
+		symbols[index] = Symbol("tst_Symbol.threaded." + std::to_string(index % count));
+	});
+
+	std::unordered_set<uint32_t> ids;
+	for (std::size_t i = 0; i < count; ++i) {
+		REQUIRE(symbols[i] == symbols[i + count]);
+		REQUIRE(symbols[i] == symbols[i + count * 3]);
+		REQUIRE(symbols[i].string() == "tst_Symbol.threaded." + std::to_string(i));
+		REQUIRE_FALSE(symbols[i].empty());
+		ids.insert(symbols[i].id());
+	}
+	REQUIRE(ids.size() == count);
+}
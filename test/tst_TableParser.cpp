@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <catch.hpp>
+
+#include "common/Lexer.h"
+#include "common/Token.h"
+#include "grammar/Lists.grammar.h"
+
+using namespace Argonauts;
+using namespace Argonauts::Common;
+using namespace Argonauts::Testing;
+
+namespace {
+// sums up the numbers, and records the actions of the reductions and the offsets of unexpected tokens
+class ListsHandler : public TableParser::Handler
+{
+public:
+	explicit ListsHandler(const TokenList &tokens) : m_tokens(tokens) {}
+
+	std::vector<int64_t> values;
+	std::string actions;
+	std::vector<int> unexpectedOffsets;
+
+	void shift(const Token &token) override
+	{
+		values.push_back(token.type == Token::Integer ? m_tokens.integer(token) : 0);
+	}
+	void reduce(const int action, const int length) override
+	{
+		int64_t sum = 0;
+		for (int i = 0; i < length; ++i) {
+			sum += values.back();
+			values.pop_back();
+		}
+		values.push_back(sum);
+		switch (action) {
+		case ListsGrammar::EmptyList: actions += 'E'; break;
+		case ListsGrammar::List: actions += 'L'; break;
+		case ListsGrammar::Number: actions += 'N'; break;
+		default: break;
+		}
+	}
+	void unexpected(const Token &token) override
+	{
+		unexpectedOffsets.push_back(token.offset);
+	}
+
+private:
+	const TokenList &m_tokens;
+};
+
+struct Parsed
+{
+	bool accepted;
+	int64_t sum;
+	std::string actions;
+	std::vector<int> unexpectedOffsets;
+};
+Parsed parse(const std::string &data)
+{
+	const TokenList tokens = Lexer().consume(data, "<test>");
+	ListsHandler handler(tokens);
+	TableParser parser(ListsGrammar::tables());
+	parser.consume(tokens.tokens(), &handler);
+	return Parsed{parser.isAccepted(), handler.values.empty() ? 0 : handler.values.front(), handler.actions, handler.unexpectedOffsets};
+}
+}
+
+TEST_CASE("accepts what the grammar describes", "[TableParser]") {
+	const Parsed nested = parse("(1, (2, 3), ())");
+	REQUIRE(nested.accepted);
+	REQUIRE(nested.unexpectedOffsets.empty());
+	REQUIRE(nested.sum == 6);
+	// reductions happen bottom up, from left to right
+	REQUIRE(nested.actions == "NNNLEL");
+
+	const Parsed commented = parse("( // a comment\n 4 // another one\n)");
+	REQUIRE(commented.accepted);
+	REQUIRE(commented.sum == 4);
+	REQUIRE(commented.actions == "NL");
+}
+
+TEST_CASE("reports unexpected tokens at their offset", "[TableParser]") {
+	// the parser skips the offending token and continues
+	const Parsed missingComma = parse("(1 2)");
+	REQUIRE(missingComma.unexpectedOffsets == std::vector<int>({3}));
+	REQUIRE(missingComma.accepted);
+	REQUIRE(missingComma.sum == 1);
+	REQUIRE(parse("(1, ,2)").unexpectedOffsets == std::vector<int>({4}));
+
+	// tokens that are not part of the grammar at all
+	REQUIRE(parse("(1, struct)").unexpectedOffsets.front() == 4);
+
+	const Parsed truncated = parse("(1, (2");
+	REQUIRE_FALSE(truncated.accepted);
+	REQUIRE(truncated.unexpectedOffsets.size() == 1);
+	REQUIRE(truncated.unexpectedOffsets.front() >= 6);
+
+	// nothing is accepted after the end
+	REQUIRE(parse("() ()").unexpectedOffsets.size() >= 1);
+}
+
+TEST_CASE("resumes parsing from a saved stack", "[TableParser]") {
+	const std::string data = "((1, 2), (3))";
+	const TokenList tokens = Lexer().consume(data, "<test>");
+	ListsHandler handler(tokens);
+
+	TableParser first(ListsGrammar::tables());
+	const std::size_t half = tokens.tokens().size() / 2;
+	for (std::size_t i = 0; i < half; ++i) {
+		first.consume(tokens.tokens().at(i), &handler);
+	}
+	REQUIRE_FALSE(first.isAccepted());
+
+	TableParser second(ListsGrammar::tables());
+	second.setStack(first.stack());
+	for (std::size_t i = half; i < tokens.tokens().size(); ++i) {
+		second.consume(tokens.tokens().at(i), &handler);
+	}
+	REQUIRE(second.isAccepted());
+	REQUIRE(handler.values.front() == 6);
+	REQUIRE(handler.actions == "NNLNLL");
+	REQUIRE(handler.unexpectedOffsets.empty());
+}
@@ -140,3 +140,53 @@ TEST_CASE("can modify value in-place", "[Variant]") {
 	third.get<std::string>().append("asdf");
 	REQUIRE(third.get<std::string>() == "asdfasdf");
 }
+
+TEST_CASE("can visit", "[Variant]") {
+	struct Describe
+	{
+		std::string operator()(const char c) const { return std::string("char ") + c; }
+		std::string operator()(const int64_t i) const { return "int " + std::to_string(i); }
+		std::string operator()(const std::string &s) const { return "string " + s; }
+	};
+	REQUIRE(Type(char('a')).visit(Describe()) == "char a");
+	REQUIRE(Type(int64_t(12)).visit(Describe()) == "int 12");
+	const Type string(std::string("asdf"));
+	REQUIRE(string.visit(Describe()) == "string asdf");
+	REQUIRE(string.which() == 2);
+
+	Type value(int64_t(1));
+	value.visit([](auto &v) { v = v + v; });
+	REQUIRE(value.get<int64_t>() == 2);
+}
+
+TEST_CASE("default constructs the first alternative", "[Variant]") {
+	Type value;
+	REQUIRE(value.is<char>());
+	REQUIRE(value.get<char>() == char(0));
+}
+
+TEST_CASE("can move assign", "[Variant]") {
+	Type value(std::string("a string that is long enough to not fit into the small string buffer"));
+	Type other(std::string("short"));
+	other = std::move(value);
+	REQUIRE(other.get<std::string>() == "a string that is long enough to not fit into the small string buffer");
+	other = Type(int64_t(5));
+	REQUIRE(other.get<int64_t>() == 5);
+	other = Type(std::string("short"));
+	REQUIRE(other.get<std::string>() == "short");
+}
+
+TEST_CASE("copies trivial alternatives", "[Variant]") {
+	using Trivial = Variant<int64_t, bool, double>;
+	static_assert(std::is_nothrow_move_constructible<Trivial>::value, "trivial variants should be nothrow movable");
+	const Trivial first(int64_t(42));
+	Trivial second(1.5);
+	Trivial copy(first);
+	REQUIRE(copy.get<int64_t>() == 42);
+	REQUIRE(copy == first);
+	REQUIRE(copy != second);
+	copy = second;
+	REQUIRE(copy.get<double>() == 1.5);
+	copy = Trivial(true);
+	REQUIRE(copy.get<bool>());
+}
@@ -20,10 +20,13 @@
 #include <sstream>
 #include <fstream>
 #include <iomanip>
+#include <unordered_set>
 
 #include "util/OsUtil.h"
 #include "util/TermUtil.h"
 #include "util/FSUtil.h"
+#include "util/ThreadUtil.h"
+#include "util/Error.h"
 #include "common/Lexer.h"
 #include "Parser.h"
 #include "DataTypes.h"
@@ -47,7 +50,8 @@ void Compiler::setup(Util::CLI::ParserBuilder::Ptr &builder)
 {
 	builder->addSubcommand({"compile", "c"}, "Compiles Argonaut files to language-specific code")->setup([this](Util::CLI::Subcommand::Ptr &cmd)
 	{
-		cmd->withPositionalArgument("file", "The input file to compile")->applyTo(this, &Compiler::input);
+		cmd->withPositionalArgument("file", "The input files to compile", Util::CLI::Subcommand::Repeatable)->applyTo(this, &Compiler::inputs);
+		cmd->addOption({"jobs", "j"}, "How many threads to use (default: one per core)")->withRequiredArg("N")->applyTo(this, &Compiler::jobs);
 		cmd->addOption({"list-languages"}, "List available language compilers")->then(this, &Compiler::listCompilers)->makeEarlyExit();
 		for (AbstractCompiler *compiler : m_compilers)
 		{
@@ -60,10 +64,50 @@ void Compiler::setup(Util::CLI::ParserBuilder::Ptr &builder)
 	});
 }
 
+// files can not reference each other, so each one is parsed and resolved on its own before they are combined
+static File mergeFiles(const std::vector<File> &files)
+{
+	File out;
+	std::unordered_set<std::string> names;
+	for (const File &file : files) {
+		for (const std::string &name : file.definedTypes()) {
+			if (!names.insert(name).second) {
+				throw Util::Exception(std::string("'") + name + "' is defined in more than one input file");
+			}
+		}
+		out.structs.insert(out.structs.end(), file.structs.begin(), file.structs.end());
+		out.enums.insert(out.enums.end(), file.enums.begin(), file.enums.end());
+		out.usings.insert(out.usings.end(), file.usings.begin(), file.usings.end());
+	}
+	return out;
+}
+
 bool Compiler::run(const Util::CLI::Parser &parser, AbstractCompiler *compiler)
 {
-	const File file = lexAndParse(Util::FS::readFile(input), input, compiler->resolverFlags());
-	return compiler->run(parser, file);
+	std::vector<File> files(inputs.size());
+	std::vector<std::string> errors(inputs.size());
+	Util::Thread::parallelFor(inputs.size(), jobs, [this, compiler, &files, &errors](const std::size_t i)
+	{
+		try {
+			files[i] = lexAndParse(Util::FS::readFile(inputs[i]), inputs[i], compiler->resolverFlags());
+		} catch (Util::Error &error) {
+			errors[i] = error.errorMessage();
+		}
+	});
+
+	bool haveError = false;
+	for (const std::string &error : errors) {
+		if (!error.empty()) {
+			std::cerr << Util::Term::fg(Util::Term::Red, error) << std::endl;
+			haveError = true;
+		}
+	}
+	if (haveError) {
+		return false;
+	}
+
+	compiler->setJobs(jobs);
+	return compiler->run(parser, files.size() == 1 ? files.front() : mergeFiles(files));
 }
 
 Util::CLI::Execution Compiler::listCompilers(const Util::CLI::Parser &)
@@ -32,7 +32,8 @@ class Compiler
 public:
 	explicit Compiler();
 
-	std::string input;
+	std::vector<std::string> inputs;
+	int jobs = 0; ///< Number of threads to use, 0 for one per core
 
 	void setup(Util::CLI::ParserBuilder::Ptr &builder);
 	bool run(const Util::CLI::Parser &parser, AbstractCompiler *compiler);
@@ -26,9 +26,29 @@
 namespace Argonauts {
 namespace Tool {
 
+Type::Builtin Type::builtinFor(const std::string &name)
+{
+	// the length narrows it down to a handful of candidates
+	switch (name.size()) {
+	case 3:
+		return name == "Map" ? Map : UserDefined;
+	case 4:
+		return name == "Int8" ? Int8 : name == "Bool" ? Bool : name == "List" ? List : UserDefined;
+	case 5:
+		return name == "Int16" ? Int16 : name == "Int32" ? Int32 : name == "Int64" ? Int64 : name == "UInt8" ? UInt8 : UserDefined;
+	case 6:
+		return name == "UInt16" ? UInt16 : name == "UInt32" ? UInt32 : name == "UInt64" ? UInt64 :
+			   name == "Double" ? Double : name == "String" ? String : UserDefined;
+	case 7:
+		return name == "Variant" ? Variant : UserDefined;
+	default:
+		return UserDefined;
+	}
+}
+
 std::vector<std::string> Type::namesRecursive() const
 {
-	std::vector<std::string> out = {name};
+	std::vector<std::string> out = {name.value};
 	for (const Type::Ptr &ptr : templateArguments) {
 		const std::vector<std::string> n = ptr->namesRecursive();
 		std::copy(n.begin(), n.end(), std::back_inserter(out));
@@ -38,7 +58,7 @@ std::vector<std::string> Type::namesRecursive() const
 std::vector<Type::Ptr> Type::allOfTypeRecursive(const Type::Ptr &self, const std::string &type) const
 {
 	std::vector<Type::Ptr> out;
-	if (name == type) {
+	if (name.value.string() == type) {
 		out.push_back(self);
 	}
 	for (const Type::Ptr &child : templateArguments) {
@@ -58,7 +78,7 @@ std::vector<Type::Ptr> Type::allRecursive(const Type::Ptr &self) const
 }
 bool Type::compare(const Type::Ptr &other) const
 {
-	if (name != other->name || templateArguments.size() != other->templateArguments.size()) {
+	if (builtin != other->builtin || name != other->name || container != other->container || templateArguments.size() != other->templateArguments.size()) {
 		return false;
 	}
 	for (std::size_t i = 0; i < templateArguments.size(); ++i) {
@@ -71,7 +91,7 @@ bool Type::compare(const Type::Ptr &other) const
 
 std::string Type::toString() const
 {
-	std::string out = name;
+	std::string out = name.value;
 	if (!templateArguments.empty()) {
 		std::vector<std::string> children;
 		for (const auto &child : templateArguments) {
@@ -104,31 +124,48 @@ std::vector<Type::Ptr> Struct::allTypes() const
 	return types;
 }
 
-std::string Annotations::getString(const std::string &name, const std::string &def) const
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+const Symbol Annotations::Keys::doc("doc");
+const Symbol Annotations::Keys::docBrief("doc.brief");
+const Symbol Annotations::Keys::docExtended("doc.extended");
+const Symbol Annotations::Keys::hidden("hidden");
+const Symbol Annotations::Keys::optional("optional");
+const Symbol Annotations::Keys::unknownFields("unknownFields");
+const Symbol Annotations::Keys::variantSelectBy("variant.selectBy");
+const Symbol Annotations::Keys::verificationRegex("verification.regex");
+const Symbol Annotations::Keys::verificationFormat("verification.format");
+const Symbol Annotations::Keys::cppContainer("cpp.container");
+const Symbol Annotations::Keys::cppInlineCapacity("cpp.inlineCapacity");
+const Symbol Annotations::Keys::cppHot("cpp.hot");
+const Symbol Annotations::Keys::cppCold("cpp.cold");
+const Symbol Annotations::Keys::cppColumns("cpp.columns");
+#pragma clang diagnostic pop
+
+std::string Annotations::getString(const Symbol &name, const std::string &def) const
 {
-	if (!contains(name)) {
+	const auto it = values.find(name);
+	if (it == values.end()) {
 		return def;
-	}
-	const Value value = values.find(name)->second;
-	if (value.is<PositionedInt64>()) {
-		return std::to_string(value.get<PositionedInt64>());
+	} else if (it->second.is<PositionedInt64>()) {
+		return std::to_string(it->second.get<PositionedInt64>());
 	} else {
-		return value.get<PositionedString>();
+		return it->second.get<PositionedString>();
 	}
 }
-std::vector<std::string> Annotations::getStrings(const std::string &name) const
+std::vector<std::string> Annotations::getStrings(const Symbol &name) const
 {
 	std::vector<std::string> out;
-	for (const auto &pair : values) {
-		if (pair.first == name) {
-			out.push_back(pair.second.get<PositionedString>());
-		}
+	const auto range = values.equal_range(name);
+	for (auto it = range.first; it != range.second; ++it) {
+		out.push_back(it->second.get<PositionedString>());
 	}
 	return out;
 }
-int64_t Annotations::getInt(const std::string &name) const
+int64_t Annotations::getInt(const Symbol &name) const
 {
-	return contains(name) ? values.find(name)->second.get<PositionedInt64>().value : -1;
+	const auto it = values.find(name);
+	return it != values.end() ? it->second.get<PositionedInt64>().value : -1;
 }
 
 File lexAndParse(const std::string &data, const std::string &filename, const int flags)
@@ -141,6 +178,9 @@ File lexAndParse(const std::string &data, const std::string &filename, const int
 		if (flags & ResolveIncludes) {
 			resolver.resolveIncludes();
 		}
+		if (flags & VerifyAnnotations) {
+			resolver.verifyAnnotations();
+		}
 		return resolver.result();
 	} catch (Parser::ParserException &e) {
 		throw Util::Error(e.what(), e.offset, Util::Error::Source(data, filename));
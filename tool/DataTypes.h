@@ -22,6 +22,7 @@
 #include <unordered_map>
 
 #include "util/Variant.h"
+#include "Symbol.h"
 
 namespace Argonauts {
 namespace Tool {
@@ -40,10 +41,11 @@ struct PositionedValue
 	bool operator==(const T &other) const { return value == other; }
 	bool operator!=(const T &other) const { return value != other; }
 	bool operator==(const PositionedValue<T> &other) const { return value == other.value; }
-	bool operator!=(const PositionedValue<T> &other) const { return value == other.value; }
+	bool operator!=(const PositionedValue<T> &other) const { return value != other.value; }
 };
 using PositionedString = PositionedValue<std::string>;
 using PositionedInt64 = PositionedValue<int64_t>;
+using PositionedSymbol = PositionedValue<Symbol>;
 }
 }
 template <typename T>
@@ -61,6 +63,14 @@ struct hash<Argonauts::Tool::PositionedString>
 		return std::hash<std::string>()(string.value);
 	}
 };
+template <>
+struct hash<Argonauts::Tool::PositionedSymbol>
+{
+	std::size_t operator()(const Argonauts::Tool::PositionedSymbol &symbol) const
+	{
+		return symbol.value.id();
+	}
+};
 inline std::string to_string(const Argonauts::Tool::PositionedString &str) { return str.value; }
 }
 
@@ -71,43 +81,81 @@ struct Annotations
 {
 	using Value = Util::Variant<PositionedString, PositionedInt64>;
 
-	std::unordered_multimap<PositionedString, Value> values;
+	std::unordered_multimap<PositionedSymbol, Value> values;
 
-	bool contains(const std::string &name) const { return values.find(name) != values.end(); }
-	std::string getString(const std::string &name, const std::string &def = std::string()) const;
-	std::vector<std::string> getStrings(const std::string &name) const;
-	int64_t getInt(const std::string &name) const;
+	/// The annotations the tool itself looks at, interned once so that looking them up does not go to the symbol table
+	struct Keys
+	{
+		static const Symbol doc, docBrief, docExtended;
+		static const Symbol hidden, optional, unknownFields, variantSelectBy, verificationRegex, verificationFormat;
+		static const Symbol cppContainer, cppInlineCapacity, cppHot, cppCold, cppColumns;
+	};
+
+	bool contains(const Symbol &name) const { return values.find(name) != values.end(); }
+	std::string getString(const Symbol &name, const std::string &def = std::string()) const;
+	std::vector<std::string> getStrings(const Symbol &name) const;
+	int64_t getInt(const Symbol &name) const;
+
+	// for other names, these have to look them up in the symbol table first. names that have never been interned can
+	// not be the name of any annotation
+	bool contains(const std::string &name) const { return contains(Symbol::find(name)); }
+	std::string getString(const std::string &name, const std::string &def = std::string()) const { return getString(Symbol::find(name), def); }
+	std::vector<std::string> getStrings(const std::string &name) const { return getStrings(Symbol::find(name)); }
+	int64_t getInt(const std::string &name) const { return getInt(Symbol::find(name)); }
 
 	// convenience: doc.*
-	bool hasDocumentation() const { return contains("doc") || contains("doc.brief"); }
-	std::string docBrief() const { return getString(contains("doc.brief") ? "doc.brief" : "doc"); }
-	std::string docExtended() const { return getString("doc.extended"); }
+	bool hasDocumentation() const { return contains(Keys::doc) || contains(Keys::docBrief); }
+	std::string docBrief() const { return getString(contains(Keys::docBrief) ? Keys::docBrief : Keys::doc); }
+	std::string docExtended() const { return getString(Keys::docExtended); }
 };
 
 struct Type
 {
 	using Ptr = std::shared_ptr<Type>;
 
+	enum Builtin : uint8_t
+	{
+		UserDefined,
+		Int8, Int16, Int32, Int64,
+		UInt8, UInt16, UInt32, UInt64,
+		Double,
+		Bool,
+		String,
+		List,
+		Map,
+		Variant
+	};
+	static Builtin builtinFor(const std::string &name);
+	static bool isInteger(const Builtin builtin)
+	{
+		switch (builtin) {
+		case Int8: case Int16: case Int32: case Int64:
+		case UInt8: case UInt16: case UInt32: case UInt64:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	bool isInteger() const
 	{
-		return name == "Int8" || name == "Int16" || name == "Int32" || name == "Int64" ||
-				name == "UInt8" || name == "UInt16" || name == "UInt32" || name == "UInt64";
+		return isInteger(builtin);
 	}
 	bool isSimple() const
 	{
-		return isInteger() || name == "String" || name == "Double" || name == "Bool";
+		return builtin != UserDefined && !isTemplateable();
 	}
 	bool isBuiltin() const
 	{
-		return isSimple() || name == "List" || name == "Variant" || name == "Map";
+		return builtin != UserDefined;
 	}
 	bool isObjectish() const
 	{
-		return !isSimple() && name != "List" && name != "Variant";
+		return builtin == UserDefined || builtin == Map;
 	}
 	bool isTemplateable() const
 	{
-		return name == "List" || name == "Variant" || name == "Map";
+		return builtin == List || builtin == Map || builtin == Variant;
 	}
 	bool isTemplated() const
 	{
@@ -122,12 +170,18 @@ struct Type
 
 	std::string toString() const;
 
-	PositionedString name;
+	PositionedSymbol name; ///< Interned, the same few type names come up over and over again
+	Builtin builtin; ///< Derived from name, keep in sync using setName
 	std::vector<Type::Ptr> templateArguments;
+	/// Container to use for a List or Map instead of the default one, like "deque" or "small_vector<8>". Set by
+	/// compilers from their annotations, empty otherwise
+	std::string container;
+
+	void setName(const PositionedSymbol &name_) { name = name_; builtin = builtinFor(name_.value); }
 
-	explicit Type(const PositionedString &name_, std::vector<Type::Ptr> &&args) : name(name_), templateArguments(std::forward<std::vector<Type::Ptr>>(args)) {}
+	explicit Type(const PositionedSymbol &name_, std::vector<Type::Ptr> &&args) : name(name_), builtin(builtinFor(name_.value)), templateArguments(std::forward<std::vector<Type::Ptr>>(args)) {}
 	template <typename... Args>
-	static Type::Ptr create(const PositionedString &name, Args &&... args) { return std::make_shared<Type>(name, std::vector<Type::Ptr>({std::forward<std::vector<Type::Ptr>>(args)...})); }
+	static Type::Ptr create(const PositionedSymbol &name, Args &&... args) { return std::make_shared<Type>(name, std::vector<Type::Ptr>({std::forward<std::vector<Type::Ptr>>(args)...})); }
 };
 
 struct Attribute
@@ -191,7 +245,8 @@ enum LexAndParseFlags
 {
 	NoFlags = 0x0,
 	ResolveAliases = 0x1,
-	ResolveIncludes = 0x2
+	ResolveIncludes = 0x2,
+	VerifyAnnotations = 0x4
 };
 File lexAndParse(const std::string &data, const std::string &filename, const int flags = 0);
 
@@ -16,13 +16,14 @@
 
 #include "Parser.h"
 
-#include <algorithm>
 #include <iostream>
+#include <unordered_set>
 
+#include "util/Arena.h"
 #include "util/Util.h"
 #include "util/Error.h"
-#include "util/StringUtil.h"
-#include "common/GeneralParser.h"
+#include "common/TableParser.h"
+#include "common/grammar/Idl.grammar.h"
 #include "DataTypes.h"
 
 namespace Argonauts {
@@ -30,217 +31,213 @@ namespace Tool {
 using namespace Util;
 using namespace Common;
 
-inline PositionedString positionedStringFromToken(const Token &token)
+Parser::Parser(TokenList &&tokens)
+	: m_tokens(std::move(tokens))
 {
-	return PositionedString{token.string(), token.offset, token.length};
 }
-inline PositionedInt64 positionedIntFromToken(const Token &token)
+Parser::Parser(const TokenList &tokens)
+	: m_tokens(tokens)
 {
-	return PositionedInt64{token.integer(), token.offset, token.length};
 }
 
-Parser::Parser(const std::vector<Token> &tokens)
-	: m_tokens(tokens)
+namespace {
+// the end of file token is behind the last character, errors at it are reported at the last token before it instead
+int endOfFileOffset(const std::vector<Token> &tokens)
 {
+	for (auto it = tokens.rbegin(); it != tokens.rend(); ++it) {
+		if (it->type != Token::EndOfFile) {
+			return it->offset;
+		}
+	}
+	return 0;
 }
 
-File Parser::process()
+// builds a File while the table driven parser reduces the grammar in common/Idl.grammar
+class FileBuilder : public TableParser::Handler
 {
-	File file;
-	Annotations annotations;
-	PositionedString lastDefinedAnnotation;
-
-	auto defineStruct = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
-	{
-		file.structs.push_back(Struct{PositionedString(), positionedStringFromToken(stack.at(stack.size() - 1)), {}, annotations});
-		annotations.values.clear();
-		return GeneralParser::defineStruct(token, stack);
-	};
-	auto defineStructWithInclude = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
+	struct Value
 	{
-		file.structs.push_back(Struct{positionedStringFromToken(stack.at(stack.size() - 1)), positionedStringFromToken(stack.at(stack.size() - 3)), {}, annotations});
-		annotations.values.clear();
-		return GeneralParser::defineStructWithInclude(token, stack);
+		Token token;
+		Type::Ptr type;
 	};
-	auto defineEnum = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
-	{
-		file.enums.push_back(Enum{positionedStringFromToken(stack.at(stack.size() - 4)), positionedStringFromToken(stack.at(stack.size() - 2)), {}, annotations});
-		annotations.values.clear();
-		return GeneralParser::defineEnum(token, stack);
-	};
-	auto defineUsing = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
-	{
-		file.usings.push_back(Using{positionedStringFromToken(stack.at(stack.size() - 3)), stack.at(stack.size() - 1).getRawData<Type>(), annotations});
-		annotations.values.clear();
-		return GeneralParser::defineUsing(token, stack);
-	};
-	auto defineAnnotation = [&annotations, &lastDefinedAnnotation](const Token &token, const std::vector<Token> &stack)
-	{
-		annotations.values.insert({positionedStringFromToken(token), Annotations::Value(PositionedString())});
-		lastDefinedAnnotation = token.string();
-		return GeneralParser::defineAnnotation(token, stack);
-	};
-	auto addToAnnotation = [&file, &annotations, &lastDefinedAnnotation](const Token &token, const std::vector<Token> &stack)
-	{
-		PositionedString name;
-		Annotations::Value value = PositionedString();
-		if (stack.at(stack.size() - 2).type == Token::Equal) {
-			name = positionedStringFromToken(stack.at(stack.size() - 3));
-			name = PositionedString(lastDefinedAnnotation.value + '.' + name.value, name.offset, name.length);
-			const Token valueToken = stack.back();
-			if (valueToken.type == Token::Integer) {
-				value = positionedIntFromToken(valueToken);
-			} else {
-				value = positionedStringFromToken(valueToken);
-			}
-		} else {
-			name = lastDefinedAnnotation;
-			if (stack.back().type == Token::Integer) {
-				value = positionedIntFromToken(stack.back());
-			} else {
-				value = positionedStringFromToken(stack.back());
-			}
-		}
+	std::vector<Value> m_values;
+	const TokenList &m_tokens;
 
-		annotations.values.erase(lastDefinedAnnotation);
-		annotations.values.insert({name, value});
-		return GeneralParser::addToAnnotation(token, stack);
-	};
-	auto defineEnumEntry = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
-	{
-		const PositionedString name = positionedStringFromToken(stack.at(stack.size() - 3));
-		const PositionedInt64 index = positionedIntFromToken(stack.at(stack.size() - 1));
-		file.enums.back().entries.push_back(EnumEntry{name, index, annotations});
-		annotations.values.clear();
-		return GeneralParser::defineEnumEntry(token, stack);
-	};
-	auto defineStructAttribute = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
+	Annotations m_annotations; ///< Annotations for the next definition
+	PositionedSymbol m_lastDefinedAnnotation;
+	std::unordered_set<Symbol> m_definedTypes;
+	// all types of a file are allocated together, they keep the arena alive as long as any of them is used
+	const std::shared_ptr<Util::Arena<Type>> m_types = std::make_shared<Util::Arena<Type>>();
+
+	const Value &value(const int fromTop) const { return m_values.at(m_values.size() - std::size_t(fromTop)); }
+	Annotations takeAnnotations()
 	{
-		const PositionedString name = positionedStringFromToken(stack.at(stack.size() - 2));
-		Type::Ptr type = stack.at(stack.size() - 1).getRawData<Type>();
-		file.structs.back().members.push_back(Attribute{type, PositionedInt64(), name, annotations});
-		annotations.values.clear();
-		return GeneralParser::defineStructAttribute(token, stack);
-	};
-	auto defineStructAttributeWithIndex = [&file, &annotations](const Token &token, const std::vector<Token> &stack)
+		Annotations annotations = m_annotations;
+		m_annotations.values.clear();
+		return annotations;
+	}
+
+	PositionedString positionedStringFromToken(const Token &token) const
 	{
-		const PositionedString name = positionedStringFromToken(stack.at(stack.size() - 4));
-		const Type::Ptr type = stack.at(stack.size() - 3).getRawData<Type>();
-		const PositionedInt64 index = positionedIntFromToken(stack.at(stack.size() - 1));
-		file.structs.back().members.push_back(Attribute{type, index, name, annotations});
-		annotations.values.clear();
-		return GeneralParser::defineStructAttributeWithIndex(token, stack);
-	};
-	auto convertTypeToTypeList = [](const Token &token, const std::vector<Token> &stack)
+		return PositionedString{m_tokens.string(token), token.offset, token.length};
+	}
+	PositionedSymbol positionedSymbolFromToken(const Token &token) const
 	{
-		const Token typeToken = stack.back();
-		Type::Ptr type = typeToken.getRawData<Type>();
-		Token newTkn;
-		newTkn.type = Token::TypeList;
-		newTkn.data = stack.at(stack.size() - 3).data;
-		newTkn.getRawData<Type>()->templateArguments.push_back(type);
-		return std::make_pair(1, std::vector<Token>({newTkn}));
-	};
-	auto mergeTypeListAndType = [](const Token &token, const std::vector<Token> &stack)
+		return PositionedSymbol{Symbol(m_tokens.string(token)), token.offset, token.length};
+	}
+	PositionedInt64 positionedIntFromToken(const Token &token) const
 	{
-		Token typelistToken = stack.at(stack.size() - 4);
-		Type::Ptr typelistContainer = typelistToken.getRawData<Type>();
-		Type::Ptr type = stack.at(stack.size() - 1).getRawData<Type>();
-		typelistContainer->templateArguments.push_back(type);
-		return std::make_pair(1, std::vector<Token>());
-	};
-	auto finalizeType = [](const Token &token, const std::vector<Token> &stack)
+		return PositionedInt64{m_tokens.integer(token), token.offset, token.length};
+	}
+
+	void checkDefinition(const Token &id) const
 	{
-		if (stack.back().type == Token::TypeList) {
-			return std::make_pair(2, std::vector<Token>());
-		} else if (stack.at(stack.size() - 2).type == Token::TypeList) {
-			Type::Ptr type = stack.at(stack.size() - 1).getRawData<Type>();
-			stack.at(stack.size() - 4).getRawData<Type>()->templateArguments.push_back(type);
-			return std::make_pair(3, std::vector<Token>());
-		} else {
-			Type::Ptr type = stack.at(stack.size() - 1).getRawData<Type>();
-			stack.at(stack.size() - 3).getRawData<Type>()->templateArguments.push_back(type);
-			return std::make_pair(2, std::vector<Token>());
+		const std::string name = m_tokens.string(id);
+		if (Type::builtinFor(name) != Type::UserDefined) {
+			throw Parser::ParserException(std::string("Redefinition of built-in type '") + name + "'", id.offset, id.length);
 		}
-	};
-	auto typeDefinition = [&file](const std::vector<Token> &stack)
+		if (m_definedTypes.find(Symbol::find(name)) != m_definedTypes.end()) {
+			throw Parser::ParserException(std::string("Redefinition of user-defined type '") + name + "'", id.offset, id.length);
+		}
+	}
+	void checkUsage(const Token &id) const
 	{
-		const Token id = stack.back();
-		if (Type::create(id.string())->isBuiltin()) {
-			throw ParserException(std::string("Redefinition of built-in type '") + id.string() + "'", id.offset, id.length);
+		const std::string name = m_tokens.string(id);
+		if (Type::builtinFor(name) == Type::UserDefined && m_definedTypes.find(Symbol::find(name)) == m_definedTypes.end()) {
+			throw Parser::ParserException(std::string("Unknown type: ") + name, id.offset, id.length);
 		}
-		for (const std::string &s : file.definedTypes()) {
-			if (s == id.string()) {
-				throw ParserException(std::string("Redefinition of user-defined type '") + id.string() + "'", id.offset, id.length);
+	}
+	void define(const PositionedString &name)
+	{
+		m_definedTypes.insert(Symbol(name.value));
+	}
+	void addAnnotationValue(const PositionedSymbol &name, const Token &valueToken)
+	{
+		// replace the placeholder added by DefineAnnotation, but keep earlier values of the same annotation
+		auto range = m_annotations.values.equal_range(m_lastDefinedAnnotation);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second.is<PositionedString>() && it->second.get<PositionedString>().offset == -1) {
+				m_annotations.values.erase(it);
+				break;
 			}
 		}
-	};
-	auto typeUsage = [&file](const std::vector<Token> &stack)
+		if (valueToken.type == Token::Integer) {
+			m_annotations.values.insert({name, positionedIntFromToken(valueToken)});
+		} else {
+			m_annotations.values.insert({name, positionedStringFromToken(valueToken)});
+		}
+	}
+
+public:
+	explicit FileBuilder(const TokenList &tokens) : m_tokens(tokens) {}
+
+	File file;
+
+	void shift(const Token &token) override
 	{
-		const Token id = stack.back();
-		if (Type::create(id.string())->isBuiltin()) {
-			return;
+		m_values.push_back(Value{token, nullptr});
+	}
+	void reduce(const int action, const int length) override
+	{
+		Value result = length > 0 ? value(length) : Value();
+		switch (action) {
+		case IdlGrammar::StructName:
+		case IdlGrammar::EnumName:
+		case IdlGrammar::AliasName:
+		case IdlGrammar::AttributeName:
+		case IdlGrammar::EntryName:
+			checkDefinition(value(1).token);
+			break;
+		case IdlGrammar::TypeName:
+			checkUsage(value(1).token);
+			break;
+
+		case IdlGrammar::DefineStruct:
+			file.structs.push_back(Struct{PositionedString(), positionedStringFromToken(value(1).token), {}, takeAnnotations()});
+			define(file.structs.back().name);
+			break;
+		case IdlGrammar::DefineStructWithInclude:
+			file.structs.push_back(Struct{positionedStringFromToken(value(1).token), positionedStringFromToken(value(3).token), {}, takeAnnotations()});
+			define(file.structs.back().name);
+			break;
+		case IdlGrammar::DefineEnum:
+			file.enums.push_back(Enum{positionedStringFromToken(value(4).token), positionedStringFromToken(value(2).token), {}, takeAnnotations()});
+			define(file.enums.back().name);
+			break;
+		case IdlGrammar::DefineUsing:
+			file.usings.push_back(Using{positionedStringFromToken(value(4).token), value(2).type, takeAnnotations()});
+			define(file.usings.back().name);
+			break;
+		case IdlGrammar::DefineAttribute:
+			file.structs.back().members.push_back(Attribute{value(2).type, PositionedInt64(), positionedStringFromToken(value(3).token), takeAnnotations()});
+			break;
+		case IdlGrammar::DefineAttributeWithIndex:
+			file.structs.back().members.push_back(Attribute{value(4).type, positionedIntFromToken(value(2).token), positionedStringFromToken(value(5).token), takeAnnotations()});
+			break;
+		case IdlGrammar::DefineEnumEntry:
+			file.enums.back().entries.push_back(EnumEntry{positionedStringFromToken(value(4).token), positionedIntFromToken(value(2).token), takeAnnotations()});
+			break;
+
+		case IdlGrammar::SimpleType:
+			result.type = m_types->make(positionedSymbolFromToken(value(1).token), std::vector<Type::Ptr>());
+			break;
+		case IdlGrammar::TemplateType:
+			result.type = m_types->make(positionedSymbolFromToken(value(4).token), std::move(value(2).type->templateArguments));
+			break;
+		case IdlGrammar::BeginTypeList:
+			// the list is collected as the template arguments of an unnamed type, which stays behind empty in the arena
+			result.type = m_types->make(PositionedSymbol(), std::vector<Type::Ptr>({value(1).type}));
+			break;
+		case IdlGrammar::AppendTypeList:
+			value(3).type->templateArguments.push_back(value(1).type);
+			break;
+
+		case IdlGrammar::DefineAnnotation:
+			m_lastDefinedAnnotation = PositionedSymbol(Symbol(m_tokens.string(value(1).token)), value(1).token.offset, value(1).token.length);
+			m_annotations.values.insert({m_lastDefinedAnnotation, Annotations::Value(PositionedString())});
+			break;
+		case IdlGrammar::AnnotationValue:
+			addAnnotationValue(m_lastDefinedAnnotation, value(1).token);
+			break;
+		case IdlGrammar::NamedAnnotationValue: {
+			const Token &key = value(3).token;
+			addAnnotationValue(PositionedSymbol(Symbol(m_lastDefinedAnnotation.value.string() + '.' + m_tokens.string(key)), key.offset, key.length), value(1).token);
+			break;
 		}
-		for (const std::string &s : file.definedTypes()) {
-			if (s == id.string()) {
-				return;
-			}
+		case IdlGrammar::MergeStrings:
+			// the text of consecutive strings is adjacent in the token list
+			result.token.dataLength = value(1).token.data + value(1).token.dataLength - value(2).token.data;
+			result.token.length = value(1).token.offset + value(1).token.length - value(2).token.offset;
+			break;
+		case IdlGrammar::None:
+			break;
 		}
-		throw ParserException(std::string("Unknown type: ") + id.string(), id.offset, id.length);
-	};
-	auto morphIdentifierToType = [](const Token &token)
-	{
-		Token tkn;
-		tkn.type = Token::Type;
-		tkn.offset = token.offset;
-		tkn.length = token.length;
-		tkn.setRawData(new Type(positionedStringFromToken(token), {}));
-		return tkn;
-	};
-	auto morphTypeToTypeList = [](const Token &token)
-	{
-		Token tkn = token;
-		tkn.type = Token::TypeList;
-		return tkn;
-	};
-	auto unexpected = [](const Token &token)
+		m_values.resize(m_values.size() - std::size_t(length));
+		m_values.push_back(result);
+	}
+	void unexpected(const Token &token) override
 	{
 		switch (token.type) {
-		case Token::Identifier: throw ParserException(std::string("Unexpected token IDENTIFIER (") + token.string() + ")", token.offset, token.length);
-		case Token::String: throw ParserException(std::string("Unexpected token STRING (\"") + token.string() + "\")", token.offset, token.length);
-		case Token::Integer: throw ParserException(std::string("Unexpected token INTEGER (") + std::to_string(token.integer()) + ")", token.offset, token.length);
-		default: throw ParserException(std::string("Unexpected token ") + Token::toString(token.type), token.offset, token.length);
+		case Token::EndOfFile: throw Parser::ParserException("Unexpected end of file", endOfFileOffset(m_tokens.tokens()));
+		case Token::Identifier: throw Parser::ParserException(std::string("Unexpected token IDENTIFIER (") + m_tokens.string(token) + ")", token.offset, token.length);
+		case Token::String: throw Parser::ParserException(std::string("Unexpected token STRING (\"") + m_tokens.string(token) + "\")", token.offset, token.length);
+		case Token::Integer: throw Parser::ParserException(std::string("Unexpected token INTEGER (") + std::to_string(m_tokens.integer(token)) + ")", token.offset, token.length);
+		case Token::Error: throw Parser::ParserException(m_tokens.string(token), token.offset, token.length);
+		default: throw Parser::ParserException(std::string("Unexpected token ") + Token::toString(token.type), token.offset, token.length);
 		}
-	};
-
-	GeneralParser::parse({defineStruct, defineStructWithInclude, defineEnum, defineUsing, defineAnnotation, addToAnnotation,
-						  defineEnumEntry, defineStructAttribute, defineStructAttributeWithIndex, convertTypeToTypeList, mergeTypeListAndType, finalizeType},
-						 {typeDefinition, typeUsage},
-						 {morphIdentifierToType, morphTypeToTypeList},
-						 std::vector<Token>(),
-						 m_tokens,
-						 unexpected);
-
-	return file;
+	}
+};
 }
 
-std::string Parser::UnexpectedTokenException::message(const Parser::Token &actual, const std::initializer_list<Parser::Token::TokenType> &expected)
+File Parser::process()
 {
-	using Token = Parser::Token;
-	const std::vector<Token::TokenType> tokens(expected);
-
-	std::string expectedString;
-	if (tokens.size() == 1)
-	{
-		expectedString = Token::toString(tokens.front());
-	}
-	else
-	{
-		std::vector<std::string> typeStrings;
-		std::transform(tokens.begin(), tokens.end(), std::back_inserter(typeStrings), &Token::toString);
-		expectedString = String::joinStrings(typeStrings, ", ");
+	FileBuilder builder(m_tokens);
+	TableParser parser(IdlGrammar::tables());
+	parser.consume(m_tokens.tokens(), &builder);
+	if (!parser.isAccepted()) {
+		throw ParserException("Unexpected end of file", endOfFileOffset(m_tokens.tokens()));
 	}
-	return std::string("Got token ") + Token::toString(actual.type) + ", expected " + expectedString;
+	return builder.file;
 }
 
 }
@@ -19,7 +19,6 @@
 #include <vector>
 
 #include "util/ArgonautsException.h"
-#include "util/SelfContainerIterator.h"
 #include "common/Lexer.h"
 #include "common/Token.h"
 #include "DataTypes.h"
@@ -29,9 +28,10 @@ namespace Tool {
 class Parser
 {
 	using Token = Common::Token;
-	std::vector<Token> m_tokens;
+	Common::TokenList m_tokens;
 public:
-	explicit Parser(const std::vector<Token> &tokens);
+	explicit Parser(Common::TokenList &&tokens);
+	explicit Parser(const Common::TokenList &tokens);
 
 	class ParserException : public Util::Exception
 	{
@@ -41,33 +41,8 @@ public:
 
 		const int offset, length;
 	};
-	class UnexpectedEndOfTokenStreamException : public ParserException
-	{
-	public:
-		explicit UnexpectedEndOfTokenStreamException() : ParserException("Unexpected end of token stream") {}
-	};
-	class UnexpectedTokenException : public ParserException
-	{
-	public:
-		using ParserException::ParserException;
-
-		explicit UnexpectedTokenException(const Token &actual, const std::initializer_list<Token::TokenType> &expected)
-			: ParserException(message(actual, expected), actual.offset, actual.length) {}
-
-	private:
-		static std::string message(const Token &actual, const std::initializer_list<Token::TokenType> &expected);
-	};
 
 	File process();
-
-private:
-	Struct consumeStruct(const Annotations &annotations);
-	Enum consumeEnum(const Annotations &annotations);
-	std::unordered_multimap<PositionedString, Annotations::Value> consumeAnnotation();
-	Type::Ptr consumeType();
-
-	inline Token consumeToken(const Token::TokenType type) { return consumeToken({type}); }
-	Token consumeToken(const std::initializer_list<Token::TokenType> &types = {Token::Invalid});
 };
 }
 }
@@ -18,6 +18,8 @@
 
 #include <algorithm>
 
+#include "util/json/Json.h"
+
 namespace Argonauts {
 namespace Tool {
 
@@ -31,29 +33,46 @@ static Annotations mergeAnnotations(const Annotations &a, const Annotations &b)
 	Annotations out = a;
 	std::copy_if(b.values.begin(), b.values.end(), std::inserter(out.values, out.values.begin()), [](const auto &pair)
 	{
-		return pair.first != "hidden";
+		return pair.first.value != Annotations::Keys::hidden;
 	});
 	return out;
 }
 
-static void resolveAliasesHelper(const std::unordered_map<PositionedString, Using> &aliases, const Type::Ptr &type)
+static void resolveAliasesHelper(const std::unordered_map<Symbol, Using> &aliases, const Type::Ptr &type)
 {
-	if (aliases.find(type->name) != aliases.end()) {
-		const Type::Ptr alias = aliases.find(type->name)->second.type;
-		type->name = alias->name;
+	const auto it = aliases.find(type->name.value);
+	if (it != aliases.end()) {
+		const Type::Ptr alias = it->second.type;
+		type->setName(alias->name);
 		type->templateArguments = alias->templateArguments;
 		resolveAliasesHelper(aliases, type);
 	}
 }
+// annotations on an alias apply to all attributes using it, unless the attribute sets them itself
+static void inheritAliasAnnotations(const std::unordered_map<Symbol, Using> &aliases, const Symbol &name, Annotations &annotations)
+{
+	const auto it = aliases.find(name);
+	if (it == aliases.end()) {
+		return;
+	}
+	const Annotations own = annotations;
+	for (const auto &pair : it->second.annotations.values) {
+		if (!own.contains(pair.first.value)) {
+			annotations.values.insert(pair);
+		}
+	}
+	inheritAliasAnnotations(aliases, it->second.type->name.value, annotations);
+}
 void Resolver::resolveAliases()
 {
-	std::unordered_map<PositionedString, Using> aliases;
+	std::unordered_map<Symbol, Using> aliases;
 	for (const Using &alias : m_file.usings) {
-		aliases.insert({alias.name, alias});
+		aliases.insert({Symbol(alias.name.value), alias});
 	}
 
-	for (const Struct &structure : m_file.structs) {
-		for (const Attribute &attribute : structure.members) {
+	for (Struct &structure : m_file.structs) {
+		for (Attribute &attribute : structure.members) {
+			inheritAliasAnnotations(aliases, attribute.type->name.value, attribute.annotations);
 			resolveAliasesHelper(aliases, attribute.type);
 		}
 	}
@@ -98,5 +117,36 @@ void Resolver::resolveIncludes()
 	}
 }
 
+static void verifyAnnotationsHelper(const Annotations &annotations)
+{
+	const Symbol &regex = Annotations::Keys::verificationRegex;
+	const Symbol &format = Annotations::Keys::verificationFormat;
+	for (const auto &pair : annotations.values) {
+		if (pair.first.value != regex && pair.first.value != format) {
+			continue;
+		}
+		if (!pair.second.is<PositionedString>()) {
+			throw Resolver::ResolverError(std::string("Expected a string for '") + pair.first.value.string() + "'", pair.first.offset);
+		}
+		const PositionedString value = pair.second.get<PositionedString>();
+		if (pair.first.value == regex && !Util::Json::isRegex(value)) {
+			throw Resolver::ResolverError(std::string("Invalid regular expression '") + value + "'", value.offset);
+		} else if (pair.first.value == format && !Util::Json::isKnownFormat(value)) {
+			throw Resolver::ResolverError(std::string("Unknown format '") + value + "'", value.offset);
+		}
+	}
+}
+void Resolver::verifyAnnotations()
+{
+	for (const Using &alias : m_file.usings) {
+		verifyAnnotationsHelper(alias.annotations);
+	}
+	for (const Struct &structure : m_file.structs) {
+		for (const Attribute &attribute : structure.members) {
+			verifyAnnotationsHelper(attribute.annotations);
+		}
+	}
+}
+
 }
 }
@@ -37,6 +37,7 @@ public:
 	File result() const { return m_file; }
 	void resolveAliases();
 	void resolveIncludes();
+	void verifyAnnotations();
 
 private:
 	File m_file;
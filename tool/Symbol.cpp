@@ -0,0 +1,86 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Symbol.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace Argonauts {
+namespace Tool {
+struct Symbol::Table
+{
+	// strings are spread over the shards by their hash, so threads interning different strings rarely wait for each other
+	struct Shard
+	{
+		std::mutex mutex;
+		std::deque<Entry> entries; ///< Only ever appended to, so pointers to entries stay valid
+		std::unordered_map<std::string, const Entry *> lookup;
+	};
+	static constexpr std::size_t shardCount = 64;
+	Shard shards[shardCount];
+	std::atomic<uint32_t> nextId{1};
+	const Entry empty{std::string(), 0};
+
+	Table()
+	{
+		shardFor(std::string()).lookup.insert({std::string(), &empty});
+	}
+
+	Shard &shardFor(const std::string &string)
+	{
+		return shards[std::hash<std::string>()(string) % shardCount];
+	}
+};
+
+Symbol::Table &Symbol::table()
+{
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+	static Table table;
+#pragma clang diagnostic pop
+	return table;
+}
+const Symbol::Entry *Symbol::emptyEntry()
+{
+	static const Entry *entry = &table().empty;
+	return entry;
+}
+
+Symbol::Symbol(const std::string &string)
+{
+	Table &t = table();
+	Table::Shard &shard = t.shardFor(string);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.lookup.find(string);
+	if (it == shard.lookup.end()) {
+		shard.entries.push_back(Entry{string, t.nextId++});
+		it = shard.lookup.insert({string, &shard.entries.back()}).first;
+	}
+	m_entry = it->second;
+}
+
+Symbol Symbol::find(const std::string &string)
+{
+	Table::Shard &shard = table().shardFor(string);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.lookup.find(string);
+	return it == shard.lookup.end() ? Symbol() : Symbol(it->second);
+}
+}
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <functional>
+
+namespace Argonauts {
+namespace Tool {
+/// An interned string. All symbols with the same text share one entry in a process wide table, so comparing and hashing
+/// symbols is an integer operation. Entries are never removed, the table is safe to use from multiple threads.
+class Symbol
+{
+	struct Entry
+	{
+		std::string string;
+		uint32_t id;
+	};
+	struct Table;
+	const Entry *m_entry;
+
+	explicit Symbol(const Entry *entry) : m_entry(entry) {}
+	static Table &table();
+	static const Entry *emptyEntry();
+
+public:
+	/// The empty symbol, with id 0
+	explicit Symbol() : m_entry(emptyEntry()) {}
+	explicit Symbol(const std::string &string);
+
+	/// Returns the existing symbol for string, or the empty symbol if string has not been interned yet
+	static Symbol find(const std::string &string);
+
+	uint32_t id() const { return m_entry->id; }
+	const std::string &string() const { return m_entry->string; }
+	bool empty() const { return m_entry->id == 0; }
+	operator const std::string &() const { return m_entry->string; }
+
+	bool operator==(const Symbol &other) const { return m_entry == other.m_entry; }
+	bool operator!=(const Symbol &other) const { return m_entry != other.m_entry; }
+};
+}
+}
+
+namespace std {
+template <>
+struct hash<Argonauts::Tool::Symbol>
+{
+	std::size_t operator()(const Argonauts::Tool::Symbol &symbol) const
+	{
+		return symbol.id();
+	}
+};
+}
@@ -19,6 +19,7 @@
 #include <iostream>
 
 #include "util/FSUtil.h"
+#include "util/ThreadUtil.h"
 #include "util/TermUtil.h"
 #include "util/Error.h"
 #include "DataTypes.h"
@@ -32,6 +33,7 @@ void VerifyCommand::setup(Util::CLI::ParserBuilder::Ptr &builder)
 	builder->addSubcommand({"verify", "v"}, "Verifies that the syntax of a given list of grammar files is correct")->setup([this](Util::CLI::Subcommand::Ptr &cmd)
 	{
 		cmd->addOption({"dump", "d"}, "If given, dumps the result");
+		cmd->addOption({"jobs", "j"}, "How many threads to use (default: one per core)")->withRequiredArg("N");
 		cmd->withPositionalArgument("INPUTS", "A list of ProjectArgonauts grammar files to check", Util::CLI::Subcommand::Repeatable);
 		cmd->then([this](const Util::CLI::Parser &parser) { return run(parser); });
 	});
@@ -40,16 +42,28 @@ Util::CLI::Execution VerifyCommand::run(const Util::CLI::Parser &parser)
 {
 	using namespace Util::Term;
 
-	bool haveError = false;
-	for (const std::string &file : parser.positionalArguments("INPUTS")) {
+	// files are checked in parallel, but reported in the order they were given in
+	const std::vector<std::string> inputs = parser.positionalArguments("INPUTS");
+	std::vector<File> files(inputs.size());
+	std::vector<std::string> errors(inputs.size());
+	Util::Thread::parallelFor(inputs.size(), parser.hasOption("jobs") ? parser.option<int>("jobs") : 0, [&inputs, &files, &errors](const std::size_t i)
+	{
 		try {
-			auto f = lexAndParse(Util::FS::readFile(file), file, ResolveIncludes | ResolveAliases);
-			std::cout << fg(Green, style(Bold, file) + " is valid") << std::endl;
+			files[i] = lexAndParse(Util::FS::readFile(inputs[i]), inputs[i], ResolveIncludes | ResolveAliases | VerifyAnnotations);
+		} catch (Util::Error &error) {
+			errors[i] = error.errorMessage();
+		}
+	});
+
+	bool haveError = false;
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		if (errors[i].empty()) {
+			std::cout << fg(Green, style(Bold, inputs[i]) + " is valid") << std::endl;
 			if (parser.hasOption("dump")) {
-				std::cout << "It contains " << style(Bold, std::to_string(f.structs.size()) + " structs") << " and " << style(Bold, std::to_string(f.enums.size()) + " enums") << std::endl;
+				std::cout << "It contains " << style(Bold, std::to_string(files[i].structs.size()) + " structs") << " and " << style(Bold, std::to_string(files[i].enums.size()) + " enums") << std::endl;
 			}
-		} catch (Util::Error &error) {
-			std::cerr << fg(Red, error.errorMessage()) << std::endl;
+		} else {
+			std::cerr << fg(Red, errors[i]) << std::endl;
 			haveError = true;
 		}
 	}
@@ -39,6 +39,12 @@ public:
 	virtual int resolverFlags() const { return 0; }
 	virtual std::string name() const = 0;
 	virtual std::string help() const = 0;
+
+	/// Number of threads run may use, 0 for one per core
+	void setJobs(const int jobs) { m_jobs = jobs; }
+
+protected:
+	int m_jobs = 0;
 };
 }
 }
@@ -16,14 +16,22 @@
 
 #include "CppCompiler.h"
 
+#include <algorithm>
+#include <cctype>
 #include <fstream>
-#include <ostream>
+#include <map>
+#include <mutex>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <boost/filesystem.hpp>
 
 #include "util/CmdParser.h"
+#include "util/FSUtil.h"
+#include "util/StringUtil.h"
+#include "util/ThreadUtil.h"
+#include "util/json/JsonSaxWriter.h"
 #include "tool/DataTypes.h"
 #include "cpp/TypeProviders.h"
 
@@ -46,13 +54,24 @@ void CppCompiler::setup(std::shared_ptr<Util::CLI::Subcommand> &builder)
 			->withRequiredArg("DIR")
 			->applyTo(this, &CppCompiler::m_directory)
 			->beingRequired();
+	builder->addOption({"incremental", "i"}, "Skip types that are unchanged since the last run into the same directory")
+			->applyTo(this, &CppCompiler::m_incremental);
+	builder->addOption({"manifest"}, "Write a JSON description of the generated files and the dependencies between them to FILE")
+			->withRequiredArg("FILE")
+			->applyTo(this, &CppCompiler::m_manifest);
+	builder->addOption({"depfile"}, "Write a Make/Ninja style dependency file for the generated files to FILE")
+			->withRequiredArg("FILE")
+			->applyTo(this, &CppCompiler::m_depfile);
+	builder->addOption({"stamp"}, "Touch FILE after every successful run, the depfile then lists it instead of the generated files")
+			->withRequiredArg("FILE")
+			->applyTo(this, &CppCompiler::m_stamp);
 }
 
 static std::vector<std::string> listTypesRecursive(const Type::Ptr &ptr)
 {
 	std::vector<std::string> types;
-	if (ptr->name == "List") {
-		types.push_back(ptr->templateArguments.front()->name);
+	if (ptr->builtin == Type::List) {
+		types.push_back(ptr->templateArguments.front()->name.value);
 	}
 	for (const Type::Ptr &arg : ptr->templateArguments) {
 		const auto argTypes = listTypesRecursive(arg);
@@ -63,39 +82,383 @@ static std::vector<std::string> listTypesRecursive(const Type::Ptr &ptr)
 
 static std::string structSerializationFor(const Type::Ptr &type, const std::string &name, const TypeProvider *types)
 {
-	if (type->name == "List") {
+	// name can be an expression like "m_map_.second" or "m_cold.get().m_list", the loop variable needs to be a plain identifier
+	std::string element = name + '_';
+	std::replace_if(element.begin(), element.end(), [](const char c) { return !std::isalnum(c) && c != '_'; }, '_');
+	if (type->builtin == Type::List) {
 		return std::string("serializer->emitArrayStart();\n")
-				+ "for (const auto &" + name + "_ : " + name + ") {\n"
-				+ structSerializationFor(type->templateArguments.front(), name + '_', types)
+				+ "for (const auto &" + element + " : " + name + ") {\n"
+				+ structSerializationFor(type->templateArguments.front(), element, types)
 				+ "}\n"
 				+ "serializer->emitArrayEnd(" + name + "." + types->listSizeFunction() + "());\n";
-	} else if (type->name == "Map") {
+	} else if (type->builtin == Type::Map) {
 		return std::string("serializer->emitObjectStart();\n")
-				+ "for (const auto &" + name + "_ : " + name + ") {\n"
-				+ "serializer->emitObjectKey(" + name + "_.first);\n"
-				+ structSerializationFor(type->templateArguments[1], name + '_', types)
+				+ "for (const auto &" + element + " : " + name + ") {\n"
+				+ "serializer->emitObjectKey(" + element + ".first);\n"
+				+ structSerializationFor(type->templateArguments[1], element + ".second", types)
 				+ "}\n"
 				+ "serializer->emitObjectEnd(" + name + "." + types->listSizeFunction() + "());\n";
-	} else if (type->name == "Variant") {
-		return ""; // TODO
 	} else {
 		return "serializer->emitValue(" + name + ");\n";
 	}
 }
 
-static void writeEnumHeader(std::ofstream &out, const Enum &enumeration, TypeProvider *types)
+// @cpp.container and @cpp.inlineCapacity pick the C++ container of a List or Map attribute. the result ends up in
+// Type::container, see TypeProvider::containerType for what each of them becomes
+static std::string containerFor(const Attribute &attribute)
 {
-	out << generateEnumHeader(ARG_TOOL_VERSION, enumeration, types);
+	const Annotations &annotations = attribute.annotations;
+	std::string container = annotations.getString(Annotations::Keys::cppContainer);
+	std::string capacity;
+	if (container.empty() && !annotations.contains(Annotations::Keys::cppInlineCapacity)) {
+		return std::string();
+	}
+	const Type::Ptr &type = attribute.type;
+	if (type->builtin != Type::List && type->builtin != Type::Map) {
+		throw Util::Exception(std::string("'") + attribute.name + "' is a " + type->toString() + ", cpp.container and cpp.inlineCapacity can only be used for List and Map");
+	}
+
+	// "small_vector<8>" is a shorthand for @cpp.container("small_vector") @cpp.inlineCapacity(8)
+	const std::size_t bracket = container.find('<');
+	if (bracket != std::string::npos) {
+		if (container.back() != '>') {
+			throw Util::Exception(std::string("Invalid container '") + container + "' for '" + attribute.name + "'");
+		}
+		capacity = container.substr(bracket + 1, container.size() - bracket - 2);
+		container = container.substr(0, bracket);
+	}
+	if (annotations.contains(Annotations::Keys::cppInlineCapacity)) {
+		const std::string value = annotations.getString(Annotations::Keys::cppInlineCapacity);
+		if (!capacity.empty() && capacity != value) {
+			throw Util::Exception(std::string("Conflicting inline capacities ") + capacity + " and " + value + " for '" + attribute.name + "'");
+		}
+		capacity = value;
+	}
+	if (!capacity.empty() && (capacity.find_first_not_of("0123456789") != std::string::npos || std::stoull(capacity) == 0)) {
+		throw Util::Exception(std::string("The inline capacity of '") + attribute.name + "' has to be a positive integer, not '" + capacity + "'");
+	}
+
+	if (type->builtin == Type::List) {
+		if (container.empty() || container == "small_vector") {
+			if (capacity.empty()) {
+				throw Util::Exception(std::string("small_vector needs an inline capacity, for example small_vector<8>, for '") + attribute.name + "'");
+			}
+			container = "small_vector";
+		} else if (container != "vector" && container != "deque") {
+			throw Util::Exception(std::string("Unknown container '") + container + "' for '" + attribute.name + "', expected one of 'vector', 'deque', 'small_vector<N>'");
+		} else if (!capacity.empty()) {
+			throw Util::Exception(std::string("'") + container + "' does not support an inline capacity, for '" + attribute.name + "'");
+		}
+	} else {
+		if (container.empty()) {
+			container = "flat_map";
+		} else if (container != "flat_map" && container != "map" && container != "unordered_map") {
+			throw Util::Exception(std::string("Unknown container '") + container + "' for '" + attribute.name + "', expected one of 'unordered_map', 'map', 'flat_map'");
+		} else if (container != "flat_map" && !capacity.empty()) {
+			throw Util::Exception(std::string("'") + container + "' does not support an inline capacity, for '" + attribute.name + "'");
+		}
+	}
+	return capacity.empty() ? container : container + '<' + capacity + '>';
+}
+// the types are shared with the input, so the ones that get a container are replaced by copies
+static File withContainers(const File &input)
+{
+	File file = input;
+	for (Struct &structure : file.structs) {
+		for (Attribute &attribute : structure.members) {
+			const std::string container = containerFor(attribute);
+			if (!container.empty()) {
+				attribute.type = std::make_shared<Type>(*attribute.type);
+				attribute.type->container = container;
+			}
+		}
+	}
+	return file;
+}
+
+// @unknownFields on a struct decides what its parser does with keys it does not know: "error" (the default), "skip" them,
+// or "keep" them as raw JSON that is written back when serializing
+static std::string unknownFieldsFor(const Struct &structure)
+{
+	const std::string mode = structure.annotations.getString(Annotations::Keys::unknownFields, "error");
+	if (mode != "error" && mode != "skip" && mode != "keep") {
+		throw Util::Exception(std::string("Unknown value '") + mode + "' for unknownFields of '" + structure.name + "', expected one of 'error', 'skip', 'keep'");
+	}
+	return mode;
+}
+
+// Where the fields of a struct are stored. The public API keeps the order of the IDL, but the members are declared
+// with @cpp.hot fields first and otherwise by decreasing alignment, which leaves as little padding as possible. Fields
+// annotated with @cpp.cold are moved into a block on the heap (Runtime::ColdStorage) that is only allocated once one of
+// them is set
+struct StructLayout
+{
+	std::vector<std::size_t> storageOrder; ///< indices of the inline fields, in the order they are declared
+	std::vector<std::size_t> coldFields;
+	StringVector readAccess; ///< per field, in IDL order, the expression to read it from within the struct
+	StringVector writeAccess;
+};
+static std::size_t alignmentOf(const Type::Builtin builtin)
+{
+	switch (builtin) {
+	case Type::Int8: case Type::UInt8: case Type::Bool:
+		return 1;
+	case Type::Int16: case Type::UInt16:
+		return 2;
+	case Type::Int32: case Type::UInt32:
+		return 4;
+	default:
+		// 64 bit numbers, and strings, containers, variants and structs which all contain at least a pointer
+		return 8;
+	}
+}
+static std::size_t alignmentOf(const Type::Ptr &type, const File &file)
+{
+	if (type->builtin == Type::UserDefined) {
+		for (const Enum &enumeration : file.enums) {
+			if (enumeration.name.value == type->name.value.string()) {
+				return alignmentOf(Type::builtinFor(enumeration.type));
+			}
+		}
+	}
+	return alignmentOf(type->builtin);
+}
+static StructLayout layoutFor(const Struct &structure, const File &file)
+{
+	StructLayout layout;
+	std::vector<std::size_t> hot, normal;
+	for (std::size_t i = 0; i < structure.members.size(); ++i) {
+		const Attribute &attribute = structure.members.at(i);
+		const bool isHot = attribute.annotations.contains(Annotations::Keys::cppHot);
+		const bool isCold = attribute.annotations.contains(Annotations::Keys::cppCold);
+		if (isHot && isCold) {
+			throw Util::Exception(std::string("'") + attribute.name + "' can not be both cpp.hot and cpp.cold");
+		}
+		(isCold ? layout.coldFields : isHot ? hot : normal).push_back(i);
+		layout.readAccess.push_back(std::string(isCold ? "m_cold.get()." : "") + "m_" + attribute.name);
+		layout.writeAccess.push_back(std::string(isCold ? "m_cold.mutate()." : "") + "m_" + attribute.name);
+	}
+
+	const auto byAlignment = [&structure, &file](const std::size_t a, const std::size_t b)
+	{
+		return alignmentOf(structure.members.at(a).type, file) > alignmentOf(structure.members.at(b).type, file);
+	};
+	std::stable_sort(hot.begin(), hot.end(), byAlignment);
+	std::stable_sort(normal.begin(), normal.end(), byAlignment);
+	std::stable_sort(layout.coldFields.begin(), layout.coldFields.end(), byAlignment);
+	layout.storageOrder = hot;
+	layout.storageOrder.insert(layout.storageOrder.end(), normal.begin(), normal.end());
+	return layout;
+}
+static std::string describe(const StructLayout &layout)
+{
+	std::string out;
+	for (const std::size_t index : layout.storageOrder) {
+		out += std::to_string(index) + ',';
+	}
+	for (const std::size_t index : layout.coldFields) {
+		out += 'c' + std::to_string(index) + ',';
+	}
+	return out;
+}
+
+// variants annotated with variant.selectBy = firstFieldAvailable, together with the name of the first field of each of
+// their alternatives. the alternatives have to be structs from the same file
+using VariantSelectors = std::vector<std::pair<Type::Ptr, StringVector>>;
+
+static std::string firstFieldOf(const File &file, const std::string &structName)
+{
+	for (const Struct &structure : file.structs) {
+		if (structure.name.value == structName) {
+			if (!structure.includes.value.empty()) {
+				return firstFieldOf(file, structure.includes.value);
+			} else if (structure.members.empty()) {
+				throw Util::Exception(std::string("'") + structName + "' has no fields, so it can not be selected by variant.selectBy = firstFieldAvailable");
+			}
+			return structure.members.front().name;
+		}
+	}
+	throw Util::Exception(std::string("'") + structName + "' is not a struct defined in the same file, as required by variant.selectBy = firstFieldAvailable");
+}
+static VariantSelectors variantSelectorsFor(const Struct &structure, const File &file)
+{
+	VariantSelectors selectors;
+	for (const Attribute &attribute : structure.members) {
+		if (attribute.annotations.getString(Annotations::Keys::variantSelectBy) != "firstFieldAvailable") {
+			continue;
+		}
+		for (const Type::Ptr &type : attribute.type->allRecursive(attribute.type)) {
+			if (type->builtin != Type::Variant) {
+				continue;
+			}
+			StringVector firstFields;
+			for (const Type::Ptr &alternative : type->templateArguments) {
+				const std::string field = firstFieldOf(file, alternative->name.value);
+				if (std::find(firstFields.begin(), firstFields.end(), field) != firstFields.end()) {
+					throw Util::Exception(std::string("The first field '") + field + "' is not unique among the alternatives of " + type->toString());
+				}
+				firstFields.push_back(field);
+			}
+			selectors.emplace_back(type, firstFields);
+		}
+	}
+	return selectors;
+}
+static std::string describe(const VariantSelectors &selectors)
+{
+	std::string out;
+	for (const auto &pair : selectors) {
+		out += pair.first->toString() + '(' + Util::String::joinStrings(pair.second, ",") + ')';
+	}
+	return out;
+}
+
+// the variants of a struct, together with the index of the alternative that each kind of value (named like the
+// handleParse* function for it) is parsed into. user defined types are either enums or structs, which only is known here
+using VariantAlternatives = std::vector<std::pair<Type::Ptr, std::map<std::string, std::size_t>>>;
+
+static bool isEnumIn(const File &file, const std::string &name)
+{
+	return std::any_of(file.enums.begin(), file.enums.end(), [&name](const Enum &enumeration) { return enumeration.name.value == name; });
+}
+static std::set<std::string> eventsParsedBy(const Type::Ptr &type, const File &file)
+{
+	switch (type->builtin) {
+	case Type::UserDefined:
+		if (isEnumIn(file, type->name.value)) {
+			// by the name or the value of an entry
+			return {"Integer", "String"};
+		}
+		return {"Object"};
+	case Type::Double: return {"Double"};
+	case Type::Bool: return {"Boolean"};
+	case Type::String: return {"String"};
+	case Type::List: return {"Array"};
+	case Type::Map: return {"Object"};
+	case Type::Variant: {
+		std::set<std::string> events;
+		for (const Type::Ptr &alternative : type->templateArguments) {
+			const std::set<std::string> alternativeEvents = eventsParsedBy(alternative, file);
+			events.insert(alternativeEvents.begin(), alternativeEvents.end());
+		}
+		if (events.count("Double")) {
+			events.insert("Integer");
+		}
+		return events;
+	}
+	default:
+		return {"Integer"};
+	}
+}
+static VariantAlternatives variantAlternativesFor(const Struct &structure, const File &file, const VariantSelectors &selectors)
+{
+	VariantAlternatives result;
+	for (const Type::Ptr &type : structure.allTypes()) {
+		if (type->builtin != Type::Variant) {
+			continue;
+		}
+		const bool selectsObjects = std::any_of(selectors.begin(), selectors.end(), [&type](const std::pair<Type::Ptr, StringVector> &pair) { return pair.first->compare(type); });
+		std::map<std::string, std::size_t> alternatives;
+		for (std::size_t i = 0; i < type->templateArguments.size(); ++i) {
+			for (const std::string &event : eventsParsedBy(type->templateArguments.at(i), file)) {
+				if (event == "Object" && selectsObjects) {
+					continue;
+				}
+				const auto existing = alternatives.find(event);
+				if (existing != alternatives.end()) {
+					std::string jsonType = event;
+					std::transform(jsonType.begin(), jsonType.end(), jsonType.begin(), [](const char c) { return char(std::tolower(c)); });
+					throw Util::Exception(std::string("Both '") + type->templateArguments.at(existing->second)->toString() + "' and '" + type->templateArguments.at(i)->toString()
+										  + "' of " + type->toString() + " are parsed from values of type '" + jsonType + "'"
+										  + (event == "Object" ? ", use variant.selectBy to choose between them" : ""));
+				}
+				alternatives[event] = i;
+			}
+		}
+		// integers fit into a double, but only if nothing takes them as they are
+		if (alternatives.count("Double") && !alternatives.count("Integer")) {
+			alternatives["Integer"] = alternatives["Double"];
+		}
+		result.emplace_back(type, alternatives);
+	}
+	return result;
+}
+static std::string describe(const VariantAlternatives &alternatives)
+{
+	std::string out;
+	for (const auto &pair : alternatives) {
+		out += pair.first->toString() + '(';
+		for (const auto &event : pair.second) {
+			out += event.first + '=' + std::to_string(event.second) + ',';
+		}
+		out += ')';
+	}
+	return out;
+}
+
+// switches on the character that splits the candidates (all of the same length) into the most groups, until only one
+// is left which then gets compared in full. this way at most one full string comparison is done per parsed value
+static std::string enumNameTrieFor(const Enum &enumeration, const std::vector<const EnumEntry *> &candidates, const std::string &indent)
+{
+	const std::size_t length = candidates.front()->name.value.size();
+	if (candidates.size() == 1) {
+		const std::string &name = candidates.front()->name.value;
+		return indent + "if (std::memcmp(val.data(), \"" + name + "\", " + std::to_string(length) + ") == 0) { type = " + enumeration.name + "::" + name + "; return Argonauts::Runtime::HandleParseAction::Success; }\n";
+	}
+
+	std::size_t position = 0;
+	std::size_t mostGroups = 0;
+	for (std::size_t i = 0; i < length; ++i) {
+		std::set<char> characters;
+		for (const EnumEntry *candidate : candidates) {
+			characters.insert(candidate->name.value[i]);
+		}
+		if (characters.size() > mostGroups) {
+			mostGroups = characters.size();
+			position = i;
+		}
+	}
+
+	std::map<char, std::vector<const EnumEntry *>> groups;
+	for (const EnumEntry *candidate : candidates) {
+		groups[candidate->name.value[position]].push_back(candidate);
+	}
+	std::string out = indent + "switch (val[" + std::to_string(position) + "]) {\n";
+	for (const auto &group : groups) {
+		out += indent + "case '" + group.first + "':\n"
+				+ enumNameTrieFor(enumeration, group.second, indent + '\t')
+				+ indent + "\tbreak;\n";
+	}
+	return out + indent + "}\n";
+}
+static std::string enumNameMatcherFor(const Enum &enumeration)
+{
+	std::map<std::size_t, std::vector<const EnumEntry *>> byLength;
+	for (const EnumEntry &entry : enumeration.entries) {
+		byLength[entry.name.value.size()].push_back(&entry);
+	}
+	std::string out = "switch (val.size()) {\n";
+	for (const auto &group : byLength) {
+		out += "case " + std::to_string(group.first) + ":\n"
+				+ enumNameTrieFor(enumeration, group.second, "\t")
+				+ "\tbreak;\n";
+	}
+	return out + "}\n";
+}
+
+static void writeEnumHeader(std::string &out, const Enum &enumeration, TypeProvider *types)
+{
+	generateEnumHeader(out, ARG_TOOL_VERSION, enumeration, types);
 }
-static void writeEnumSource(std::ofstream &out, const Enum &enumeration, TypeProvider *types, const std::string &headerFilename)
+static void writeEnumSource(std::string &out, const Enum &enumeration, TypeProvider *types, const std::string &headerFilename)
 {
 	std::vector<std::string> acceptedNames, acceptedValues;
 	std::transform(enumeration.entries.begin(), enumeration.entries.end(), std::back_inserter(acceptedNames), [](const EnumEntry &e) { return e.name; });
 	std::transform(enumeration.entries.begin(), enumeration.entries.end(), std::back_inserter(acceptedValues), [](const EnumEntry &e) { return std::to_string(e.value); });
 
-	out << generateEnumSource(ARG_TOOL_VERSION, enumeration, types, headerFilename, acceptedNames, acceptedValues);
+	generateEnumSource(out, ARG_TOOL_VERSION, enumeration, types, headerFilename, acceptedNames, acceptedValues, enumNameMatcherFor(enumeration));
 }
-static void writeStructHeader(std::ofstream &out, const Struct &structure, TypeProvider *types)
+static void writeStructHeader(std::string &out, const Struct &structure, TypeProvider *types, const StructLayout &layout)
 {
 	// collect all required headers. use a set to prevent duplicates
 	std::unordered_set<std::string> typeHeaders;
@@ -104,17 +467,48 @@ static void writeStructHeader(std::ofstream &out, const Struct &structure, TypeP
 		for (const std::string &type : attribute.type->namesRecursive()) {
 			typeHeaders.insert(types->headerForType(type));
 		}
+		for (const Type::Ptr &type : attribute.type->allRecursive(attribute.type)) {
+			if (!type->container.empty()) {
+				for (const std::string &header : types->headersForContainer(type->container)) {
+					typeHeaders.insert(header);
+				}
+			}
+		}
 
 		constructorArgs.push_back(std::string("const ") + types->fullType(attribute) + " &" + attribute.name);
+		builderBuildArgList.push_back(std::string("m_") + attribute.name);
+	}
+	// initializers have to be in the order of declaration. the builder stores the cold fields inline, after all others
+	for (const std::size_t index : layout.storageOrder) {
+		const Attribute &attribute = structure.members.at(index);
 		constructorInitList.push_back(std::string("m_") + attribute.name + "(" + attribute.name + ")");
 		builderCopyInitList.push_back(std::string("m_") + attribute.name + "(original." + attribute.name + "())");
-		builderBuildArgList.push_back(std::string("m_") + attribute.name);
+	}
+	StringVector constructorBody;
+	for (const std::size_t index : layout.coldFields) {
+		const Attribute &attribute = structure.members.at(index);
+		builderCopyInitList.push_back(std::string("m_") + attribute.name + "(original." + attribute.name + "())");
+		constructorBody.push_back("if (present.test(" + std::to_string(index) + ")) { " + layout.writeAccess.at(index) + " = " + attribute.name + "; }");
+	}
+
+	// presence is passed along with the values, this also keeps the lists non-empty for structs without members
+	const std::string presence = "Argonauts::Runtime::PresenceMask<" + std::to_string(structure.members.size()) + '>';
+	constructorArgs.push_back("const " + presence + " &present");
+	constructorInitList.push_back("m_present(present)");
+	builderCopyInitList.push_back("m_present(original.m_present)");
+	builderBuildArgList.push_back("m_present");
+	const std::string unknownFields = unknownFieldsFor(structure);
+	if (unknownFields == "keep") {
+		constructorArgs.push_back("const std::vector<std::pair<std::string, std::string>> &unknownFields");
+		constructorInitList.push_back("m_unknownFields(unknownFields)");
+		builderCopyInitList.push_back("m_unknownFields(original.m_unknownFields)");
+		builderBuildArgList.push_back("m_unknownFields");
 	}
 
 	typeHeaders.erase(std::string());
-	out << generateStructHeader(ARG_TOOL_VERSION, structure, types, typeHeaders, builderCopyInitList, builderBuildArgList, constructorArgs, constructorInitList);
+	generateStructHeader(out, ARG_TOOL_VERSION, structure, types, typeHeaders, builderCopyInitList, builderBuildArgList, constructorArgs, constructorInitList, constructorBody, layout.storageOrder, layout.coldFields, layout.readAccess, unknownFields);
 }
-static void writeStructSource(std::ofstream &out, const Struct &structure, TypeProvider *types, const std::string &headerFilename)
+static void writeStructSource(std::string &out, const Struct &structure, TypeProvider *types, const std::string &headerFilename, const VariantSelectors &variantSelectors, const VariantAlternatives &variantAlternatives, const StructLayout &layout)
 {
 	std::vector<std::string> acceptedObjectKeys;
 	std::transform(structure.members.begin(), structure.members.end(), std::back_inserter(acceptedObjectKeys), [](const Attribute &a) { return a.name; });
@@ -126,7 +520,7 @@ static void writeStructSource(std::ofstream &out, const Struct &structure, TypeP
 		}
 	}
 
-	out << generateStructSource(ARG_TOOL_VERSION, structure, types, headerFilename, acceptedObjectKeys, listTypes, &structSerializationFor);
+	generateStructSource(out, ARG_TOOL_VERSION, structure, types, headerFilename, acceptedObjectKeys, listTypes, &structSerializationFor, variantSelectors, variantAlternatives, layout.readAccess, layout.writeAccess, unknownFieldsFor(structure));
 }
 
 template <typename Type, typename Func, typename... Args>
@@ -134,43 +528,293 @@ void openFileAndCall(const std::string &filename, const Type &data, Func &&func,
 {
 	using namespace boost;
 
-	filesystem::path path = filesystem::path(filename).parent_path();
-	if (!filesystem::exists(path)) {
-		if (!filesystem::create_directories(path)) {
-			throw Util::Exception(std::string("Unable to create parent directories for ") + filename);
+	if (filesystem::exists(filesystem::path(filename)) && !filesystem::is_regular_file(filesystem::path(filename))) {
+		throw Util::Exception(std::string("'") + filename + "' already exists but is not a file");
+	}
+
+	// generate in memory first, that way files that did not change keep their timestamp and do not trigger rebuilds
+	std::string out;
+	func(out, data, args...);
+	Util::FS::writeFileIfChanged(filename, out);
+}
+
+// Canonical textual description of everything in a type that influences the generated code. Offsets are left out, so
+// that moving a type around in the input file does not invalidate it
+static std::string describe(const Annotations &annotations)
+{
+	// the annotations are unordered, sort them by key but keep the order of values with the same key
+	std::map<std::string, std::vector<std::string>> sorted;
+	for (const auto &pair : annotations.values) {
+		if (pair.second.is<PositionedString>()) {
+			sorted[pair.first.value.string()].push_back('"' + pair.second.get<PositionedString>().value + '"');
+		} else {
+			sorted[pair.first.value.string()].push_back(std::to_string(pair.second.get<PositionedInt64>().value));
 		}
 	}
-	if (filesystem::exists(filesystem::path(filename)) && filesystem::is_regular_file(path)) {
-		throw Util::Exception(std::string("'") + filename + "' already exists but is not a file");
+	std::string out;
+	for (const auto &pair : sorted) {
+		out += '@' + pair.first + '(' + Util::String::joinStrings(pair.second, ",") + ')';
+	}
+	return out;
+}
+static std::string describe(const Enum &enumeration)
+{
+	std::string out = std::string("enum ") + enumeration.name.value + ':' + enumeration.type.value + describe(enumeration.annotations) + '{';
+	for (const EnumEntry &entry : enumeration.entries) {
+		out += entry.name.value + '=' + std::to_string(entry.value.value) + describe(entry.annotations) + ';';
+	}
+	return out + '}';
+}
+static std::string describe(const Struct &structure)
+{
+	std::string out = std::string("struct ") + structure.name.value + ' ' + structure.includes.value + describe(structure.annotations) + '{';
+	for (const Attribute &attribute : structure.members) {
+		out += std::to_string(attribute.index.value) + ':' + attribute.type->toString() + ' ' + attribute.name.value + describe(attribute.annotations) + ';';
+	}
+	return out + '}';
+}
+
+// Remembers, per type, a hash of all inputs that went into generating it. Stored as "<type> <hash>" lines in the output directory
+class CppCompiler::Cache
+{
+public:
+	explicit Cache(const std::string &filename) : m_filename(filename)
+	{
+		if (!boost::filesystem::is_regular_file(m_filename)) {
+			return;
+		}
+		for (const std::string &line : Util::String::splitStrings(Util::FS::readFile(m_filename), "\n")) {
+			const std::vector<std::string> parts = Util::String::splitStrings(line, " ");
+			if (parts.size() == 2) {
+				m_entries[parts[0]] = parts[1];
+			}
+		}
+	}
+
+	bool isUpToDate(const std::string &type, const std::string &key) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto it = m_entries.find(type);
+		return it != m_entries.end() && it->second == key;
+	}
+	void update(const std::string &type, const std::string &key)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries[type] = key;
 	}
 
-	std::ofstream stream(filename);
-	if (!stream.good()) {
-		throw Util::Exception(std::string("Unable to open file '") + filename + "' for writing");
+	void save() const
+	{
+		// entries of types not seen during this run are kept, other input files might share the same output directory
+		std::string data;
+		for (const auto &pair : m_entries) {
+			data += pair.first + ' ' + pair.second + '\n';
+		}
+		// write and rename, so that an interrupted run never leaves a truncated cache behind
+		const std::string tmpFilename = m_filename + ".tmp";
+		Util::FS::writeFile(tmpFilename, data);
+		boost::filesystem::rename(tmpFilename, m_filename);
+	}
+
+private:
+	std::string m_filename;
+	std::map<std::string, std::string> m_entries;
+	mutable std::mutex m_mutex;
+};
+
+// the user defined types a struct builds upon, i.e. its parent and the types whose headers it includes
+static std::set<std::string> referencedTypes(const Struct &structure)
+{
+	std::set<std::string> out;
+	if (!structure.includes.value.empty()) {
+		out.insert(structure.includes);
+	}
+	for (const Attribute &attribute : structure.members) {
+		for (const Type::Ptr &type : attribute.type->allRecursive(attribute.type)) {
+			if (!type->isBuiltin() && type->name.value.string() != structure.name.value) {
+				out.insert(type->name.value);
+			}
+		}
 	}
-	func(stream, data, args...);
+	return out;
+}
+
+// Make syntax, as understood by both Make and Ninja
+static std::string escapeForDepfile(const std::string &path)
+{
+	return Util::String::replaceAll(Util::String::replaceAll(path, " ", "\\ "), "$", "$$");
 }
 
-bool CppCompiler::run(const Util::CLI::Parser &, const File &file)
+bool CppCompiler::run(const Util::CLI::Parser &parser, const File &input)
 {
-	TypeProvider *provider;
+	const File file = withContainers(input);
+
+	std::unique_ptr<TypeProvider> provider;
 	if (m_dataTypes == "qt") {
-		provider = new QtTypeProvider;
+		provider.reset(new QtTypeProvider);
 	} else if (m_dataTypes == "stl") {
-		provider = new STLTypeProvider;
+		provider.reset(new STLTypeProvider);
 	} else {
 		std::terminate();
 	}
 
+	// all files go into the same directory, create it up front instead of racing to do so from the workers
+	if (!boost::filesystem::exists(m_directory) && !boost::filesystem::create_directories(m_directory)) {
+		throw Util::Exception(std::string("Unable to create output directory ") + m_directory);
+	}
+
+	std::unique_ptr<Cache> cache;
+	if (m_incremental) {
+		cache.reset(new Cache(m_directory + "/.argonauts_cache"));
+	}
+
+	// every enum and struct is generated independently of all others
+	TypeProvider *types = provider.get();
+	Util::Thread::parallelFor(file.enums.size() + file.structs.size(), m_jobs, [this, &file, types, &cache](const std::size_t index)
+	{
+		if (index < file.enums.size()) {
+			const Enum &enumeration = file.enums.at(index);
+			const std::string key = cacheKeyFor(describe(enumeration));
+			if (cache && isUpToDate(*cache, enumeration.name, key)) {
+				return;
+			}
+			openFileAndCall(filenameFor(enumeration.name, true), enumeration, &writeEnumHeader, types);
+			openFileAndCall(filenameFor(enumeration.name, false), enumeration, &writeEnumSource, types, boost::filesystem::path(filenameFor(enumeration.name, true)).filename().string());
+			if (cache) {
+				cache->update(enumeration.name, key);
+			}
+		} else {
+			const Struct &structure = file.structs.at(index - file.enums.size());
+			const VariantSelectors variantSelectors = variantSelectorsFor(structure, file);
+			const VariantAlternatives variantAlternatives = variantAlternativesFor(structure, file, variantSelectors);
+			const StructLayout layout = layoutFor(structure, file);
+			const std::string key = cacheKeyFor(describe(structure) + describe(variantSelectors) + describe(variantAlternatives) + describe(layout));
+			if (cache && isUpToDate(*cache, structure.name, key)) {
+				return;
+			}
+			openFileAndCall(filenameFor(structure.name, true), structure, &writeStructHeader, types, layout);
+			openFileAndCall(filenameFor(structure.name, false), structure, &writeStructSource, types, boost::filesystem::path(filenameFor(structure.name, true)).filename().string(), variantSelectors, variantAlternatives, layout);
+			if (cache) {
+				cache->update(structure.name, key);
+			}
+		}
+	});
+
+	if (cache) {
+		cache->save();
+	}
+	if (!m_manifest.empty()) {
+		writeManifest(file, parser.positionalArguments("file"));
+	}
+	if (!m_depfile.empty()) {
+		writeDepfile(file, parser.positionalArguments("file"));
+	}
+	if (!m_stamp.empty()) {
+		// the generated files keep their timestamps if they did not change, this is what build systems can check
+		Util::FS::writeFile(m_stamp, std::string());
+	}
+	return true;
+}
+
+int CppCompiler::resolverFlags() const
+{
+	// aliases are not generated as types of their own, their annotations (like cpp.container) apply where they are used
+	return ResolveAliases;
+}
+
+void CppCompiler::writeManifest(const File &file, const std::vector<std::string> &sources) const
+{
+	std::string data;
+	Util::StringOutputStream stream(&data);
+	Util::Json::SaxWriter writer(&stream);
+	Util::SaxSink &sink = writer;
+
+	const auto writeStrings = [&sink](const std::string &key, const std::vector<std::string> &values)
+	{
+		sink.key(key);
+		sink.startArray();
+		for (const std::string &value : values) {
+			sink.string(value);
+		}
+		sink.endArray(values.size());
+	};
+	const auto writeType = [this, &sink, &sources, &writeStrings](const std::string &name, const std::string &kind, const std::set<std::string> &dependencies)
+	{
+		sink.key(name);
+		sink.startObject();
+		sink.key("kind");
+		sink.string(kind);
+		writeStrings("outputs", {filenameFor(name, true), filenameFor(name, false)});
+		writeStrings("sources", sources);
+		writeStrings("dependencies", std::vector<std::string>(dependencies.begin(), dependencies.end()));
+		sink.endObject(4);
+	};
+
+	sink.startObject();
+	writeStrings("sources", sources);
+	writeStrings("outputs", outputsFor(file));
+	sink.key("types");
+	sink.startObject();
+	for (const Enum &enumeration : file.enums) {
+		writeType(enumeration.name, "enum", {});
+	}
+	for (const Struct &structure : file.structs) {
+		writeType(structure.name, "struct", referencedTypes(structure));
+	}
+	sink.endObject(file.enums.size() + file.structs.size());
+	sink.endObject(3);
+
+	Util::FS::writeFileIfChanged(m_manifest, data + '\n');
+}
+void CppCompiler::writeDepfile(const File &file, const std::vector<std::string> &sources) const
+{
+	std::vector<std::string> outputs = m_stamp.empty() ? outputsFor(file) : std::vector<std::string>{m_stamp};
+	std::transform(outputs.begin(), outputs.end(), outputs.begin(), &escapeForDepfile);
+	std::vector<std::string> inputs = sources;
+	std::transform(inputs.begin(), inputs.end(), inputs.begin(), &escapeForDepfile);
+	Util::FS::writeFileIfChanged(m_depfile, Util::String::joinStrings(outputs, " \\\n") + ": " + Util::String::joinStrings(inputs, " \\\n") + '\n');
+}
+std::vector<std::string> CppCompiler::outputsFor(const File &file) const
+{
+	std::vector<std::string> out;
 	for (const Enum &enumeration : file.enums) {
-		openFileAndCall(filenameFor(enumeration.name, true), enumeration, &writeEnumHeader, provider);
-		openFileAndCall(filenameFor(enumeration.name, false), enumeration, &writeEnumSource, provider, boost::filesystem::path(filenameFor(enumeration.name, true)).filename().string());
+		out.push_back(filenameFor(enumeration.name, true));
+		out.push_back(filenameFor(enumeration.name, false));
 	}
 	for (const Struct &structure : file.structs) {
-		openFileAndCall(filenameFor(structure.name, true), structure, &writeStructHeader, provider);
-		openFileAndCall(filenameFor(structure.name, false), structure, &writeStructSource, provider, boost::filesystem::path(filenameFor(structure.name, true)).filename().string());
+		out.push_back(filenameFor(structure.name, true));
+		out.push_back(filenameFor(structure.name, false));
 	}
-	return true;
+	return out;
+}
+
+// a lot of the generated code comes from the compiler itself instead of the templates, and the version is not bumped for
+// every change to it. a different build of the tool can generate different code
+static std::string generatorFingerprint()
+{
+	const std::string path = Util::FS::executablePath();
+	try {
+		if (!path.empty()) {
+			return Util::String::toHexString(Util::String::contentHash(Util::FS::readFile(path)));
+		}
+	} catch (Util::Exception &) {
+	}
+	// without the binary all that is left is the version. the template fingerprints below still catch template changes
+	return ARG_TOOL_VERSION;
+}
+std::string CppCompiler::cacheKeyFor(const std::string &description) const
+{
+	// everything that changes the generated code has to be part of the key
+	static const std::string generator = generatorFingerprint() + '\n' + generateEnumHeaderFingerprint + generateEnumSourceFingerprint
+			+ generateStructHeaderFingerprint + generateStructSourceFingerprint;
+	return Util::String::toHexString(Util::String::contentHash(generator + '\n' + m_dataTypes + '\n' + description));
+}
+bool CppCompiler::isUpToDate(const Cache &cache, const std::string &type, const std::string &key) const
+{
+	// a deleted output needs to be regenerated even if nothing else changed
+	return cache.isUpToDate(type, key)
+			&& boost::filesystem::is_regular_file(filenameFor(type, true))
+			&& boost::filesystem::is_regular_file(filenameFor(type, false));
 }
 
 std::string CppCompiler::filenameFor(const std::string &type, const bool header) const
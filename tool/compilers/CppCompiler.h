@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "AbstractCompiler.h"
 
 namespace Argonauts {
@@ -24,15 +26,27 @@ class CppCompiler : public AbstractCompiler
 {
 public:
 	void setup(std::shared_ptr<Util::CLI::Subcommand> &builder) override;
-	bool run(const Util::CLI::Parser &parser, const File &file) override;
+	bool run(const Util::CLI::Parser &parser, const File &input) override;
+	int resolverFlags() const override;
 	std::string name() const override { return "cpp"; }
 	std::string help() const override { return "Generates C++ files"; }
 
 private:
+	class Cache;
+
 	std::string m_dataTypes = "stl";
 	std::string m_directory;
+	bool m_incremental = false;
+	std::string m_manifest;
+	std::string m_depfile;
+	std::string m_stamp;
 
 	std::string filenameFor(const std::string &type, const bool header) const;
+	std::string cacheKeyFor(const std::string &description) const;
+	bool isUpToDate(const Cache &cache, const std::string &type, const std::string &key) const;
+	std::vector<std::string> outputsFor(const File &file) const;
+	void writeManifest(const File &file, const std::vector<std::string> &sources) const;
+	void writeDepfile(const File &file, const std::vector<std::string> &sources) const;
 };
 }
 }
@@ -21,6 +21,7 @@
 
 #include "util/CmdParser.h"
 #include "util/FSUtil.h"
+#include "util/StringUtil.h"
 #include "tool/DataTypes.h"
 
 #include "templates/Doc.ect.h"
@@ -47,8 +48,11 @@ bool DocCompiler::run(const Util::CLI::Parser &parser, const File &file)
 		throw Util::Exception(std::string("Existing item ") + outFile.string() + " is not a regular file");
 	}
 
-	Util::FS::writeFile(outFile.string(), generateDoc(boost::filesystem::path(parser.positionalArgument("file")).stem().string(), file));
-	std::cout << "Generated documentation for " << parser.positionalArgument("file") << " in " << outFile.string() << std::endl;
+	// all input files end up in the same page, which is named after the first one
+	std::string out;
+	generateDoc(out, boost::filesystem::path(parser.positionalArgument("file")).stem().string(), file);
+	Util::FS::writeFile(outFile.string(), out);
+	std::cout << "Generated documentation for " << Util::String::joinStrings(parser.positionalArguments("file"), ", ") << " in " << outFile.string() << std::endl;
 	return true;
 }
 
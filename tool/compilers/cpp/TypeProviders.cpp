@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <stdexcept>
 
 #include "DataTypes.h"
 #include "util/StringUtil.h"
@@ -26,6 +27,15 @@ namespace Argonauts {
 namespace Tool {
 TypeProvider::~TypeProvider() {}
 
+std::string TypeProvider::listAppendFunctionFor(const std::shared_ptr<Type> &t) const
+{
+	return t->container.empty() ? listAppendFunction() : "push_back";
+}
+std::string TypeProvider::listIndexTypeFor(const std::shared_ptr<Type> &t) const
+{
+	return t->container.empty() ? listIndexType() : "std::size_t";
+}
+
 std::string TypeProvider::fullType(const Attribute &attribute) const
 {
 	return fullType(attribute.type);
@@ -36,21 +46,84 @@ std::string TypeProvider::fullType(const std::shared_ptr<Type> &t) const
 	if (t->isTemplated()) {
 		std::vector<std::string> args;
 		std::transform(t->templateArguments.begin(), t->templateArguments.end(), std::back_inserter(args), [this](const Type::Ptr &ptr) { return fullType(ptr); });
-		return type(t->name) + '<' + Util::String::joinStrings(args, ", ") + '>';
+		if (!t->container.empty()) {
+			return containerType(t->container, args);
+		}
+		return type(t->name.value) + '<' + Util::String::joinStrings(args, ", ") + '>';
+	} else if (t->isBuiltin()) {
+		return type(t->name.value);
+	} else {
+		return t->name.value;
+	}
+}
+
+bool TypeProvider::isListColumn(const std::shared_ptr<Type> &t) const
+{
+	// the elements are parsed by runtime code, which does not know about the parsers generated for maps and variants
+	if (t->builtin != Type::List) {
+		return false;
+	}
+	const Type::Ptr &element = t->templateArguments.front();
+	return element->builtin != Type::Map && element->builtin != Type::Variant && (element->builtin != Type::List || isListColumn(element));
+}
+std::string TypeProvider::columnType(const std::shared_ptr<Type> &t) const
+{
+	if (t->builtin == Type::String) {
+		return "Argonauts::Runtime::StringColumn";
+	} else if (isListColumn(t)) {
+		return "Argonauts::Runtime::ListColumn<" + columnType(t->templateArguments.front()) + '>';
+	} else {
+		return "std::vector<" + fullType(t) + '>';
+	}
+}
+
+// splits "small_vector<8>" into "small_vector" and "8"
+static std::pair<std::string, std::string> splitContainer(const std::string &container)
+{
+	const std::size_t bracket = container.find('<');
+	if (bracket == std::string::npos) {
+		return std::make_pair(container, std::string());
+	}
+	return std::make_pair(container.substr(0, bracket), container.substr(bracket + 1, container.size() - bracket - 2));
+}
+std::string TypeProvider::containerType(const std::string &container, const std::vector<std::string> &args) const
+{
+	const auto split = splitContainer(container);
+	const std::string joined = Util::String::joinStrings(args, ", ");
+	if (split.first == "vector" || split.first == "deque" || split.first == "map" || split.first == "unordered_map") {
+		return "std::" + split.first + '<' + joined + '>';
+	} else if (split.first == "small_vector") {
+		return "boost::container::small_vector<" + joined + ", " + split.second + '>';
+	} else if (split.first == "flat_map" && split.second.empty()) {
+		return "boost::container::flat_map<" + joined + '>';
+	} else if (split.first == "flat_map") {
+		// the sorted entries are stored in a small_vector, so that small maps do not allocate at all
+		return "boost::container::flat_map<" + joined + ", std::less<" + args.front() + ">, boost::container::small_vector<std::pair<" + joined + ">, " + split.second + ">>";
+	} else {
+		throw std::logic_error("Unknown container '" + container + "'");
+	}
+}
+std::vector<std::string> TypeProvider::headersForContainer(const std::string &container) const
+{
+	const auto split = splitContainer(container);
+	if (split.first == "flat_map" && !split.second.empty()) {
+		return {"boost/container/flat_map.hpp", "boost/container/small_vector.hpp"};
+	} else if (split.first == "small_vector" || split.first == "flat_map") {
+		return {"boost/container/" + split.first + ".hpp"};
 	} else {
-		return type(t->name);
+		return {split.first};
 	}
 }
 
 bool TypeProvider::isIntegerType(const std::string &type) const
 {
-	return type == "Int8" || type == "Int16" || type =="Int32" || type == "Int64" ||
-			type == "UInt8" || type == "UInt16" || type == "UInt32" || type == "UInt64";
+	return Type::isInteger(Type::builtinFor(type));
 }
 
 bool TypeProvider::isObjectType(const std::string &type) const
 {
-	return !isIntegerType(type) && type != "Double" && type != "String" && type != "List";
+	const Type::Builtin builtin = Type::builtinFor(type);
+	return builtin != Type::Double && builtin != Type::String && builtin != Type::List && !Type::isInteger(builtin);
 }
 
 std::string TypeProvider::getFromMapHelper(const std::unordered_map<std::string, std::string> &map, const std::string &key, const std::string &default_) const
@@ -67,77 +140,85 @@ std::string TypeProvider::getFromMapHelper(const std::unordered_map<std::string,
 
 std::string QtTypeProvider::type(const std::string &type) const
 {
-	std::unordered_map<std::string, std::string> mapping;
-	mapping["Int8"] = "qint8";
-	mapping["Int16"] = "qint16";
-	mapping["Int32"] = "qint32";
-	mapping["Int64"] = "qint64";
-	mapping["UInt8"] = "quint8";
-	mapping["UInt16"] = "quint16";
-	mapping["UInt32"] = "quint32";
-	mapping["UInt64"] = "quint64";
-	mapping["String"] = "QString";
-	mapping["List"] = "QVector";
-	mapping["Map"] = "QHash";
-	mapping["Bool"] = "bool";
-	mapping["Variant"] = "Argonauts::Util::Variant";
+	static const std::unordered_map<std::string, std::string> mapping = {
+		{"Int8", "qint8"},
+		{"Int16", "qint16"},
+		{"Int32", "qint32"},
+		{"Int64", "qint64"},
+		{"UInt8", "quint8"},
+		{"UInt16", "quint16"},
+		{"UInt32", "quint32"},
+		{"UInt64", "quint64"},
+		{"String", "QString"},
+		{"List", "QVector"},
+		{"Map", "QHash"},
+		{"Double", "double"},
+		{"Bool", "bool"},
+		{"Variant", "Argonauts::Util::Variant"}
+	};
 	return getFromMapHelper(mapping, type, type);
 }
 
 std::string QtTypeProvider::headerForType(const std::string &type) const
 {
-	std::unordered_map<std::string, std::string> mapping;
-	mapping["Int8"] = "QtGlobal";
-	mapping["Int16"] = "QtGlobal";
-	mapping["Int32"] = "QtGlobal";
-	mapping["Int64"] = "QtGlobal";
-	mapping["UInt8"] = "QtGlobal";
-	mapping["UInt16"] = "QtGlobal";
-	mapping["UInt32"] = "QtGlobal";
-	mapping["UInt64"] = "QtGlobal";
-	mapping["String"] = "QString";
-	mapping["List"] = "QVector";
-	mapping["Map"] = "QHash";
-	mapping["Bool"] = std::string();
-	mapping["Variant"] = "util/Variant.h";
+	static const std::unordered_map<std::string, std::string> mapping = {
+		{"Int8", "QtGlobal"},
+		{"Int16", "QtGlobal"},
+		{"Int32", "QtGlobal"},
+		{"Int64", "QtGlobal"},
+		{"UInt8", "QtGlobal"},
+		{"UInt16", "QtGlobal"},
+		{"UInt32", "QtGlobal"},
+		{"UInt64", "QtGlobal"},
+		{"String", "QString"},
+		{"List", "QVector"},
+		{"Map", "QHash"},
+		{"Double", std::string()},
+		{"Bool", std::string()},
+		{"Variant", "util/Variant.h"}
+	};
 	return getFromMapHelper(mapping, type, type + ".arg.h");
 }
 
 std::string STLTypeProvider::type(const std::string &type) const
 {
-	std::unordered_map<std::string, std::string> mapping;
-	mapping["Int8"] = "std::int8_t";
-	mapping["Int16"] = "std::int16_t";
-	mapping["Int32"] = "std::int32_t";
-	mapping["Int64"] = "std::int64_t";
-	mapping["UInt8"] = "std::uint8_t";
-	mapping["UInt16"] = "std::uint16_t";
-	mapping["UInt32"] = "std::uint32_t";
-	mapping["UInt64"] = "std::uint64_t";
-	mapping["String"] = "std::string";
-	mapping["List"] = "std::vector";
-	mapping["Map"] = "std::unordered_map";
-	mapping["Bool"] = "bool";
-	mapping["Variant"] = "Argonauts::Util::Variant";
+	static const std::unordered_map<std::string, std::string> mapping = {
+		{"Int8", "std::int8_t"},
+		{"Int16", "std::int16_t"},
+		{"Int32", "std::int32_t"},
+		{"Int64", "std::int64_t"},
+		{"UInt8", "std::uint8_t"},
+		{"UInt16", "std::uint16_t"},
+		{"UInt32", "std::uint32_t"},
+		{"UInt64", "std::uint64_t"},
+		{"String", "std::string"},
+		{"List", "std::vector"},
+		{"Map", "std::unordered_map"},
+		{"Double", "double"},
+		{"Bool", "bool"},
+		{"Variant", "Argonauts::Util::Variant"}
+	};
 	return getFromMapHelper(mapping, type, type);
 }
 
 std::string STLTypeProvider::headerForType(const std::string &type) const
 {
-	std::unordered_map<std::string, std::string> mapping;
-	mapping["Int8"] = "cstdint";
-	mapping["Int16"] = "cstdint";
-	mapping["Int32"] = "cstdint";
-	mapping["Int64"] = "cstdint";
-	mapping["UInt8"] = "cstdint";
-	mapping["UInt16"] = "cstdint";
-	mapping["UInt32"] = "cstdint";
-	mapping["UInt64"] = "cstdint";
-	mapping["String"] = "string";
-	mapping["List"] = "vector";
-	mapping["Map"] = "unordered_map";
-	mapping["Bool"] = std::string();
-	mapping["Variant"] = "util/Variant.h";
+	static const std::unordered_map<std::string, std::string> mapping = {
+		{"Int8", "cstdint"},
+		{"Int16", "cstdint"},
+		{"Int32", "cstdint"},
+		{"Int64", "cstdint"},
+		{"UInt8", "cstdint"},
+		{"UInt16", "cstdint"},
+		{"UInt32", "cstdint"},
+		{"UInt64", "cstdint"},
+		{"String", "string"},
+		{"List", "vector"},
+		{"Map", "unordered_map"},
+		{"Double", std::string()},
+		{"Bool", std::string()},
+		{"Variant", "util/Variant.h"}
+	};
 	return getFromMapHelper(mapping, type, type + ".arg.h");
 }
 }
@@ -19,6 +19,7 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 namespace Argonauts {
 namespace Tool {
@@ -37,12 +38,22 @@ public:
 	virtual std::string listAtFunction() const = 0;
 	virtual std::string listIndexType() const = 0;
 
+	// lists with a custom container (Type::container) always use the STL names, whatever the provider
+	std::string listAppendFunctionFor(const std::shared_ptr<Type> &t) const;
+	std::string listIndexTypeFor(const std::shared_ptr<Type> &t) const;
+
 	std::string fullType(const Attribute &attribute) const;
 	std::string fullType(const std::shared_ptr<Type> &t) const;
+	/// Column of a <Struct>Columns container (see runtime/Columns.h) that holds values of type t
+	std::string columnType(const std::shared_ptr<Type> &t) const;
+	/// True if columnType(t) is a Runtime::ListColumn, false for other columns or lists that are stored whole
+	bool isListColumn(const std::shared_ptr<Type> &t) const;
+	std::vector<std::string> headersForContainer(const std::string &container) const;
 	bool isIntegerType(const std::string &type) const;
 	bool isObjectType(const std::string &type) const;
 
 protected:
+	std::string containerType(const std::string &container, const std::vector<std::string> &args) const;
 	std::string getFromMapHelper(const std::unordered_map<std::string, std::string> &map, const std::string &key, const std::string &default_) const;
 };
 class QtTypeProvider : public TypeProvider
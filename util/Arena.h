@@ -0,0 +1,59 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Argonauts {
+namespace Util {
+/* Stores values of type T in chunks of ChunkSize, so that creating many small objects does not need one allocation
+ * each. Values are only freed together with the arena. The pointers make() returns share ownership of the whole arena,
+ * so it can be handed out together with the values and be forgotten about.
+ *
+ * Usage:
+ * ```
+ * const std::shared_ptr<Arena<Type>> arena = std::make_shared<Arena<Type>>();
+ * std::shared_ptr<Type> type = arena->make(name, arguments);
+ * ```
+ *
+ * An arena has to be owned by a shared_ptr. It is not thread safe.
+ */
+template <typename T, std::size_t ChunkSize = 64>
+class Arena : public std::enable_shared_from_this<Arena<T, ChunkSize>>
+{
+	// every chunk is reserved up front and never grows beyond that, so the values in it never move
+	std::vector<std::vector<T>> m_chunks;
+
+public:
+	template <typename... Args>
+	std::shared_ptr<T> make(Args &&... args)
+	{
+		if (m_chunks.empty() || m_chunks.back().size() == ChunkSize) {
+			m_chunks.emplace_back();
+			m_chunks.back().reserve(ChunkSize);
+		}
+		m_chunks.back().emplace_back(std::forward<Args>(args)...);
+		return std::shared_ptr<T>(this->shared_from_this(), &m_chunks.back().back());
+	}
+
+	std::size_t size() const { return m_chunks.empty() ? 0 : (m_chunks.size() - 1) * ChunkSize + m_chunks.back().size(); }
+};
+}
+}
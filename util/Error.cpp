@@ -81,7 +81,7 @@ std::string Error::errorMessage() const
 		result += "\nIn " + m_source.m_filename + ":" + std::to_string(position.first) + ":" + std::to_string(position.second);
 	}
 
-	if (!m_source.m_data.empty()) {
+	if (m_offset < m_source.m_data.size()) {
 		result += '\n';
 
 		const std::string rawLine = lineInData();
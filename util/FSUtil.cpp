@@ -21,6 +21,15 @@
 #include <ostream>
 
 #include "ArgonautsException.h"
+#include "OsUtil.h"
+
+#if defined(OS_WINDOWS)
+# include <windows.h>
+#elif defined(OS_OSX)
+# include <mach-o/dyld.h>
+#else
+# include <unistd.h>
+#endif
 
 namespace Argonauts {
 namespace Util {
@@ -39,10 +48,10 @@ std::string readFile(const std::string &filename)
 		throw Exception(std::string("Unable to open file '") + filename + "' for reading");
 	}
 	stream.seekg(0, std::ios_base::beg);
-	char *buf = new char[std::size_t(length)];
-	stream.read(buf, length);
+	std::string out(std::size_t(length), '\0');
+	stream.read(&out[0], length);
 	stream.close();
-	return std::string(buf, std::size_t(length));
+	return out;
 }
 
 void writeFile(const std::string &filename, const std::string &data)
@@ -56,6 +65,34 @@ void writeFile(const std::string &filename, const std::string &data)
 	stream.close();
 }
 
+bool writeFileIfChanged(const std::string &filename, const std::string &data)
+{
+	std::ifstream existing(filename, std::ios_base::binary | std::ios_base::ate);
+	if (existing.is_open() && existing.tellg() == std::streamoff(data.size())) {
+		existing.close();
+		if (readFile(filename) == data) {
+			return false;
+		}
+	}
+	writeFile(filename, data);
+	return true;
+}
+
+std::string executablePath()
+{
+	char buffer[4096];
+#if defined(OS_WINDOWS)
+	const DWORD length = GetModuleFileNameA(nullptr, buffer, sizeof(buffer));
+	return length > 0 && length < sizeof(buffer) ? std::string(buffer, length) : std::string();
+#elif defined(OS_OSX)
+	uint32_t size = sizeof(buffer);
+	return _NSGetExecutablePath(buffer, &size) == 0 ? std::string(buffer) : std::string();
+#else
+	const ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer));
+	return length > 0 && std::size_t(length) < sizeof(buffer) ? std::string(buffer, std::size_t(length)) : std::string();
+#endif
+}
+
 }
 }
 }
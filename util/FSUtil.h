@@ -24,6 +24,10 @@ namespace FS {
 
 std::string readFile(const std::string &filename);
 void writeFile(const std::string &filename, const std::string &data);
+/// Leaves the file (and its modification time) untouched if it already has the given content. Returns true if it was written
+bool writeFileIfChanged(const std::string &filename, const std::string &data);
+/// Path of the executable of the current process, or an empty string if it can not be determined
+std::string executablePath();
 
 }
 }
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Instrumentation.h"
+
+namespace Argonauts {
+namespace Util {
+namespace Instrumentation {
+namespace detail {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+static Callback callback;
+#pragma clang diagnostic pop
+
+Stats &current()
+{
+	static thread_local Stats stats;
+	return stats;
+}
+void updateDepth(const std::size_t depth)
+{
+	Stats &stats = current();
+	if (depth > stats.maxDepth) {
+		stats.maxDepth = depth;
+	}
+}
+void recordType(const char *type, const std::uint64_t nanoseconds)
+{
+	TypeStats &stats = current().types[type];
+	++stats.count;
+	stats.nanoseconds += nanoseconds;
+
+	if (callback) {
+		callback(type, nanoseconds);
+	}
+}
+}
+
+Stats stats()
+{
+	return detail::current();
+}
+void reset()
+{
+	detail::current() = Stats();
+}
+void setCallback(const Callback &callback)
+{
+	detail::callback = callback;
+}
+}
+}
+}
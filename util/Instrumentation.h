@@ -0,0 +1,111 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace Argonauts {
+namespace Util {
+/* Counters for the parse path, to see where time and memory goes without a profiler. Collection is compiled in only if
+ * ARGONAUTS_INSTRUMENTATION is defined (see the CMake option of the same name), otherwise all macros below expand to
+ * nothing and stats() stays empty.
+ *
+ * Counters are kept per thread, stats() and reset() only apply to the calling thread.
+ */
+namespace Instrumentation {
+struct TypeStats
+{
+	std::uint64_t count = 0;
+	std::uint64_t nanoseconds = 0; ///< Spent in the callbacks of the sinks of the type, including nested values
+};
+
+struct Stats
+{
+	std::uint64_t bytes = 0; ///< Given to a JSON reader
+	std::uint64_t tokens = 0; ///< Values, keys and container starts/ends emitted by a JSON reader
+	std::uint64_t skippedBytes = 0; ///< Passed over by a JSON reader because a sink asked to skip a value
+	std::uint64_t allocations = 0; ///< Sinks allocated for nested values
+	std::uint64_t delegations = 0; ///< Calls to delegateToObject/delegateToArray
+	std::uint64_t maxDepth = 0;
+	std::unordered_map<std::string, TypeStats> types;
+};
+
+Stats stats();
+void reset();
+
+/// Called (on the parsing thread) each time a value of a generated type has been parsed. Not synchronized, so set it
+/// before starting to parse
+using Callback = std::function<void(const char *type, const std::uint64_t nanoseconds)>;
+void setCallback(const Callback &callback);
+
+namespace detail {
+Stats &current();
+void updateDepth(const std::size_t depth);
+void recordType(const char *type, const std::uint64_t nanoseconds);
+
+// adds up the time spent in the callbacks of the DelegatingSaxSink it is a member of, which includes the values the
+// sink delegates to others, and records it once the sink is destroyed. Time between callbacks, like waiting for more
+// input, is not counted
+class TypeTimer
+{
+	const char *m_type;
+	std::uint64_t m_nanoseconds = 0;
+public:
+	explicit TypeTimer(const char *type, TypeTimer *&sinkTimer) : m_type(type) { sinkTimer = this; }
+	~TypeTimer() { recordType(m_type, m_nanoseconds); }
+
+	// measures one callback, if there is a timer
+	class Scope
+	{
+		TypeTimer *m_timer;
+		std::chrono::steady_clock::time_point m_start;
+	public:
+		explicit Scope(TypeTimer *timer) : m_timer(timer)
+		{
+			if (m_timer) {
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+		~Scope()
+		{
+			if (m_timer) {
+				m_timer->m_nanoseconds += std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+			}
+		}
+	};
+};
+}
+}
+}
+}
+
+#ifdef ARGONAUTS_INSTRUMENTATION
+# define ARGONAUTS_COUNT(COUNTER, AMOUNT) ::Argonauts::Util::Instrumentation::detail::current().COUNTER += std::uint64_t(AMOUNT)
+# define ARGONAUTS_DEPTH(DEPTH) ::Argonauts::Util::Instrumentation::detail::updateDepth(DEPTH)
+# define ARGONAUTS_TYPE_TIMER(TYPE) ::Argonauts::Util::Instrumentation::detail::TypeTimer m_argonautsTypeTimer{TYPE, m_typeTimer}
+# define ARGONAUTS_TYPE_SCOPE(TIMER) const ::Argonauts::Util::Instrumentation::detail::TypeTimer::Scope argonautsTypeScope(TIMER)
+#else
+# define ARGONAUTS_COUNT(COUNTER, AMOUNT) do {} while (false)
+# define ARGONAUTS_DEPTH(DEPTH) do {} while (false)
+# define ARGONAUTS_TYPE_TIMER(TYPE) static_assert(true, "")
+# define ARGONAUTS_TYPE_SCOPE(TIMER) do {} while (false)
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OutputStream.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "OsUtil.h"
+
+#ifdef OS_WINDOWS
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+namespace Argonauts {
+namespace Util {
+constexpr std::size_t BufferedOutputStream::defaultBufferSize;
+
+BufferedOutputStream::BufferedOutputStream(const std::size_t bufferSize)
+	: m_buffer(new char[bufferSize]), m_capacity(bufferSize) {}
+
+bool BufferedOutputStream::write(const char *data, const std::size_t size)
+{
+	if (m_failed) {
+		return false;
+	}
+	if (m_size + size <= m_capacity) {
+		std::memcpy(m_buffer.get() + m_size, data, size);
+		m_size += size;
+		return true;
+	}
+	if (!flush()) {
+		return false;
+	}
+	// no point in copying something that does not fit into the buffer anyway
+	if (size >= m_capacity) {
+		m_failed = !writeChunk(data, size);
+		return !m_failed;
+	}
+	std::memcpy(m_buffer.get(), data, size);
+	m_size = size;
+	return true;
+}
+bool BufferedOutputStream::write(const char c)
+{
+	if (m_failed || (m_size == m_capacity && !flush())) {
+		return false;
+	}
+	m_buffer[m_size++] = c;
+	return true;
+}
+
+bool BufferedOutputStream::flush()
+{
+	if (m_failed) {
+		return false;
+	}
+	if (m_size > 0) {
+		m_failed = !writeChunk(m_buffer.get(), m_size);
+		m_size = 0;
+	}
+	return !m_failed;
+}
+
+bool FileDescriptorOutputStream::writeChunk(const char *data, const std::size_t size)
+{
+	std::size_t written = 0;
+	while (written < size) {
+#ifdef OS_WINDOWS
+		const int result = ::_write(m_fd, data + written, unsigned(size - written));
+#else
+		const ssize_t result = ::write(m_fd, data + written, size - written);
+#endif
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		written += std::size_t(result);
+	}
+	return true;
+}
+
+bool StdOutputStream::writeChunk(const char *data, const std::size_t size)
+{
+	m_stream.write(data, std::streamsize(size));
+	return m_stream.good();
+}
+}
+}
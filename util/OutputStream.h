@@ -0,0 +1,126 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <functional>
+#include <memory>
+#include <ostream>
+
+namespace Argonauts {
+namespace Util {
+/// Receiver of serialized data. write returns false if the data could not be accepted, at which point the producer should stop
+class OutputStream
+{
+public:
+	virtual ~OutputStream() {}
+	virtual bool write(const std::string &string) = 0;
+	virtual bool write(const char *data, const std::size_t size) { return write(std::string(data, size)); }
+	virtual bool write(const char c) { return write(&c, 1); }
+};
+class StringOutputStream : public OutputStream
+{
+	std::string *m_str;
+	const bool m_owned;
+public:
+	explicit StringOutputStream(std::string *string = nullptr)
+		: m_str(string ? string : new std::string()), m_owned(!string) {}
+	~StringOutputStream()
+	{
+		if (m_owned) {
+			delete m_str;
+		}
+	}
+	using OutputStream::write;
+	inline bool write(const std::string &string) override { *m_str += string; return true; }
+	inline bool write(const char *data, const std::size_t size) override { m_str->append(data, size); return true; }
+	const std::string result() const { return *m_str; }
+};
+
+/* Collects writes in a fixed size buffer and hands it on in chunks whenever it fills up, so that the amount of memory
+ * needed does not depend on the size of the document. Subclasses decide where the chunks go, and have to call flush
+ * from their destructor
+ */
+class BufferedOutputStream : public OutputStream
+{
+	std::unique_ptr<char[]> m_buffer;
+	const std::size_t m_capacity;
+	std::size_t m_size = 0;
+	bool m_failed = false;
+
+public:
+	static constexpr std::size_t defaultBufferSize = 64 * 1024;
+
+	explicit BufferedOutputStream(const std::size_t bufferSize = defaultBufferSize);
+
+	using OutputStream::write;
+	bool write(const std::string &string) override { return write(string.data(), string.size()); }
+	bool write(const char *data, const std::size_t size) override;
+	bool write(const char c) override;
+
+	/// Hands on everything that has been buffered so far
+	bool flush();
+	/// True once the receiving end has refused a chunk, all further writes will fail
+	bool hasFailed() const { return m_failed; }
+
+protected:
+	virtual bool writeChunk(const char *data, const std::size_t size) = 0;
+};
+
+/// Writes to a file descriptor, which is not closed by the stream
+class FileDescriptorOutputStream : public BufferedOutputStream
+{
+	const int m_fd;
+public:
+	explicit FileDescriptorOutputStream(const int fd, const std::size_t bufferSize = defaultBufferSize)
+		: BufferedOutputStream(bufferSize), m_fd(fd) {}
+	~FileDescriptorOutputStream() { flush(); }
+
+protected:
+	bool writeChunk(const char *data, const std::size_t size) override;
+};
+
+/// Passes each chunk on to a function, which can return false to stop the producer
+class CallbackOutputStream : public BufferedOutputStream
+{
+public:
+	using Callback = std::function<bool(const char *data, const std::size_t size)>;
+
+	explicit CallbackOutputStream(const Callback &callback, const std::size_t bufferSize = defaultBufferSize)
+		: BufferedOutputStream(bufferSize), m_callback(callback) {}
+	~CallbackOutputStream() { flush(); }
+
+protected:
+	bool writeChunk(const char *data, const std::size_t size) override { return m_callback(data, size); }
+
+private:
+	Callback m_callback;
+};
+
+class StdOutputStream : public BufferedOutputStream
+{
+	std::ostream &m_stream;
+public:
+	explicit StdOutputStream(std::ostream &stream, const std::size_t bufferSize = defaultBufferSize)
+		: BufferedOutputStream(bufferSize), m_stream(stream) {}
+	~StdOutputStream() { flush(); }
+
+protected:
+	bool writeChunk(const char *data, const std::size_t size) override;
+};
+}
+}
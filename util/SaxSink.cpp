@@ -17,126 +17,194 @@
 #include "SaxSink.h"
 
 #include "Util.h"
+#include "Instrumentation.h"
+#include "json/JsonSaxReader.h"
 
 namespace Argonauts {
 namespace Util {
 
+bool SaxSink::rawValue(const std::string &json)
+{
+	return Json::readValue(json, this);
+}
+
 bool DelegatingSaxSink::null()
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->null());
+	} else if (m_skip != Skip::None) {
+		return swallow(0);
 	} else {
 		return nullImpl();
 	}
 }
 bool DelegatingSaxSink::boolean(const bool val)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->boolean(val));
+	} else if (m_skip != Skip::None) {
+		return swallow(0);
 	} else {
 		return booleanImpl(val);
 	}
 }
 bool DelegatingSaxSink::integerNumber(const int64_t val)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->integerNumber(val));
+	} else if (m_skip != Skip::None) {
+		return swallow(0);
 	} else {
 		return integerNumberImpl(val);
 	}
 }
 bool DelegatingSaxSink::doubleNumber(const double val)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->doubleNumber(val));
+	} else if (m_skip != Skip::None) {
+		return swallow(0);
 	} else {
 		return doubleNumberImpl(val);
 	}
 }
 bool DelegatingSaxSink::string(const std::string &str)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->string(str));
+	} else if (m_skip != Skip::None) {
+		return swallow(0);
 	} else {
 		return stringImpl(str);
 	}
 }
 bool DelegatingSaxSink::startObject()
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	++m_nestingLevelCounter;
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->startObject());
+	} else if (m_skip != Skip::None) {
+		return swallow(1);
 	} else {
 		return startObjectImpl();
 	}
 }
 bool DelegatingSaxSink::key(const std::string &str)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->key(str));
+	} else if (m_skip != Skip::None) {
+		return true;
 	} else {
 		return keyImpl(str);
 	}
 }
 bool DelegatingSaxSink::endObject(const std::size_t size)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		const bool res = reportErrorIfFalse(m_delegatingTo->endObject(size));
 		--m_nestingLevelCounter;
 		if (m_nestingLevelCounter == 0)
 		{
-			delete m_delegatingTo;
-			m_delegatingTo = nullptr;
+			m_delegatingTo.reset();
+			return res && delegationFinishedImpl();
 		}
 		return res;
+	} else if (m_skip != Skip::None) {
+		return swallow(-1);
 	} else {
 		return endObjectImpl(size);
 	}
 }
 bool DelegatingSaxSink::startArray()
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	++m_nestingLevelCounter;
 	if (m_delegatingTo) {
 		return reportErrorIfFalse(m_delegatingTo->startArray());
+	} else if (m_skip != Skip::None) {
+		return swallow(1);
 	} else {
 		return startArrayImpl();
 	}
 }
 bool DelegatingSaxSink::endArray(const std::size_t size)
 {
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
 	if (m_delegatingTo) {
 		const bool res = reportErrorIfFalse(m_delegatingTo->endArray(size));
 		--m_nestingLevelCounter;
 		if (m_nestingLevelCounter == 0)
 		{
-			delete m_delegatingTo;
-			m_delegatingTo = nullptr;
+			m_delegatingTo.reset();
+			return res && delegationFinishedImpl();
 		}
 		return res;
+	} else if (m_skip != Skip::None) {
+		return swallow(-1);
 	} else {
 		return endArrayImpl(size);
 	}
 }
 
+SaxSink::Skip DelegatingSaxSink::skipValue()
+{
+	if (m_delegatingTo) {
+		return m_delegatingTo->skipValue();
+	} else {
+		return m_skip;
+	}
+}
+bool DelegatingSaxSink::skipped(const std::string &raw)
+{
+	ARGONAUTS_TYPE_SCOPE(m_typeTimer);
+	if (m_delegatingTo) {
+		return reportErrorIfFalse(m_delegatingTo->skipped(raw));
+	} else {
+		m_skip = Skip::None;
+		return skippedImpl(raw);
+	}
+}
+
 bool DelegatingSaxSink::reportErrorIfFalse(const bool value)
 {
 	if (!value) {
-		reportError(m_delegatingTo->error().c_str());
+		reportError(m_delegatingTo->error());
 	}
 	return value;
 }
 
+// a value that was supposed to be skipped, but is sent anyway by a source that can not skip
+bool DelegatingSaxSink::swallow(const int depthChange)
+{
+	m_skipDepth += depthChange;
+	if (m_skipDepth == 0) {
+		m_skip = Skip::None;
+	}
+	return true;
+}
+
 void DelegatingSaxSink::delegateToArray(SaxSink *handler)
 {
 	ASSERT(handler);
-	m_delegatingTo = handler;
+	ARGONAUTS_COUNT(delegations, 1);
+	m_delegatingTo.reset(handler);
 	m_delegatingTo->startArray();
 	m_nestingLevelCounter = 1;
 }
 void DelegatingSaxSink::delegateToObject(SaxSink *handler)
 {
 	ASSERT(handler);
-	m_delegatingTo = handler;
+	ARGONAUTS_COUNT(delegations, 1);
+	m_delegatingTo.reset(handler);
 	m_delegatingTo->startObject();
 	m_nestingLevelCounter = 1;
 }
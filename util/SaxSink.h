@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace Argonauts {
 namespace Util {
+namespace Instrumentation { namespace detail { class TypeTimer; } }
 
 class SaxSink
 {
@@ -38,6 +40,20 @@ public:
 	virtual bool startArray() = 0;
 	virtual bool endArray(const std::size_t size) = 0;
 
+	enum class Skip
+	{
+		None,
+		Discard,
+		Keep ///< like Discard, but pass the raw text of the value to skipped()
+	};
+	/// Asked by readers right after key(). Anything but Skip::None makes readers that support it pass over the value of
+	/// the key without sending any events for it, and call skipped() once it is complete instead
+	virtual Skip skipValue() { return Skip::None; }
+	virtual bool skipped(const std::string &raw) { (void)raw; return true; }
+	/// A complete value given as JSON text, like the raw text passed to skipped(). By default it is read and its events
+	/// are sent to this sink, sinks that write JSON can instead pass it on unchanged
+	virtual bool rawValue(const std::string &json);
+
 	std::string error() const { return m_error; }
 
 protected:
@@ -64,8 +80,10 @@ private:
 
 class DelegatingSaxSink : public SaxSink
 {
-	SaxSink *m_delegatingTo = nullptr;
+	std::unique_ptr<SaxSink> m_delegatingTo;
 	int m_nestingLevelCounter = 0;
+	Skip m_skip = Skip::None;
+	int m_skipDepth = 0;
 public:
 	virtual ~DelegatingSaxSink() {}
 
@@ -80,8 +98,11 @@ private:
 	bool endObject(const std::size_t size) override final;
 	bool startArray() override final;
 	bool endArray(const std::size_t size) override final;
+	Skip skipValue() override final;
+	bool skipped(const std::string &raw) override final;
 
 	bool reportErrorIfFalse(const bool value);
+	bool swallow(const int depthChange);
 
 protected:
 	virtual bool nullImpl() = 0;
@@ -94,9 +115,22 @@ protected:
 	virtual bool endObjectImpl(const std::size_t size) = 0;
 	virtual bool startArrayImpl() = 0;
 	virtual bool endArrayImpl(const std::size_t size) = 0;
+	/// Called once the sink delegated to has received the end of its object or array
+	virtual bool delegationFinishedImpl() { return true; }
+	/// Called instead of the *Impl functions for a value skipped through skipNextValue()
+	virtual bool skippedImpl(const std::string &raw) { (void)raw; return true; }
 
+	/// Sends all events up to the end of the current object or array to handler, which has to be allocated with new.
+	/// This sink owns it from then on, and deletes it once the container ends or when this sink is destroyed before that,
+	/// for example after parsing stopped on an error
 	void delegateToObject(SaxSink *handler);
 	void delegateToArray(SaxSink *handler);
+	/// Skips the value of the key keyImpl() has just been called for. If the source of the events can not skip it,
+	/// its events are dropped here instead, and skippedImpl() is not called
+	void skipNextValue(const Skip skip) { m_skip = skip; }
+
+	/// Set by ARGONAUTS_TYPE_TIMER, measures the time spent in the callbacks of this sink
+	Instrumentation::detail::TypeTimer *m_typeTimer = nullptr;
 };
 }
 }
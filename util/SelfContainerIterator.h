@@ -33,7 +33,7 @@ class SelfContainedIterator
 
 public:
 	inline explicit SelfContainedIterator(const T &c)
-		: container(c), it(std::begin(c)) {}
+		: container(c), it(std::begin(container)) {}
 	inline void toFront() { it = std::begin(container); }
 	inline void toBack() { it = std::end(container); }
 	inline bool hasNext() const { return it != std::end(container); }
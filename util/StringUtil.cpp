@@ -16,6 +16,7 @@
 
 #include "StringUtil.h"
 
+#include <cstring>
 #include <iostream>
 #include <algorithm>
 
@@ -93,8 +94,8 @@ StringVector splitStrings(const std::string &string, const std::string &delimite
 	std::vector<std::string> out;
 	while (index != std::string::npos) {
 		out.push_back(string.substr(prevIndex, index - prevIndex));
-		prevIndex = index + 1;
-		index = string.find(delimiter, index + 1);
+		prevIndex = index + delimiter.size();
+		index = string.find(delimiter, prevIndex);
 	}
 	out.push_back(string.substr(prevIndex));
 
@@ -110,6 +111,101 @@ bool endsWith(const std::string &str, const std::string &match)
 	return str.rfind(match) == match.size();
 }
 
+uint64_t contentHash(const std::string &data)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const char c : data) {
+		hash ^= uint8_t(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+std::string toHexString(const uint64_t value)
+{
+	std::string out;
+	for (int shift = 56; shift >= 0; shift -= 8) {
+		out += charToHexString(char((value >> shift) & 0xff));
+	}
+	return out;
+}
+
+bool isValidUtf8(const char *data, const std::size_t size)
+{
+	const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+	std::size_t i = 0;
+	while (i < size) {
+		// skip ASCII a word at a time
+		while (i + 8 <= size) {
+			uint64_t word;
+			std::memcpy(&word, bytes + i, 8);
+			if (word & 0x8080808080808080ull) {
+				break;
+			}
+			i += 8;
+		}
+		if (i >= size) {
+			break;
+		}
+
+		const unsigned char lead = bytes[i];
+		if (lead < 0x80) {
+			++i;
+			continue;
+		}
+		std::size_t length;
+		// allowed range of the second byte, narrower than 80..BF where needed to exclude overlong forms, surrogates
+		// and code points above U+10FFFF
+		unsigned char min = 0x80, max = 0xbf;
+		if (lead >= 0xc2 && lead <= 0xdf) {
+			length = 2;
+		} else if (lead >= 0xe0 && lead <= 0xef) {
+			length = 3;
+			if (lead == 0xe0) {
+				min = 0xa0;
+			} else if (lead == 0xed) {
+				max = 0x9f;
+			}
+		} else if (lead >= 0xf0 && lead <= 0xf4) {
+			length = 4;
+			if (lead == 0xf0) {
+				min = 0x90;
+			} else if (lead == 0xf4) {
+				max = 0x8f;
+			}
+		} else {
+			return false;
+		}
+		if (size - i < length || bytes[i + 1] < min || bytes[i + 1] > max) {
+			return false;
+		}
+		for (std::size_t j = 2; j < length; ++j) {
+			if ((bytes[i + j] & 0xc0) != 0x80) {
+				return false;
+			}
+		}
+		i += length;
+	}
+	return true;
+}
+void appendUtf8(std::string &out, const uint32_t codePoint)
+{
+	if (codePoint < 0x80) {
+		out += char(codePoint);
+	} else if (codePoint < 0x800) {
+		out += char(0xc0 | (codePoint >> 6));
+		out += char(0x80 | (codePoint & 0x3f));
+	} else if (codePoint < 0x10000) {
+		out += char(0xe0 | (codePoint >> 12));
+		out += char(0x80 | ((codePoint >> 6) & 0x3f));
+		out += char(0x80 | (codePoint & 0x3f));
+	} else {
+		out += char(0xf0 | (codePoint >> 18));
+		out += char(0x80 | ((codePoint >> 12) & 0x3f));
+		out += char(0x80 | ((codePoint >> 6) & 0x3f));
+		out += char(0x80 | (codePoint & 0x3f));
+	}
+}
+
 }
 }
 }
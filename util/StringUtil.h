@@ -18,6 +18,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 using StringVector = std::vector<std::string>;
 
@@ -32,6 +33,17 @@ std::string toUpper(const std::string &in);
 std::string firstLine(const std::string &in);
 bool startsWith(const std::string &str, const std::string &match);
 bool endsWith(const std::string &str, const std::string &match);
+
+// 64 bit FNV-1a, stable across platforms and runs (unlike std::hash), for use in on-disk caches
+uint64_t contentHash(const std::string &data);
+std::string toHexString(const uint64_t value);
+
+// true if the data is well-formed UTF-8 (no overlong forms, surrogates or code points above U+10FFFF). runs of ASCII
+// are checked eight bytes at a time, so this is cheap enough to do on all input
+bool isValidUtf8(const char *data, const std::size_t size);
+inline bool isValidUtf8(const std::string &str) { return isValidUtf8(str.data(), str.size()); }
+// appends the UTF-8 encoding of the code point, which has to be a valid scalar value
+void appendUtf8(std::string &out, const uint32_t codePoint);
 }
 }
 }
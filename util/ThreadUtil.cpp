@@ -0,0 +1,80 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ThreadUtil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Argonauts {
+namespace Util {
+namespace Thread {
+
+int defaultConcurrency()
+{
+	const unsigned int concurrency = std::thread::hardware_concurrency();
+	return concurrency == 0 ? 1 : int(concurrency);
+}
+
+void parallelFor(const std::size_t count, const int threads, const std::function<void(const std::size_t)> &func)
+{
+	const std::size_t numThreads = std::min(std::size_t(threads > 0 ? threads : defaultConcurrency()), count);
+	if (numThreads <= 1) {
+		for (std::size_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::atomic<std::size_t> next(0);
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto worker = [&]()
+	{
+		std::size_t index;
+		while ((index = next++) < count) {
+			try {
+				func(index);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+				next = count;
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < numThreads; ++i) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (std::thread &thread : pool) {
+		thread.join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+}
+}
+}
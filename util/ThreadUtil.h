@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015 Jan Dalheimer <jan@dalheimer.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace Argonauts {
+namespace Util {
+namespace Thread {
+
+/// The number of threads to use if the user did not ask for a specific number
+int defaultConcurrency();
+
+/// Calls func for every index in [0, count) using up to threads threads (<= 0 means defaultConcurrency()), including the
+/// calling one. Returns once all calls are done. If a call throws, no new calls are started and the first exception is
+/// rethrown.
+void parallelFor(const std::size_t count, const int threads, const std::function<void(const std::size_t index)> &func);
+
+}
+}
+}
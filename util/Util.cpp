@@ -18,14 +18,12 @@
 
 #include <iostream>
 
-void Argonauts::Util::assert(const bool condition, const char *condString, const char *file, const int line, const std::string &message)
+void Argonauts::Util::assertFailed(const char *condString, const char *file, const int line, const std::string &message)
 {
-	if (!condition) {
-		std::cerr << "Assertion failed: " << condString << " == false at " << file << ":" << line;
-		if (!message.empty()) {
-			std::cerr << " (" << message << ")";
-		}
-		std::cerr << "\n" << std::flush;
-		std::abort();
+	std::cerr << "Assertion failed: " << condString << " == false at " << file << ":" << line;
+	if (!message.empty()) {
+		std::cerr << " (" << message << ")";
 	}
+	std::cerr << "\n" << std::flush;
+	std::abort();
 }
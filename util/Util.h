@@ -20,9 +20,10 @@
 
 namespace Argonauts {
 namespace Util {
-void assert(const bool condition, const char *condString, const char *file, const int line, const std::string &message);
+/// Not called assert, as that is a macro as soon as anything includes <assert.h>
+[[noreturn]] void assertFailed(const char *condString, const char *file, const int line, const std::string &message);
 }
 }
 
-#define ASSERT(condition) ::Argonauts::Util::assert(condition, #condition, __FILE__, __LINE__, std::string());
-#define ASSERT_X(condition, message) ::Argonauts::Util::assert(condition, #condition, __FILE__, __LINE__, message);
+#define ASSERT(condition) ((condition) ? (void)0 : ::Argonauts::Util::assertFailed(#condition, __FILE__, __LINE__, std::string()));
+#define ASSERT_X(condition, message) ((condition) ? (void)0 : ::Argonauts::Util::assertFailed(#condition, __FILE__, __LINE__, message));
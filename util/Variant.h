@@ -18,77 +18,47 @@
 
 #include <type_traits>
 #include <stdexcept>
+#include <cstring>
+#include <tuple>
+#include <utility>
 
 namespace Argonauts {
 namespace Util {
 namespace detail {
 
-template <std::size_t N, typename... Types>
-struct TypeHelper;
-template <std::size_t N, typename T, typename... Types>
-struct TypeHelper<N, T&, Types...>
+// one instantiation of each of these per alternative, Variant keeps pointers to them in tables indexed by the active
+// alternative, so that every operation is a single indirect call instead of a chain of comparisons
+template <typename T>
+void destroyAlternative(void *data)
 {
-	static inline void doDelete(std::size_t, void *) {}
-	static inline void doCopy(std::size_t, const void *, void *) {}
-	static inline void doMove(std::size_t, void *, void *) {}
-	static inline bool doCompare(std::size_t, const void *, const void *) {}
-};
-template <std::size_t N, typename T, typename... Types>
-struct TypeHelper<N, T, Types...>
+	reinterpret_cast<T *>(data)->~T();
+}
+template <typename T>
+void copyAlternative(const void *from, void *to)
 {
-	static inline void doDelete(std::size_t index, void *data)
-	{
-		if (index == N) {
-			reinterpret_cast<T *>(data)->~T();
-		} else {
-			TypeHelper<N + 1, Types...>::doDelete(index, data);
-		}
-	}
-	static inline void doCopy(std::size_t index, const void *oldData, void *newData)
-	{
-		if (index == N) {
-			new (newData) T(*reinterpret_cast<const T *>(oldData));
-		} else {
-			TypeHelper<N + 1, Types...>::doCopy(index, oldData, newData);
-		}
-	}
-	static inline void doMove(std::size_t index, void *oldData, void *newData)
-	{
-		if (index == N) {
-			new (newData) T(std::move(*reinterpret_cast<T *>(oldData)));
-		} else {
-			TypeHelper<N + 1, Types...>::doMove(index, oldData, newData);
-		}
-	}
-	static inline bool doCompare(std::size_t index, const void *a, const void *b)
-	{
-		if (index == N) {
-			return *reinterpret_cast<const T *>(a) == *reinterpret_cast<const T *>(b);
-		} else {
-			return TypeHelper<N + 1, Types...>::doCompare(index, a, b);
-		}
-	}
-};
-template <std::size_t N>
-struct TypeHelper<N>
+	new (to) T(*reinterpret_cast<const T *>(from));
+}
+template <typename T>
+void moveAlternative(void *from, void *to)
 {
-	static inline void doDelete(std::size_t, void *)
-	{
-		throw std::logic_error("Invalid variant index");
-	}
-	static inline void doCopy(std::size_t, const void *, void *)
-	{
-		throw std::logic_error("Invalid variant index");
-	}
-	static inline void doMove(std::size_t, void *, void *)
-	{
-		throw std::logic_error("Invalid variant index");
-	}
-	static inline bool doCompare(std::size_t, const void *, const void *)
-	{
-		throw std::logic_error("Invalid variant index");
-	}
-};
+	new (to) T(std::move(*reinterpret_cast<T *>(from)));
+}
+template <typename T>
+bool compareAlternative(const void *a, const void *b)
+{
+	return *reinterpret_cast<const T *>(a) == *reinterpret_cast<const T *>(b);
+}
+
+template <typename Result, typename T, typename Visitor>
+Result visitAlternative(Visitor &visitor, void *data)
+{
+	return visitor(*reinterpret_cast<T *>(data));
+}
+template <typename Result, typename T, typename Visitor>
+Result visitConstAlternative(Visitor &visitor, const void *data)
+{
+	return visitor(*reinterpret_cast<const T *>(data));
+}
 
 template <typename Type, typename... Types>
 struct Position;
@@ -107,6 +77,11 @@ struct Position<Needle, Type, Types...>
 {
 	static constexpr int index = Position<Needle, Types...>::index != -1 ? Position<Needle, Types...>::index + 1 : -1;
 };
+
+template <bool...>
+struct BoolPack;
+template <bool... Values>
+using AllOf = std::is_same<BoolPack<Values..., true>, BoolPack<true, Values...>>;
 }
 
 template <typename... Types>
@@ -117,7 +92,12 @@ class Variant
 
 	template <typename T>
 	using Position = detail::Position<T, Types...>;
-	using TypeHelper = detail::TypeHelper<0, Types...>;
+	using First = typename std::tuple_element<0, std::tuple<Types...>>::type;
+
+	// no destructor to call and bitwise copies, which is the case for most variants of scalars
+	static constexpr bool isTrivial = detail::AllOf<std::is_trivially_copyable<Types>::value...>::value
+			&& detail::AllOf<std::is_trivially_destructible<Types>::value...>::value;
+	static constexpr bool isNothrowMovable = detail::AllOf<std::is_nothrow_move_constructible<Types>::value...>::value;
 
 	template <typename T>
 	void initialize(const T &t)
@@ -128,24 +108,52 @@ class Variant
 
 	void deinit()
 	{
-		TypeHelper::doDelete(m_which, reinterpret_cast<void *>(&m_data));
+		if (!isTrivial) {
+			static constexpr void (*table[])(void *) = {&detail::destroyAlternative<Types>...};
+			table[m_which](&m_data);
+		}
+	}
+	void copyFrom(const Variant<Types...> &other)
+	{
+		m_which = other.m_which;
+		if (isTrivial) {
+			std::memcpy(&m_data, &other.m_data, sizeof(m_data));
+		} else {
+			static constexpr void (*table[])(const void *, void *) = {&detail::copyAlternative<Types>...};
+			table[m_which](&other.m_data, &m_data);
+		}
+	}
+	void moveFrom(Variant<Types...> &other)
+	{
+		m_which = other.m_which;
+		if (isTrivial) {
+			std::memcpy(&m_data, &other.m_data, sizeof(m_data));
+		} else {
+			static constexpr void (*table[])(void *, void *) = {&detail::moveAlternative<Types>...};
+			table[m_which](&other.m_data, &m_data);
+		}
 	}
 
 public:
 	// constructors and destructors
+	/// Holds a value-initialized instance of the first alternative
+	Variant()
+	{
+		initialize(First());
+	}
 	template <typename T>
 	Variant(const T &t)
 	{
 		static_assert(Position<T>::index != -1, "The given type does not exist in the variant");
 		initialize(t);
 	}
-	Variant(const Variant<Types...> &original) : m_which(original.m_which)
+	Variant(const Variant<Types...> &original)
 	{
-		TypeHelper::doCopy(m_which, &original.m_data, &m_data);
+		copyFrom(original);
 	}
-	Variant(Variant<Types...> &&original) : m_which(original.m_which)
+	Variant(Variant<Types...> &&original) noexcept(isNothrowMovable)
 	{
-		TypeHelper::doMove(m_which, &original.m_data, &m_data);
+		moveFrom(original);
 	}
 	~Variant()
 	{
@@ -163,15 +171,18 @@ public:
 	}
 	Variant<Types...> &operator=(const Variant<Types...> &other)
 	{
-		deinit();
-		m_which = other.m_which;
-		TypeHelper::doCopy(m_which, &other.m_data, &m_data);
+		if (this != &other) {
+			deinit();
+			copyFrom(other);
+		}
 		return *this;
 	}
-	Variant<Types...> &operator=(Variant<Types...> &&other)
+	Variant<Types...> &operator=(Variant<Types...> &&other) noexcept(isNothrowMovable)
 	{
-		std::swap(m_which, other.m_which);
-		std::swap(m_data, other.m_data);
+		if (this != &other) {
+			deinit();
+			moveFrom(other);
+		}
 		return *this;
 	}
 
@@ -181,16 +192,14 @@ public:
 		if (m_which != other.m_which) {
 			return false;
 		} else {
-			return TypeHelper::doCompare(m_which, &other.m_data, &m_data);
+			// not a memcmp even if trivial, padding and floating point values would compare wrong
+			static constexpr bool (*table[])(const void *, const void *) = {&detail::compareAlternative<Types>...};
+			return table[m_which](&other.m_data, &m_data);
 		}
 	}
 	bool operator!=(const Variant<Types...> &other) const
 	{
-		if (m_which != other.m_which) {
-			return true;
-		} else {
-			return !TypeHelper::doCompare(m_which, &other.m_data, &m_data);
-		}
+		return !(*this == other);
 	}
 
 	// accessors
@@ -221,6 +230,25 @@ public:
 		static_assert(Position<T>::index != -1, "The given type does not exist in the variant");
 		return m_which == Position<T>::index;
 	}
+	/// Index of the alternative currently held, in the order of the template arguments
+	std::size_t which() const { return m_which; }
+
+	/// Calls visitor with the value currently held. The visitor has to accept every alternative and return the same
+	/// type for all of them. Dispatch is a single indirect call through a table with one entry per alternative
+	template <typename Visitor>
+	decltype(auto) visit(Visitor &&visitor)
+	{
+		using Result = decltype(visitor(std::declval<First &>()));
+		static constexpr Result (*table[])(Visitor &, void *) = {&detail::visitAlternative<Result, Types, Visitor>...};
+		return table[m_which](visitor, &m_data);
+	}
+	template <typename Visitor>
+	decltype(auto) visit(Visitor &&visitor) const
+	{
+		using Result = decltype(visitor(std::declval<const First &>()));
+		static constexpr Result (*table[])(Visitor &, const void *) = {&detail::visitConstAlternative<Result, Types, Visitor>...};
+		return table[m_which](visitor, &m_data);
+	}
 };
 
 }
@@ -16,36 +16,359 @@
 
 #include "Json.h"
 
-#include <regex>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace Argonauts {
 namespace Util {
 namespace Json {
 namespace detail {
-static std::regex uriRegex()
+// Hand-written recognizer for the URI-reference production of RFC 3986. Each
+// function matches one production of the grammar starting at 'it' and, on
+// success, advances 'it' past the consumed input.
+using Iterator = std::string::const_iterator;
+
+static bool isAlpha(const char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+static bool isHexDigit(const char c) { return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+static bool isUnreserved(const char c)
+{
+	return isAlpha(c) || isDigit(c) || c == '-' || c == '.' || c == '_' || c == '~';
+}
+static bool isSubDelim(const char c)
+{
+	switch (c) {
+	case '!': case '$': case '&': case '\'': case '(': case ')':
+	case '*': case '+': case ',': case ';': case '=':
+		return true;
+	default:
+		return false;
+	}
+}
+
+// pct-encoded = "%" HEXDIG HEXDIG
+static bool matchPctEncoded(Iterator &it, const Iterator end)
+{
+	if ((end - it) >= 3 && *it == '%' && isHexDigit(*(it + 1)) && isHexDigit(*(it + 2))) {
+		it += 3;
+		return true;
+	}
+	return false;
+}
+// matches *( unreserved / pct-encoded / sub-delims / <extra> ), returns the number of characters consumed
+static std::size_t matchChars(Iterator &it, const Iterator end, const char *extra)
+{
+	const Iterator start = it;
+	while (it != end) {
+		const char c = *it;
+		if (isUnreserved(c) || isSubDelim(c) || std::char_traits<char>::find(extra, std::char_traits<char>::length(extra), c)) {
+			++it;
+		} else if (!matchPctEncoded(it, end)) {
+			break;
+		}
+	}
+	return std::size_t(it - start);
+}
+
+// dec-octet "." dec-octet "." dec-octet "." dec-octet
+static bool matchIPv4(Iterator &it, const Iterator end)
+{
+	Iterator cur = it;
+	for (int octet = 0; octet < 4; ++octet) {
+		if (octet > 0) {
+			if (cur == end || *cur != '.') {
+				return false;
+			}
+			++cur;
+		}
+		int value = 0;
+		int digits = 0;
+		while (cur != end && isDigit(*cur) && digits < 3) {
+			// leading zeros are not allowed by dec-octet
+			if (digits == 1 && value == 0) {
+				return false;
+			}
+			value = value * 10 + (*cur - '0');
+			++digits;
+			++cur;
+		}
+		if (digits == 0 || value > 255) {
+			return false;
+		}
+	}
+	it = cur;
+	return true;
+}
+// IPv6address, with at most one "::" and an optional trailing IPv4address
+static bool matchIPv6(Iterator &it, const Iterator end)
+{
+	Iterator cur = it;
+	int pieces = 0;
+	bool haveCompression = false;
+	if ((end - cur) >= 2 && *cur == ':' && *(cur + 1) == ':') {
+		haveCompression = true;
+		cur += 2;
+	}
+	while (cur != end && pieces < 8) {
+		Iterator ipv4 = cur;
+		if (pieces <= 6 && matchIPv4(ipv4, end) && (ipv4 == end || *ipv4 == ']')) {
+			cur = ipv4;
+			pieces += 2;
+			break;
+		}
+
+		int digits = 0;
+		while (cur != end && isHexDigit(*cur) && digits < 4) {
+			++cur;
+			++digits;
+		}
+		if (digits == 0) {
+			break;
+		}
+		++pieces;
+		if (cur == end || *cur != ':') {
+			break;
+		}
+		if ((end - cur) >= 2 && *(cur + 1) == ':') {
+			if (haveCompression) {
+				return false;
+			}
+			haveCompression = true;
+			cur += 2;
+		} else if (cur + 1 != end && isHexDigit(*(cur + 1))) {
+			++cur;
+		} else {
+			return false;
+		}
+	}
+	if (haveCompression ? pieces > 7 : pieces != 8) {
+		return false;
+	}
+	it = cur;
+	return true;
+}
+// IPvFuture = "v" 1*HEXDIG "." 1*( unreserved / sub-delims / ":" )
+static bool matchIPvFuture(Iterator &it, const Iterator end)
+{
+	Iterator cur = it;
+	if (cur == end || (*cur != 'v' && *cur != 'V')) {
+		return false;
+	}
+	++cur;
+	const Iterator hexStart = cur;
+	while (cur != end && isHexDigit(*cur)) {
+		++cur;
+	}
+	if (cur == hexStart || cur == end || *cur != '.') {
+		return false;
+	}
+	++cur;
+	const Iterator restStart = cur;
+	while (cur != end && (isUnreserved(*cur) || isSubDelim(*cur) || *cur == ':')) {
+		++cur;
+	}
+	if (cur == restStart) {
+		return false;
+	}
+	it = cur;
+	return true;
+}
+// authority = [ userinfo "@" ] host [ ":" port ]
+static bool matchAuthority(Iterator &it, const Iterator end)
+{
+	Iterator cur = it;
+	matchChars(cur, end, ":");
+	if (cur != end && *cur == '@') {
+		++cur;
+	} else {
+		cur = it;
+	}
+
+	if (cur != end && *cur == '[') {
+		++cur;
+		if (!matchIPv6(cur, end) && !matchIPvFuture(cur, end)) {
+			return false;
+		}
+		if (cur == end || *cur != ']') {
+			return false;
+		}
+		++cur;
+	} else {
+		// IPv4address is a subset of reg-name, so there is no need to try it separately
+		matchChars(cur, end, "");
+	}
+
+	if (cur != end && *cur == ':') {
+		++cur;
+		while (cur != end && isDigit(*cur)) {
+			++cur;
+		}
+	}
+	it = cur;
+	return true;
+}
+// *( "/" segment )
+static void matchPathAbEmpty(Iterator &it, const Iterator end)
 {
-	// http://jmrware.com/articles/2009/uri_regexp/URI_regex.html
+	while (it != end && *it == '/') {
+		++it;
+		matchChars(it, end, ":@");
+	}
+}
+// scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ), followed by ":"
+static bool matchScheme(Iterator &it, const Iterator end)
+{
+	Iterator cur = it;
+	if (cur == end || !isAlpha(*cur)) {
+		return false;
+	}
+	++cur;
+	while (cur != end && (isAlpha(*cur) || isDigit(*cur) || *cur == '+' || *cur == '-' || *cur == '.')) {
+		++cur;
+	}
+	if (cur == end || *cur != ':') {
+		return false;
+	}
+	it = cur + 1;
+	return true;
+}
+// hier-part / relative-part; the only difference is that the first segment of a relative path may not contain a colon
+static bool matchHierPart(Iterator &it, const Iterator end, const bool relative)
+{
+	if ((end - it) >= 2 && *it == '/' && *(it + 1) == '/') {
+		it += 2;
+		if (!matchAuthority(it, end)) {
+			return false;
+		}
+		matchPathAbEmpty(it, end);
+	} else if (it != end && *it == '/') {
+		// path-absolute
+		matchPathAbEmpty(it, end);
+	} else if (matchChars(it, end, relative ? "@" : ":@") > 0) {
+		// path-rootless / path-noscheme
+		matchPathAbEmpty(it, end);
+	}
+	// otherwise path-empty
+	return true;
+}
+// [ "?" query ] [ "#" fragment ]
+static void matchQueryAndFragment(Iterator &it, const Iterator end)
+{
+	if (it != end && *it == '?') {
+		++it;
+		matchChars(it, end, ":@/?");
+	}
+	if (it != end && *it == '#') {
+		++it;
+		matchChars(it, end, ":@/?");
+	}
+}
+
+static bool matchURI(Iterator &it, const Iterator end, const bool allowRelative)
+{
+	const bool haveScheme = matchScheme(it, end);
+	if (!haveScheme && !allowRelative) {
+		return false;
+	}
+	if (!matchHierPart(it, end, !haveScheme)) {
+		return false;
+	}
+	matchQueryAndFragment(it, end);
+	return true;
+}
+
+template <typename Func>
+static bool matchesCompletely(const std::string &string, Func &&func)
+{
+	Iterator it = string.begin();
+	return !string.empty() && func(it, string.end()) && it == string.end();
+}
+
+// compiling a std::regex is expensive, and schemas tend to reuse the same few patterns over and over again.
+// once full the least recently used pattern is dropped, regexCacheOrder has the most recently used one first
+struct CachedRegex
+{
+	std::shared_ptr<const std::regex> regex;
+	std::list<std::string>::iterator order;
+};
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wexit-time-destructors"
-	static std::regex regex(R"regex((?:[A-Za-z][A-Za-z0-9+\-.]*:(?://(?:(?:[A-Za-z0-9\-._~!$&'()*+,;=:]|%[0-9A-Fa-f]{2})*@)?(?:\[(?:(?:(?:(?:[0-9A-Fa-f]{1,4}:){6}|::(?:[0-9A-Fa-f]{1,4}:){5}|(?:[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){4}|(?:(?:[0-9A-Fa-f]{1,4}:){0,1}[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){3}|(?:(?:[0-9A-Fa-f]{1,4}:){0,2}[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){2}|(?:(?:[0-9A-Fa-f]{1,4}:){0,3}[0-9A-Fa-f]{1,4})?::[0-9A-Fa-f]{1,4}:|(?:(?:[0-9A-Fa-f]{1,4}:){0,4}[0-9A-Fa-f]{1,4})?::)(?:[0-9A-Fa-f]{1,4}:[0-9A-Fa-f]{1,4}|(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?))|(?:(?:[0-9A-Fa-f]{1,4}:){0,5}[0-9A-Fa-f]{1,4})?::[0-9A-Fa-f]{1,4}|(?:(?:[0-9A-Fa-f]{1,4}:){0,6}[0-9A-Fa-f]{1,4})?::)|[Vv][0-9A-Fa-f]+\.[A-Za-z0-9\-._~!$&'()*+,;=:]+)\]|(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)|(?:[A-Za-z0-9\-._~!$&'()*+,;=]|%[0-9A-Fa-f]{2})*)(?::[0-9]*)?(?:/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})*)*|/(?:(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})+(?:/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})*)*)?|(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})+(?:/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})*)*|)(?:\?(?:[A-Za-z0-9\-._~!$&'()*+,;=:@/?]|%[0-9A-Fa-f]{2})*)?(?:\#(?:[A-Za-z0-9\-._~!$&'()*+,;=:@/?]|%[0-9A-Fa-f]{2})*)?|(?://(?:(?:[A-Za-z0-9\-._~!$&'()*+,;=:]|%[0-9A-Fa-f]{2})*@)?(?:\[(?:(?:(?:(?:[0-9A-Fa-f]{1,4}:){6}|::(?:[0-9A-Fa-f]{1,4}:){5}|(?:[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){4}|(?:(?:[0-9A-Fa-f]{1,4}:){0,1}[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){3}|(?:(?:[0-9A-Fa-f]{1,4}:){0,2}[0-9A-Fa-f]{1,4})?::(?:[0-9A-Fa-f]{1,4}:){2}|(?:(?:[0-9A-Fa-f]{1,4}:){0,3}[0-9A-Fa-f]{1,4})?::[0-9A-Fa-f]{1,4}:|(?:(?:[0-9A-Fa-f]{1,4}:){0,4}[0-9A-Fa-f]{1,4})?::)(?:[0-9A-Fa-f]{1,4}:[0-9A-Fa-f]{1,4}|(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?))|(?:(?:[0-9A-Fa-f]{1,4}:){0,5}[0-9A-Fa-f]{1,4})?::[0-9A-Fa-f]{1,4}|(?:(?:[0-9A-Fa-f]{1,4}:){0,6}[0-9A-Fa-f]{1,4})?::)|[Vv][0-9A-Fa-f]+\.[A-Za-z0-9\-._~!$&'()*+,;=:]+)\]|(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)|(?:[A-Za-z0-9\-._~!$&'()*+,;=]|%[0-9A-Fa-f]{2})*)(?::[0-9]*)?(?:/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})*)*|/(?:(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})+(?:/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})*)*)?|(?:[A-Za-z0-9\-._~!$&'()*+,;=@]|%[0-9A-Fa-f]{2})+(?:/(?:[A-Za-z0-9\-._~!$&'()*+,;=:@]|%[0-9A-Fa-f]{2})*)*|)(?:\?(?:[A-Za-z0-9\-._~!$&'()*+,;=:@/?]|%[0-9A-Fa-f]{2})*)?(?:\#(?:[A-Za-z0-9\-._~!$&'()*+,;=:@/?]|%[0-9A-Fa-f]{2})*)?))regex",
-							std::regex_constants::icase | std::regex_constants::nosubs | std::regex_constants::optimize | std::regex_constants::ECMAScript);
+static std::mutex regexCacheMutex;
+static std::unordered_map<std::string, CachedRegex> regexCache;
+static std::list<std::string> regexCacheOrder;
 #pragma clang diagnostic pop
-	return regex;
-}
+static const std::size_t maxRegexCacheSize = 256;
 }
 
 bool isURI(const std::string &string)
 {
-	return std::regex_match(string, detail::uriRegex(), std::regex_constants::match_not_null);
+	return detail::matchesCompletely(string, [](detail::Iterator &it, const detail::Iterator end) { return detail::matchURI(it, end, true); });
 }
-bool isRegex(const std::string &value)
+bool isAbsoluteURI(const std::string &string)
+{
+	return detail::matchesCompletely(string, [](detail::Iterator &it, const detail::Iterator end) { return detail::matchURI(it, end, false); });
+}
+bool isIPv4(const std::string &string)
 {
+	return detail::matchesCompletely(string, &detail::matchIPv4);
+}
+bool isIPv6(const std::string &string)
+{
+	return detail::matchesCompletely(string, &detail::matchIPv6);
+}
+
+std::shared_ptr<const std::regex> compiledRegex(const std::string &pattern)
+{
+	std::lock_guard<std::mutex> lock(detail::regexCacheMutex);
+	auto it = detail::regexCache.find(pattern);
+	if (it != detail::regexCache.end()) {
+		detail::regexCacheOrder.splice(detail::regexCacheOrder.begin(), detail::regexCacheOrder, it->second.order);
+		return it->second.regex;
+	}
+
+	std::shared_ptr<const std::regex> regex;
 	try {
-		std::regex(value, std::regex_constants::ECMAScript);
+		regex = std::make_shared<const std::regex>(pattern, std::regex_constants::ECMAScript);
 	} catch (std::regex_error &) {
+	}
+	if (detail::regexCache.size() >= detail::maxRegexCacheSize) {
+		detail::regexCache.erase(detail::regexCacheOrder.back());
+		detail::regexCacheOrder.pop_back();
+	}
+	detail::regexCacheOrder.push_front(pattern);
+	detail::regexCache.emplace(pattern, detail::CachedRegex{regex, detail::regexCacheOrder.begin()});
+	return regex;
+}
+bool isRegex(const std::string &value)
+{
+	return compiledRegex(value) != nullptr;
+}
+bool matchesRegex(const std::string &pattern, const std::string &value)
+{
+	const std::shared_ptr<const std::regex> regex = compiledRegex(pattern);
+	return regex && std::regex_search(value, *regex);
+}
+
+bool isKnownFormat(const std::string &format)
+{
+	return format == "url" || format == "uri" || format == "uri-reference" || format == "ipv4" || format == "ipv6" || format == "regex";
+}
+bool isFormat(const std::string &format, const std::string &value)
+{
+	if (format == "url" || format == "uri") {
+		return isAbsoluteURI(value);
+	} else if (format == "uri-reference") {
+		return isURI(value);
+	} else if (format == "ipv4") {
+		return isIPv4(value);
+	} else if (format == "ipv6") {
+		return isIPv6(value);
+	} else if (format == "regex") {
+		return isRegex(value);
+	} else {
 		return false;
 	}
-	return true;
 }
 }
 }
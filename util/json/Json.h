@@ -17,12 +17,26 @@
 #pragma once
 
 #include <string>
+#include <memory>
+#include <regex>
 
 namespace Argonauts {
 namespace Util {
 namespace Json {
+// URI-reference (RFC 3986), i.e. either an absolute or a relative URI
 bool isURI(const std::string &string);
+bool isAbsoluteURI(const std::string &string);
+bool isIPv4(const std::string &string);
+bool isIPv6(const std::string &string);
+
+// returns nullptr if the pattern is not a valid ECMAScript regex. compiled patterns are cached
+std::shared_ptr<const std::regex> compiledRegex(const std::string &pattern);
 bool isRegex(const std::string &value);
+bool matchesRegex(const std::string &pattern, const std::string &value);
+
+// formats usable by verification.format and the JSON Schema format keyword
+bool isKnownFormat(const std::string &format);
+bool isFormat(const std::string &format, const std::string &value);
 }
 }
 }
@@ -20,9 +20,12 @@
 #include <cstdio>
 #include <cstdlib>
 #include <istream>
+#include <stdexcept>
 
 #include "util/Util.h"
+#include "util/StringUtil.h"
 #include "util/SaxSink.h"
+#include "util/Instrumentation.h"
 
 namespace Argonauts {
 namespace Util {
@@ -32,9 +35,13 @@ SaxReader::SaxReader(SaxSink *handler)
 {
 }
 
+static inline bool isWhitespace(const char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
 static inline bool isValueEnding(const char c)
 {
-	return c == '}' || c == ']' || c == ',' || std::isspace(c);
+	return c == '}' || c == ']' || c == ',' || isWhitespace(c);
 }
 static inline bool stringContains(const char *str, const std::size_t size, const char c)
 {
@@ -47,7 +54,19 @@ static inline bool stringContains(const char *str, const std::size_t size, const
 }
 static inline bool isEscapeCharacter(const char c)
 {
-	return c == '\\' || c == '/' || c == '"' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't' || c == 'u';
+	return c == '\\' || c == '/' || c == '"' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't';
+}
+static inline int hexDigitValue(const char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	} else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	} else if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	} else {
+		return -1;
+	}
 }
 static inline char escapeForCharacter(const char c)
 {
@@ -64,8 +83,8 @@ static inline char escapeForCharacter(const char c)
 	}
 }
 
-#define SEND_TO_HANDLER0(NAME) if (!m_handler->NAME()) { ASSERT(!m_handler->error().empty()); reportError(m_handler->error()); return; }
-#define SEND_TO_HANDLER1(NAME, ARG) if (!m_handler->NAME(ARG)) { ASSERT(!m_handler->error().empty()); reportError(m_handler->error()); return; }
+#define SEND_TO_HANDLER0(NAME) ARGONAUTS_COUNT(tokens, 1); if (!m_handler->NAME()) { ASSERT(!m_handler->error().empty()); reportError(m_handler->error()); return; }
+#define SEND_TO_HANDLER1(NAME, ARG) ARGONAUTS_COUNT(tokens, 1); if (!m_handler->NAME(ARG)) { ASSERT(!m_handler->error().empty()); reportError(m_handler->error()); return; }
 void SaxReader::addData(const char *data, const std::size_t size)
 {
 	static const char *validNumberCharacters = "0123456789+-eE.";
@@ -74,20 +93,39 @@ void SaxReader::addData(const char *data, const std::size_t size)
 	if (isError()) {
 		return;
 	}
+	ARGONAUTS_COUNT(bytes, size);
 
 	for (std::size_t i = 0; i < size; ++i)
 	{
 		++m_offset;
 		const char next = data[i];
+		if (m_state.empty()) {
+			if (!isWhitespace(next)) {
+				reportError(std::string("Unexpected '") + next + "' after the root entity");
+				return;
+			}
+			continue;
+		}
 		switch (m_state.back()) {
 		case String:
 		case Key:
-			if (!m_utfString.empty()) {
-				m_utfString += next;
-				if (m_utfString.size() == 5) {
-					appendToCurrentValue(std::stoi(m_utfString, 0, 16));
+			if (m_unicodeDigits > 0) {
+				const int digit = hexDigitValue(next);
+				if (digit < 0) {
+					reportError(std::string("Unexpected '") + next + "', expected a hex digit");
+					return;
 				}
+				m_unicodeValue = (m_unicodeValue << 4) | uint32_t(digit);
+				if (--m_unicodeDigits == 0 && !appendUnicodeEscape()) {
+					return;
+				}
+			} else if (m_highSurrogate != 0 && next != (m_isEscaped ? 'u' : '\\')) {
+				reportError("Unpaired surrogate \\u" + String::toHexString(m_highSurrogate).substr(12));
+				return;
 			} else if (!m_isEscaped && ((m_itemStart == 0 && next == ':') || next == m_itemStart)) {
+				if (!checkUtf8()) {
+					return;
+				}
 				if (m_state.back() == String) {
 					SEND_TO_HANDLER1(string, m_currentValue);
 				} else {
@@ -96,18 +134,21 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				resetCurrentValue();
 				m_itemStart = 0;
 				if (m_state.back() == Key) {
+					const SaxSink::Skip skip = m_handler->skipValue();
 					m_state.pop_back();
-					m_state.push_back(WantValue);
+					m_state.push_back(skip == SaxSink::Skip::None ? WantValue : Skip);
+					m_skipKeep = skip == SaxSink::Skip::Keep;
 				} else {
 					m_state.pop_back();
 				}
 			} else if (!m_isEscaped && next == '\\') {
 				m_isEscaped = true;
 			} else if (m_isEscaped) {
-				if (isEscapeCharacter(next)) {
+				if (next == 'u') {
+					m_unicodeDigits = 4;
+					m_unicodeValue = 0;
+				} else if (isEscapeCharacter(next)) {
 					appendToCurrentValue(escapeForCharacter(next));
-				} else if (next == 'u') {
-					m_utfString = "u";
 				} else {
 					appendToCurrentValue(next);
 				}
@@ -116,6 +157,11 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				appendToCurrentValue(next);
 			}
 			break;
+		case Skip:
+			if (!skipValue(data, size, i)) {
+				return;
+			}
+			break;
 		case Special:
 			if (isValueEnding(next)) {
 				if (m_currentValue == "null") {
@@ -130,19 +176,20 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				}
 				resetCurrentValue();
 				m_state.pop_back();
+				// the character ending the value might also end the surrounding array or object
+				reprocess(i);
 			} else {
 				appendToCurrentValue(next);
 			}
 			break;
 		case Number:
 			if (isValueEnding(next)) {
-				if (m_currentValue.find('.') != std::string::npos) {
-					SEND_TO_HANDLER1(doubleNumber, std::stod(m_currentValue));
-				} else {
-					SEND_TO_HANDLER1(integerNumber, std::stoll(m_currentValue));
+				if (!sendNumber()) {
+					return;
 				}
 				resetCurrentValue();
 				m_state.pop_back();
+				reprocess(i);
 			} else if (stringContains(validNumberCharacters, validNumberCharactersSize, next)) {
 				appendToCurrentValue(next);
 			} else {
@@ -164,7 +211,7 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				SEND_TO_HANDLER1(endObject, m_arrayObjectSizeStack.back());
 				m_arrayObjectSizeStack.pop_back();
 				m_state.pop_back();
-			} else if (next == ',' || std::isspace(next)) {
+			} else if (next == ',' || isWhitespace(next)) {
 				// no-op
 			} else {
 				reportError(std::string("Unexpected '") + next + "', expected '\"' or '}'");
@@ -177,7 +224,7 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				m_arrayObjectSizeStack.pop_back();
 				m_state.pop_back();
 				break;
-			} else if (next == ',') {
+			} else if (next == ',' || isWhitespace(next)) {
 				break;
 			}
 			m_arrayObjectSizeStack.back() += 1;
@@ -196,6 +243,7 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				}
 				m_state.push_back(Object);
 				m_arrayObjectSizeStack.push_back(0);
+				ARGONAUTS_DEPTH(m_arrayObjectSizeStack.size());
 				break;
 			case '[':
 				SEND_TO_HANDLER0(startArray);
@@ -204,11 +252,13 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				}
 				m_state.push_back(Array);
 				m_arrayObjectSizeStack.push_back(0);
+				ARGONAUTS_DEPTH(m_arrayObjectSizeStack.size());
 				break;
 			case '"':
 			case '\'':
-				if (m_state.size() == 1) {
+				if (m_state.size() == 1 && m_state.back() == WantValue) {
 					reportError("String cannot be root entity");
+					return;
 				}
 				if (m_state.back() != Array) {
 					m_state.pop_back();
@@ -218,6 +268,7 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				break;
 			case '-':
 			case '+':
+			case '0':
 			case '1':
 			case '2':
 			case '3':
@@ -227,8 +278,9 @@ void SaxReader::addData(const char *data, const std::size_t size)
 			case '7':
 			case '8':
 			case '9':
-				if (m_state.size() == 1) {
+				if (m_state.size() == 1 && m_state.back() == WantValue) {
 					reportError("Number cannot be root entity");
+					return;
 				}
 				if (m_state.back() != Array) {
 					m_state.pop_back();
@@ -239,8 +291,9 @@ void SaxReader::addData(const char *data, const std::size_t size)
 			case 'n':
 			case 't':
 			case 'f':
-				if (m_state.size() == 1) {
+				if (m_state.size() == 1 && m_state.back() == WantValue) {
 					reportError("Keyword cannot be root entity");
+					return;
 				}
 				if (m_state.back() != Array) {
 					m_state.pop_back();
@@ -249,6 +302,7 @@ void SaxReader::addData(const char *data, const std::size_t size)
 				appendToCurrentValue(next);
 				break;
 			case '\n':
+			case '\r':
 			case '\t':
 			case ' ':
 				// no-op
@@ -263,6 +317,154 @@ void SaxReader::addData(const char *data, const std::size_t size)
 		}
 	}
 }
+// Passes over the value of a key without sending any events for it, starting at data[i] and leaving i at the last
+// character consumed. Only brackets and quotes are looked at, so the skipped value is not validated any further
+bool SaxReader::skipValue(const char *data, const std::size_t size, std::size_t &i)
+{
+	std::size_t pos = i;
+	std::size_t rawStart = i;
+	bool done = false;
+	while (pos < size && !done) {
+		const char next = data[pos];
+		if (!m_skipStarted) {
+			if (isWhitespace(next) || next == ':') {
+				rawStart = ++pos;
+				continue;
+			}
+			m_skipStarted = true;
+			if (next == '{' || next == '[') {
+				m_skipDepth = 1;
+			} else if (next == '"' || next == '\'') {
+				m_itemStart = next;
+			} else if (next == '}' || next == ']' || next == ',') {
+				reportError(std::string("Unexpected '") + next + "', expected VALUE");
+				return false;
+			} else {
+				m_skipScalar = true;
+			}
+			++pos;
+		} else if (m_isEscaped) {
+			m_isEscaped = false;
+			++pos;
+		} else if (m_itemStart != 0) {
+			// within a string only the closing quote matters, memchr is about as fast as it gets for finding it
+			const char *quote = static_cast<const char *>(std::memchr(data + pos, m_itemStart, size - pos));
+			const std::size_t end = quote ? std::size_t(quote - data) : size;
+			std::size_t backslashes = 0;
+			while (end - backslashes > pos && data[end - backslashes - 1] == '\\') {
+				++backslashes;
+			}
+			if (!quote) {
+				m_isEscaped = backslashes % 2 == 1;
+				pos = size;
+			} else {
+				pos = end + 1;
+				if (backslashes % 2 == 0) {
+					m_itemStart = 0;
+					done = m_skipDepth == 0;
+				}
+			}
+		} else if (m_skipScalar) {
+			// the character ending a number or keyword belongs to whatever comes after it
+			done = isValueEnding(next);
+			pos += done ? 0 : 1;
+		} else {
+			switch (next) {
+			case '"':
+			case '\'':
+				m_itemStart = next;
+				break;
+			case '{':
+			case '[':
+				++m_skipDepth;
+				break;
+			case '}':
+			case ']':
+				done = --m_skipDepth == 0;
+				break;
+			default:
+				break;
+			}
+			++pos;
+		}
+	}
+
+	if (m_skipKeep) {
+		m_currentValue.append(data + rawStart, pos - rawStart);
+	}
+	ARGONAUTS_COUNT(skippedBytes, pos - i);
+	// the main loop has already counted data[i]
+	m_offset += int(pos - i) - 1;
+	i = pos - 1;
+	if (!done) {
+		return true;
+	}
+
+	m_state.pop_back();
+	m_skipStarted = m_skipScalar = false;
+	m_skipDepth = 0;
+	ARGONAUTS_COUNT(tokens, 1);
+	const bool result = m_handler->skipped(m_currentValue);
+	resetCurrentValue();
+	if (!result) {
+		ASSERT(!m_handler->error().empty());
+		reportError(m_handler->error());
+	}
+	return result;
+}
+bool SaxReader::sendNumber()
+{
+	// std::sto* accept prefixes of invalid numbers and throw on overflow, both are errors here
+	const bool isDouble = m_currentValue.find_first_of(".eE") != std::string::npos;
+	double doubleValue = 0;
+	long long integerValue = 0;
+	std::size_t processed = 0;
+	try {
+		if (isDouble) {
+			doubleValue = std::stod(m_currentValue, &processed);
+		} else {
+			integerValue = std::stoll(m_currentValue, &processed);
+		}
+	} catch (std::exception &) {
+		processed = 0;
+	}
+	if (processed != m_currentValue.size()) {
+		reportError("Invalid number '" + m_currentValue + "'");
+		return false;
+	}
+
+	ARGONAUTS_COUNT(tokens, 1);
+	const bool result = isDouble ? m_handler->doubleNumber(doubleValue) : m_handler->integerNumber(integerValue);
+	if (!result) {
+		ASSERT(!m_handler->error().empty());
+		reportError(m_handler->error());
+	}
+	return result;
+}
+bool SaxReader::appendUnicodeEscape()
+{
+	const uint32_t unit = m_unicodeValue;
+	if (unit >= 0xd800 && unit <= 0xdbff && m_highSurrogate == 0) {
+		m_highSurrogate = unit;
+	} else if (unit >= 0xdc00 && unit <= 0xdfff && m_highSurrogate != 0) {
+		String::appendUtf8(m_currentValue, 0x10000 + ((m_highSurrogate - 0xd800) << 10) + (unit - 0xdc00));
+		m_highSurrogate = 0;
+	} else if ((unit >= 0xd800 && unit <= 0xdfff) || m_highSurrogate != 0) {
+		reportError("Unpaired surrogate \\u" + String::toHexString(m_highSurrogate != 0 ? m_highSurrogate : unit).substr(12));
+		return false;
+	} else {
+		String::appendUtf8(m_currentValue, unit);
+	}
+	return true;
+}
+bool SaxReader::checkUtf8()
+{
+	if (m_validateUtf8 && !String::isValidUtf8(m_currentValue)) {
+		reportError(std::string(m_state.back() == Key ? "Key" : "String") + " is not valid UTF-8");
+		return false;
+	}
+	return true;
+}
 void SaxReader::addData(const std::string &str)
 {
 	return addData(str.c_str(), str.size());
@@ -289,6 +491,7 @@ void SaxReader::end()
 				break;
 			case String:
 			case Key:
+			case Skip:
 			case Number:
 			case Special:
 			case WantValue:
@@ -299,6 +502,9 @@ void SaxReader::end()
 		case Key:
 			reportError("Unexpected EOF, expected ':'");
 			break;
+		case Skip:
+			reportError("Unexpected EOF in a skipped value");
+			break;
 		case Object:
 			reportError("Unexpected EOF, expected '}' or ','");
 			break;
@@ -321,6 +527,77 @@ void SaxReader::reportError(const std::string &error)
 {
 	m_error = error;
 }
+
+namespace {
+// the reader only accepts objects and arrays as the root, so values are read wrapped into an array, which this drops
+class UnwrappingSaxSink : public SaxSink
+{
+	SaxSink *m_sink;
+	int m_depth = 0;
+
+public:
+	explicit UnwrappingSaxSink(SaxSink *sink) : m_sink(sink) {}
+
+	std::size_t values = 0;
+
+	bool null() override { return value() && forward(!m_sink || m_sink->null()); }
+	bool boolean(const bool val) override { return value() && forward(!m_sink || m_sink->boolean(val)); }
+	bool integerNumber(const int64_t val) override { return value() && forward(!m_sink || m_sink->integerNumber(val)); }
+	bool doubleNumber(const double val) override { return value() && forward(!m_sink || m_sink->doubleNumber(val)); }
+	bool string(const std::string &str) override { return value() && forward(!m_sink || m_sink->string(str)); }
+	bool startObject() override
+	{
+		const bool result = value();
+		++m_depth;
+		return result && forward(!m_sink || m_sink->startObject());
+	}
+	bool key(const std::string &str) override { return forward(!m_sink || m_sink->key(str)); }
+	bool endObject(const std::size_t size) override
+	{
+		--m_depth;
+		return forward(!m_sink || m_sink->endObject(size));
+	}
+	bool startArray() override
+	{
+		if (m_depth == 0) {
+			++m_depth;
+			return true;
+		}
+		const bool result = value();
+		++m_depth;
+		return result && forward(!m_sink || m_sink->startArray());
+	}
+	bool endArray(const std::size_t size) override
+	{
+		--m_depth;
+		return m_depth == 0 || forward(!m_sink || m_sink->endArray(size));
+	}
+
+private:
+	bool value()
+	{
+		if (m_depth == 1) {
+			++values;
+		}
+		return values <= 1 || reportError("Expected a single value");
+	}
+	bool forward(const bool result)
+	{
+		return result || reportError(m_sink->error().empty() ? std::string("Rejected by the sink") : m_sink->error());
+	}
+};
+}
+
+bool readValue(const std::string &text, SaxSink *sink)
+{
+	UnwrappingSaxSink unwrapping(sink);
+	SaxReader reader(&unwrapping);
+	reader.addData("[", 1);
+	reader.addData(text);
+	reader.addData("]", 1);
+	reader.end();
+	return !reader.isError() && unwrapping.values == 1;
+}
 }
 
 }
@@ -333,12 +610,12 @@ std::istream &operator>>(std::istream &stream, Argonauts::Util::SaxSink *handler
 
 	Argonauts::Util::Json::SaxReader reader(handler);
 
-	while (!stream.good() && !reader.isError()) {
-		const auto size = stream.readsome(buffer, chunkSize);
-		if (size == -1) {
+	while (stream.good() && !reader.isError()) {
+		stream.read(buffer, chunkSize);
+		if (stream.bad()) {
 			throw Argonauts::Util::Error("Unable to read from input stream", std::size_t(reader.errorOffset()));
 		}
-		reader.addData(buffer, std::size_t(size));
+		reader.addData(buffer, std::size_t(stream.gcount()));
 	}
 
 	reader.end();
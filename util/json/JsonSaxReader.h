@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,10 @@ public:
 	void addData(const std::string &str);
 	void end();
 
+	/// Strings and keys are checked to be valid UTF-8 by default, since that is all SaxSinks should have to deal with.
+	/// Turn it off for input that is known to be valid, or if other encodings should be passed through unchanged
+	void setValidateUtf8(const bool validate) { m_validateUtf8 = validate; }
+
 	const std::string &errorMessage() const { return m_error; }
 	int errorOffset() const { return m_offset; }
 	Error error(const std::string &data = "", const std::string &filename = "<unknown>") const { return Error(m_error, std::size_t(m_offset), Error::Source(data, filename)); }
@@ -54,6 +59,7 @@ private: // internal state
 		Array,
 		Object,
 		Key,
+		Skip, ///< the value of a key the handler asked to skip
 
 		WantValue,
 		Invalid
@@ -66,10 +72,7 @@ private: // internal state
 		if (m_state.size() < 2) {
 			return Invalid;
 		} else {
-			auto it = m_state.begin();
-			--it;
-			--it;
-			return *it;
+			return *(m_state.end() - 2);
 		}
 	}
 
@@ -86,10 +89,33 @@ private: // internal state
 	}
 
 	std::string m_currentValue; // the data of the current string/number/special/key
-	std::string m_utfString;
+	int m_unicodeDigits = 0; // hex digits still missing from the current \u escape
+	uint32_t m_unicodeValue = 0;
+	uint32_t m_highSurrogate = 0; // first half of a surrogate pair, waiting for the second one
+	bool m_validateUtf8 = true;
+
+	int m_skipDepth = 0; // open arrays and objects in the value being skipped
+	bool m_skipStarted = false; // false while still looking for the start of the value
+	bool m_skipScalar = false;
+	bool m_skipKeep = false; // collect the raw text of the value in m_currentValue
+
+	// makes the main loop look at the character at i again, used once a value that has no end marker is complete
+	inline void reprocess(std::size_t &i)
+	{
+		--i;
+		--m_offset;
+	}
+	bool skipValue(const char *data, const std::size_t size, std::size_t &i);
+	bool sendNumber();
+	bool appendUnicodeEscape();
+	bool checkUtf8();
 
 	void reportError(const std::string &error);
 };
+
+/// Sends the events of exactly one JSON value to sink, which can be nullptr to only check the value. Unlike SaxReader
+/// this also accepts scalars. Returns false if text is not a single valid value, or if the sink failed
+bool readValue(const std::string &text, SaxSink *sink);
 }
 }
 }
@@ -16,65 +16,106 @@
 
 #include "JsonSaxWriter.h"
 
-#include "StringUtil.h"
-
-static inline std::string replaceEscaped(const std::string &in)
-{
-	using Argonauts::Util::String::replaceAll;
-	std::string out = in;
-	out = replaceAll(out, "\\", "\\\\");
-	out = replaceAll(out, "/", "\\/");
-	out = replaceAll(out, "\"", "\\\"");
-	out = replaceAll(out, "\b", "\\b");
-	out = replaceAll(out, "\f", "\\f");
-	out = replaceAll(out, "\n", "\\n");
-	out = replaceAll(out, "\r", "\\r");
-	out = replaceAll(out, "\t", "\\t");
-	return out;
-}
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 namespace Argonauts {
 namespace Util {
 namespace Json {
+// writes the escaped string in runs between characters that need escaping, without building a copy of it first
+static bool writeEscaped(OutputStream *stream, const std::string &in)
+{
+	std::size_t runStart = 0;
+	for (std::size_t i = 0; i < in.size(); ++i) {
+		const char *replacement;
+		std::size_t replacementSize = 2;
+		char controlEscape[7];
+		switch (in[i]) {
+		case '\\': replacement = "\\\\"; break;
+		case '/': replacement = "\\/"; break;
+		case '"': replacement = "\\\""; break;
+		case '\b': replacement = "\\b"; break;
+		case '\f': replacement = "\\f"; break;
+		case '\n': replacement = "\\n"; break;
+		case '\r': replacement = "\\r"; break;
+		case '\t': replacement = "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(in[i]) >= 0x20) {
+				continue;
+			}
+			// other control characters may not appear unescaped
+			std::snprintf(controlEscape, sizeof(controlEscape), "\\u%04x", unsigned(in[i]));
+			replacement = controlEscape;
+			replacementSize = 6;
+		}
+		if ((i > runStart && !stream->write(in.data() + runStart, i - runStart)) || !stream->write(replacement, replacementSize)) {
+			return false;
+		}
+		runStart = i + 1;
+	}
+	return runStart == in.size() || stream->write(in.data() + runStart, in.size() - runStart);
+}
+
 SaxWriter::SaxWriter(OutputStream *stream, const unsigned char intendention)
-	: m_stream(stream), m_intendention(intendention) {}
+	: m_stream(stream), m_intendention(intendention)
+{
+	// enough for most documents, so that writing does not need to allocate
+	m_containerStack.reserve(16);
+	m_haveHadValueStack.reserve(16);
+}
 
 bool SaxWriter::null()
 {
-	return m_stream->write(delimiter() + "null");
+	return writeDelimiter() && m_stream->write("null", 4);
 }
 bool SaxWriter::boolean(const bool val)
 {
-	return m_stream->write(delimiter() + (val ? "true" : "false"));
+	return writeDelimiter() && (val ? m_stream->write("true", 4) : m_stream->write("false", 5));
 }
 bool SaxWriter::integerNumber(const int64_t val)
 {
-	return m_stream->write(delimiter() + std::to_string(val));
+	char buffer[24];
+	const int size = std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(val));
+	return writeDelimiter() && m_stream->write(buffer, std::size_t(size));
 }
 bool SaxWriter::doubleNumber(const double val)
 {
-	std::string value = std::to_string(val);
-	std::size_t pos;
-	// remove trailing zeros
-	while ((pos = value.rfind('0')) == (value.size() - 1)) {
-		value = value.substr(0, value.size() - 1);
+	if (!std::isfinite(val)) {
+		return writeDelimiter() && m_stream->write("null", 4);
+	}
+	// shortest representation that reads back as the same value
+	char buffer[32];
+	int size = 0;
+	for (int precision = 15; precision <= 17; ++precision) {
+		size = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, val);
+		if (std::strtod(buffer, nullptr) == val) {
+			break;
+		}
 	}
-	return m_stream->write(delimiter() + value);
+	// keep it a double when reading it back
+	if (std::strpbrk(buffer, ".e") == nullptr) {
+		buffer[size++] = '.';
+		buffer[size++] = '0';
+	}
+	return writeDelimiter() && m_stream->write(buffer, std::size_t(size));
 }
 bool SaxWriter::string(const std::string &val)
 {
-	return m_stream->write(delimiter() + '"' + replaceEscaped(val) + '"');
+	return writeDelimiter() && m_stream->write('"') && writeEscaped(m_stream, val) && m_stream->write('"');
 }
 bool SaxWriter::startObject()
 {
-	const bool res = m_stream->write(delimiter() + '{');
+	const bool res = writeDelimiter() && m_stream->write('{');
 	m_containerStack.push_back(Object);
 	m_haveHadValueStack.push_back(false);
 	return res;
 }
 bool SaxWriter::key(const std::string &val)
 {
-	return m_stream->write(delimiter(true) + '"' + replaceEscaped(val) + "\":" + (m_intendention == 0 ? "" : " "));
+	return writeDelimiter(true) && m_stream->write('"') && writeEscaped(m_stream, val)
+			&& (m_intendention == 0 ? m_stream->write("\":", 2) : m_stream->write("\": ", 3));
 }
 bool SaxWriter::endObject(const std::size_t)
 {
@@ -84,7 +125,7 @@ bool SaxWriter::endObject(const std::size_t)
 }
 bool SaxWriter::startArray()
 {
-	const bool res = m_stream->write(delimiter() + '[');
+	const bool res = writeDelimiter() && m_stream->write('[');
 	m_containerStack.push_back(Array);
 	m_haveHadValueStack.push_back(false);
 	return res;
@@ -95,28 +136,33 @@ bool SaxWriter::endArray(const std::size_t)
 	m_containerStack.pop_back();
 	return m_stream->write(']');
 }
+bool SaxWriter::rawValue(const std::string &json)
+{
+	// written as it is, so that for example numbers keep their formatting
+	return writeDelimiter() && m_stream->write(json.data(), json.size());
+}
 
-std::string SaxWriter::delimiter(const bool isKey)
+bool SaxWriter::writeDelimiter(const bool isKey)
 {
 	if (m_haveHadValueStack.empty())
 	{
-		return std::string();
+		return true;
 	}
 
 	if (isKey && m_containerStack.back() == Object && m_haveHadValueStack.back())
 	{
 		// object, key and have had a previous value
-		return ",";
+		return m_stream->write(',');
 	}
 	else if (!isKey && m_containerStack.back() == Array && m_haveHadValueStack.back())
 	{
 		// array and have had a previous value
-		return ",";
+		return m_stream->write(',');
 	}
 	else
 	{
 		m_haveHadValueStack.back() = true;
-		return std::string();
+		return true;
 	}
 }
 }
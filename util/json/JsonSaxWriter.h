@@ -17,34 +17,17 @@
 #pragma once
 
 #include "util/SaxSink.h"
+#include "util/OutputStream.h"
 
 namespace Argonauts {
 namespace Util {
-class OutputStream
-{
-public:
-	virtual ~OutputStream() {}
-	virtual bool write(const std::string &string) = 0;
-	virtual bool write(const char c) { return write(std::string({c})); }
-};
-class StringOutputStream : public OutputStream
-{
-	std::string *m_str;
-	const bool m_owned;
-public:
-	explicit StringOutputStream(std::string *string = nullptr)
-		: m_str(string ? string : new std::string()), m_owned(!string) {}
-	~StringOutputStream()
-	{
-		if (m_owned) {
-			delete m_str;
-		}
-	}
-	inline bool write(const std::string &string) override { *m_str += string; return true; }
-	const std::string result() const { return *m_str; }
-};
-
 namespace Json {
+/* Writes the events it receives as JSON text.
+ *
+ * Doubles are written with the fewest digits (15 to 17) that read back as the same value, and always with a '.' or an
+ * exponent so that they are read back as doubles, 2.0 is written as "2.0". JSON has no representation for NaN and
+ * infinities, they are written as null. In strings, control characters without a short escape are written as \u00XX.
+ */
 class SaxWriter : public SaxSink
 {
 	enum ContainerType { Object, Array };
@@ -67,9 +50,10 @@ private:
 	bool endObject(const std::size_t) override;
 	bool startArray() override;
 	bool endArray(const std::size_t) override;
+	bool rawValue(const std::string &json) override;
 
 private:
-	std::string delimiter(const bool isKey = false);
+	bool writeDelimiter(const bool isKey = false);
 };
 }
 }
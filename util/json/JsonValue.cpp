@@ -207,6 +207,40 @@ SaxSink *Value::parserSink(Value *value)
 	return new ParserHandler(value);
 }
 
+bool Value::serialize(SaxSink *sink) const
+{
+	switch (m_type) {
+	case Type::Null: return sink->null();
+	case Type::Boolean: return sink->boolean(m_boolean);
+	case Type::Integer: return sink->integerNumber(m_integer);
+	case Type::Number: return sink->doubleNumber(m_double);
+	case Type::String: return sink->string(m_string);
+	case Type::Array:
+		if (!sink->startArray()) {
+			return false;
+		}
+		for (const Value &value : m_array) {
+			if (!value.serialize(sink)) {
+				return false;
+			}
+		}
+		return sink->endArray(m_array.size());
+	case Type::Object:
+		if (!sink->startObject()) {
+			return false;
+		}
+		for (const auto &pair : m_object) {
+			if (!sink->key(pair.first) || !pair.second.serialize(sink)) {
+				return false;
+			}
+		}
+		return sink->endObject(m_object.size());
+	case Type::Invalid:
+		break;
+	}
+	return false;
+}
+
 static bool fuzzyCompare(const double a, const double b)
 {
 	return std::abs(a - b) * 1000000000000. <= std::min(std::abs(a), std::abs(b));
@@ -46,10 +46,10 @@ enum class Type
 class Value
 {
 	// TODO: make these use the same memory
-	NullT m_null;
-	BooleanT m_boolean;
-	IntegerT m_integer;
-	DoubleT m_double;
+	NullT m_null = nullptr;
+	BooleanT m_boolean = false;
+	IntegerT m_integer = 0;
+	DoubleT m_double = 0;
 	StringT m_string;
 	ArrayContainerT<Value> m_array;
 	ObjectContainerT<Value> m_object;
@@ -113,6 +113,8 @@ public:
 	const Value &operator[](const std::size_t index) const { return toArray()[index]; }
 
 	static SaxSink *parserSink(Value *value);
+	/// Emits this value to the sink, objects with their keys in sorted order. Stops at the first error of the sink
+	bool serialize(SaxSink *sink) const;
 
 	bool operator==(const Value &other) const;
 	bool operator!=(const Value &other) const;